@@ -0,0 +1,1409 @@
+/************************************************************************************
+
+Filename    :   Headless_OculusRoomTiny.cpp
+Content     :   Windowless driver for the OculusRoomTiny sensor and camera pipeline
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "OculusRoomTiny_Pipeline.h"
+#include "ThreeSpace_Recording.h"
+#include "ThreeSpace_Serial.h"
+#include "ThreeSpace_Simulator.h"
+#include "Util_EulerKernel.h"
+#include "Util_FrameTiming.h"
+#include "Util_TaskGraph.h"
+#include "Util_Trace.h"
+#include "Util_AsyncLog.h"
+#include "RenderTiny_Soft_Device.h"
+#include "RenderTiny_SceneBVH.h"
+#include "RenderTiny_RenderQueue.h"
+#include "RenderTiny_StaticBatch.h"
+#include "RenderTiny_SceneFile.h"
+#include "Util/Util_Render_Stereo.h"
+#include "../../LibOVR/Src/Kernel/OVR_Alg.h"
+#include "../../LibOVR/Src/Kernel/OVR_System.h"
+#include "../../LibOVR/Src/Kernel/OVR_Timer.h"
+#include "../../LibOVR/Src/Kernel/OVR_Log.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+using namespace OVR::RenderTiny;
+
+//-------------------------------------------------------------------------------------
+// ***** Headless Description
+
+// Runs OnIdle's non-rendering work (ThreeSpace sampling and prediction, movement,
+// head model and View) frame by frame with scripted input and no window or GPU,
+// so the hot path can be profiled and fuzzed on Linux. With -soft-render it renders
+// too, on the CPU through RenderTiny::Soft, with the app's stereo and distortion.
+//
+// The following command line arguments work:
+//
+//  -tss-replay <file> - Feed a ThreeSpace recording through the reader thread.
+//  -replay-fast       - Replay as fast as possible instead of in real time.
+//  -tss-predict <ms>  - ThreeSpace prediction interval; 0 disables prediction.
+//  -view-euler        - Use the Euler sensor -> View path.
+//  -sim-thread        - Run RoomSimulation on its own thread in real time, as the
+//                       app does, instead of stepping it to each frame's scripted
+//                       time; movement is then no longer reproducible.
+//  -input-record <file> - Write every input event the simulation applies to a journal.
+//  -input-replay <file> - Apply a journal's events instead of the scripted input;
+//                       with the same arguments, the run ends on the same View.
+//  -soft-render       - Render each frame, both eyes with distortion, with the
+//                       software RenderDevice; reports submission and raster cost.
+//  -render-size <w>x<h> - Soft render resolution (default 1280x800).
+//  -render-dump <file> - Write the last rendered frame as a binary PPM.
+//  -stereo-single-pass - Soft render both eyes in one scene pass instead of one
+//                       pass per eye.
+//  -distortion-mesh <n> - Soft render distortion with an n x n cell mesh per eye
+//                       instead of warping every pixel.
+//  -no-cull          - Soft render every model instead of culling the scene to
+//                       both eyes' frustum first.
+//  -no-sort          - Soft render models in scene order instead of sorting them
+//                       by shader, fill, mesh and depth (which also instances).
+//  -no-instance      - Soft render models with identical geometry one draw each
+//                       instead of one instanced draw per run.
+//  -tables <n>        - Tables in the soft render room, each its own Model
+//                       (default 24).
+//  -static-batch <n>  - Merge the soft render room into batches of at most n
+//                       vertices per fill at startup; 0 for the largest (65536).
+//  -scene <file>      - Soft render a scene file instead of building the room in
+//                       code; reports how long loading it took.
+//  -scene-export <file> - Write the room built in code, with -tables, to a scene
+//                       file.
+//  -bench-static      - Render the room turning in place per model and merged into
+//                       static batches of several sizes; reports scene build cost,
+//                       draws and submission time per frame.
+//  -bench-distortion  - Build distortion meshes for the render size and report their
+//                       cost and error against the per-pixel warp.
+//  -frames <n>        - Number of frames to run (default 1000).
+//  -fps <n>           - Pace frames at n Hz; 0 runs unpaced (default).
+//  -fuzz <seed>       - Feed random and degenerate samples synchronously instead of
+//                       a replay; fails if View ever stops being finite.
+//  -bench-euler       - Time QuatToEulerBatch over the replay on every kernel path.
+//  -bench-fusion      - Run HeadFusion over the replay against a simulated drifting
+//                       Rift; reports accuracy and cost per update.
+//  -check-recording <file> - Append three sessions (one after a simulated reboot)
+//                       to a new recording at file, replay it and check they play
+//                       back as one gapless timeline; exits 1 if not.
+//  -trace <file>      - Write a Chrome JSON trace of every frame.
+//  -tss-serial <dev>  - Stream from a sensor on a serial port; repeat for more
+//                       sensors, the first one is the head.
+//  -tss-cache <file>  - Serial sensor configuration cache; sensors whose cached
+//                       settings still hold are verified instead of reconfigured.
+//  -tss-sim <hz>      - Stream from a ThreeSpaceSimulator at hz (100-1000) over a pty
+//                       and report ingest latency and packet loss.
+//  -sim-sensors <n>   - Number of simulated sensors, each on its own pty (1-8).
+//  -sim-jitter <mks>  - Simulator send time jitter, +/- microseconds.
+//  -sim-dropout <p>   - Probability that a simulated packet starts a dropout.
+//  -sim-dropout-length <n> - Packets lost per dropout (default 1).
+
+
+//-------------------------------------------------------------------------------------
+// ***** Scripted input
+
+// Deterministic input, so runs are comparable: walk forward, strafe while turning
+// with the gamepad, then back up, repeating every 4 seconds of frame time. Input
+// goes in as the key and gamepad events a user would cause, at each phase change.
+static void scriptInput(RoomSimulation* simulation, unsigned frame, float dt, UInt64 ticks)
+{
+    unsigned phase = unsigned(fmodf(frame * dt, 4.0f));
+    unsigned last  = frame ? unsigned(fmodf((frame - 1) * dt, 4.0f)) : 4;
+    if (phase == last)
+        return;
+
+    // Gamepad stick positions that give GamepadRotate.x of 0.5 and a GamepadMove
+    // of (0.3, 0, -0.3).
+    const float rotateX = 0.25f;
+    const float moveXY  = sqrtf(0.3f);
+
+    switch(last)
+    {
+    case 0: simulation->PushEvent(RoomInputEvent::Key(ticks, 'W', false)); break;
+    case 1: simulation->PushEvent(RoomInputEvent::Key(ticks, 'A', false));
+            simulation->PushEvent(RoomInputEvent::Gamepad(ticks, 0, 0, 0, 0)); break;
+    case 2: simulation->PushEvent(RoomInputEvent::Key(ticks, 'S', false));
+            simulation->PushEvent(RoomInputEvent::Key(ticks, RoomKey_Shift, false)); break;
+    case 3: simulation->PushEvent(RoomInputEvent::Gamepad(ticks, 0, 0, 0, 0)); break;
+    }
+
+    switch(phase)
+    {
+    case 0: simulation->PushEvent(RoomInputEvent::Key(ticks, 'W', true)); break;
+    case 1: simulation->PushEvent(RoomInputEvent::Key(ticks, 'A', true));
+            simulation->PushEvent(RoomInputEvent::Gamepad(ticks, 0, 0, rotateX, 0)); break;
+    case 2: simulation->PushEvent(RoomInputEvent::Key(ticks, 'S', true));
+            simulation->PushEvent(RoomInputEvent::Key(ticks, RoomKey_Shift, true)); break;
+    case 3: simulation->PushEvent(RoomInputEvent::Gamepad(ticks, moveXY, moveXY, 0, 0)); break;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** Fuzz samples
+
+// xorshift32; fixed by seed so failures can be reproduced.
+class FuzzRandom
+{
+public:
+    FuzzRandom(UInt32 seed) : State(seed ? seed : 0x9E3779B9) { }
+
+    UInt32  Next()
+    {
+        State ^= State << 13;
+        State ^= State >> 17;
+        State ^= State << 5;
+        return State;
+    }
+    float   Uniform(float lo, float hi) { return lo + (hi - lo) * ((Next() >> 8) * (1.0f / 16777216.0f)); }
+
+private:
+    UInt32  State;
+};
+
+// Produces the orientations and timestamps that are hard on the pipeline:
+// gimbal-lock poles, both quaternion signs, slightly denormalized quaternions,
+// repeated and wrapping sensor timestamps, and large gaps.
+static void makeFuzzSample(FuzzRandom& rnd, UInt32* sensorTime,
+                           ThreeSpaceSample* sample, UInt64 hostTicks)
+{
+    float* q = sample->Packet.quat;
+
+    switch (rnd.Next() % 4)
+    {
+    case 0: // Exactly at or next to a pole, where 2(wy - xz) = +/-1.
+        {
+            float s = (rnd.Next() & 1) ? 0.70710678f : -0.70710678f;
+            float e = (rnd.Next() & 1) ? 0.0f : rnd.Uniform(-1e-4f, 1e-4f);
+            q[0] = 0.0f; q[1] = s + e; q[2] = 0.0f; q[3] = 0.70710678f;
+        }
+        break;
+    case 1: // Identity, either sign.
+        q[0] = q[1] = q[2] = 0.0f;
+        q[3] = (rnd.Next() & 1) ? 1.0f : -1.0f;
+        break;
+    default: // Random axis, renormalized with a small scale error.
+        {
+            float len = 0.0f;
+            for (int i = 0; i < 4; i++)
+            {
+                q[i] = rnd.Uniform(-1.0f, 1.0f);
+                len += q[i] * q[i];
+            }
+            float scale = rnd.Uniform(0.999f, 1.001f) / sqrtf(len > 1e-6f ? len : 1.0f);
+            for (int i = 0; i < 4; i++)
+                q[i] *= scale;
+        }
+        break;
+    }
+
+    // Mostly 1-10ms apart; sometimes repeated, sometimes a long stall, and
+    // the caller starts sensorTime close enough to 2^32 to wrap.
+    UInt32 r = rnd.Next() % 16;
+    if (r == 1)
+        *sensorTime += 500000;
+    else if (r != 0)
+        *sensorTime += 1000 + rnd.Next() % 9000;
+
+    sample->SensorTimestamp = *sensorTime;
+    sample->HostTicks       = hostTicks;
+}
+
+static bool isFinite(const Matrix4f& m)
+{
+    for (int i = 0; i < 4; i++)
+        for (int j = 0; j < 4; j++)
+            if (!(fabsf(m.M[i][j]) <= 1e30f))
+                return false;
+    return true;
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** Ingest latency probe
+
+// Passes samples through from a serial source, recording how long each took from
+// the sensor timestamping it to the reader having it. Only meaningful when the
+// sensor clock is Timer::GetTicks(), as with ThreeSpaceSimulator.
+class IngestProbeSource : public ThreeSpaceSource
+{
+public:
+    IngestProbeSource(ThreeSpaceSource* source) : Received(0), pSource(source) { }
+
+    virtual ReadResult ReadSample(ThreeSpaceSample* sample, unsigned timeoutMs)
+    {
+        ReadResult result = pSource->ReadSample(sample, timeoutMs);
+        if (result == Read_Sample)
+        {
+            Latency.Record(UInt32(sample->HostTicks) - sample->SensorTimestamp);
+            Received++;
+        }
+        return result;
+    }
+
+    // Reader thread only, until the reader has stopped.
+    LatencyHistogram        Latency;
+    UInt32                  Received;
+
+private:
+    Ptr<ThreeSpaceSource>   pSource;
+};
+
+
+// Opens one serial source as a startup task, so every port's configuration round
+// trips run at once instead of one port after another.
+struct SerialOpenTask
+{
+    const char*                 Path;
+    ThreeSpaceDeviceCache*      pCache;
+    Ptr<ThreeSpaceSerialSource> Source;
+
+    static bool Run(void* task)
+    {
+        SerialOpenTask* self = (SerialOpenTask*)task;
+        self->Source = *new ThreeSpaceSerialSource;
+        self->Source->SetDeviceCache(self->pCache);
+        if (self->Source->Open(self->Path))
+            return true;
+        fprintf(stderr, "Can't start ThreeSpace streaming on %s\n", self->Path);
+        return false;
+    }
+};
+
+
+static void stopSimulators(Ptr<ThreeSpaceSimulator>* simulators, unsigned count)
+{
+    for (unsigned i = 0; i < count; i++)
+        if (simulators[i])
+            simulators[i]->Stop();
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** Soft rendering
+
+// Stand-in for PopulateRoomScene, whose OculusRoomModel.cpp is tied to the Win32
+// app: a walled room around the starting position with a checkered floor, ceiling
+// fixtures and rows of tables, each table its own Model as the sample's furniture
+// is, lit by ceiling lights.
+enum { CheckerSize = 64, CheckerSquare = 8 };
+
+static void makeCheckerPixels(Color a, Color b, Color* pixels)
+{
+    for (int y = 0; y < CheckerSize; y++)
+        for (int x = 0; x < CheckerSize; x++)
+            pixels[y * CheckerSize + x] = (((x / CheckerSquare) ^ (y / CheckerSquare)) & 1) ? a : b;
+}
+
+// Lit, and textured with CheckerSize square 'pixels' if there are any. What the
+// fill is made of is also registered with 'exporter', if there is one.
+static Fill* makeLitFill(RenderDevice* render, const Color* pixels, SceneFileWriter* exporter)
+{
+    const int      format   = Texture_RGBA | Texture_GenMipmaps;
+    const int      fragment = pixels ? FShader_LitTexture : FShader_LitGouraud;
+    Ptr<ShaderSet> shaders  = *render->CreateShaderSet();
+    Ptr<Shader>    vs       = *render->LoadBuiltinShader(Shader_Vertex, VShader_MVP);
+    Ptr<Shader>    ps       = *render->LoadBuiltinShader(Shader_Fragment, fragment);
+    shaders->SetShader(vs);
+    shaders->SetShader(ps);
+
+    ShaderFill* fill    = new ShaderFill(shaders);
+    int         texture = -1;
+    if (pixels)
+    {
+        Ptr<Texture> t = *render->CreateTexture(format, CheckerSize, CheckerSize, pixels);
+        fill->SetTexture(0, t);
+        if (exporter)
+            texture = exporter->AddTexture(format, CheckerSize, CheckerSize, pixels);
+    }
+    if (exporter)
+        exporter->AddMaterial(fill, VShader_MVP, fragment, texture);
+    return fill;
+}
+
+static void populateHeadlessRoom(Scene* scene, RenderDevice* render, unsigned tables,
+                                 SceneFileWriter* exporter = 0)
+{
+    Color pixels[CheckerSize * CheckerSize];
+    makeCheckerPixels(Color(180, 180, 180), Color(80, 80, 80), pixels);
+    Ptr<Fill> floorFill = *makeLitFill(render, pixels, exporter);
+    makeCheckerPixels(Color(200, 180, 150), Color(170, 150, 120), pixels);
+    Ptr<Fill> wallFill  = *makeLitFill(render, pixels, exporter);
+    Ptr<Fill> plainFill = *makeLitFill(render, 0, exporter);
+
+    Ptr<Model> floor = *new Model(Prim_Triangles);
+    floor->AddSolidColorBox(-10.0f, -0.1f, -20.0f, 10.0f, 0.0f, 20.0f, Color(255, 255, 255));
+    floor->Fill = floorFill;
+    scene->World.Add(floor);
+
+    Ptr<Model> walls = *new Model(Prim_Triangles);
+    walls->AddSolidColorBox(-10.1f, 0.0f, -20.0f, -10.0f, 4.0f,  20.0f, Color(255, 255, 255));
+    walls->AddSolidColorBox( 10.0f, 0.0f, -20.0f,  10.1f, 4.0f,  20.0f, Color(255, 255, 255));
+    walls->AddSolidColorBox(-10.0f, 0.0f, -20.1f,  10.0f, 4.0f, -20.0f, Color(255, 255, 255));
+    walls->AddSolidColorBox(-10.0f, 0.0f,  20.0f,  10.0f, 4.0f,  20.1f, Color(255, 255, 255));
+    walls->Fill = wallFill;
+    scene->World.Add(walls);
+
+    Ptr<Model> ceiling = *new Model(Prim_Triangles);
+    ceiling->AddSolidColorBox(-10.0f, 4.0f, -20.0f, 10.0f, 4.1f, 20.0f, Color(200, 200, 200));
+    ceiling->Fill = plainFill;
+    scene->World.Add(ceiling);
+
+    // Six rows of four by default; more tables make a denser grid of smaller
+    // ones, k times as many each way at 1/k the size.
+    int   k       = Alg::Max(1, int(ceilf(sqrtf(tables / 24.0f))));
+    int   columns = 4 * k;
+    int   rows    = Alg::Max(2, int((tables + columns - 1) / columns));
+    float size    = 1.0f / k;
+    for (unsigned i = 0; i < tables; i++)
+    {
+        int        row    = int(i) / columns, column = int(i) % columns;
+        Ptr<Model> table  = *new Model(Prim_Triangles);
+        table->AddSolidColorBox(-0.8f * size, 0.70f * size, -0.5f * size, 0.8f * size, 0.75f * size, 0.5f * size,
+                                Color(130, 90, 50));
+        table->AddSolidColorBox(-0.75f * size, 0.0f, -0.45f * size, -0.7f * size, 0.7f * size, -0.4f * size,
+                                Color(60, 40, 20));
+        table->AddSolidColorBox( 0.7f * size,  0.0f, -0.45f * size, 0.75f * size, 0.7f * size, -0.4f * size,
+                                Color(60, 40, 20));
+        table->AddSolidColorBox(-0.75f * size, 0.0f,  0.4f * size, -0.7f * size,  0.7f * size, 0.45f * size,
+                                Color(60, 40, 20));
+        table->AddSolidColorBox( 0.7f * size,  0.0f,  0.4f * size,  0.75f * size, 0.7f * size, 0.45f * size,
+                                Color(60, 40, 20));
+        table->Fill = plainFill;
+        table->SetPosition(Vector3f(-6.0f + column * 12.0f / (columns - 1), 0.0f,
+                                    -15.0f + row * 30.0f / (rows - 1)));
+        scene->World.Add(table);
+    }
+
+    for (int i = 0; i < 4; i++)
+    {
+        float      z       = -15.0f + i * 10.0f;
+        Ptr<Model> fixture = *new Model(Prim_Triangles);
+        fixture->AddSolidColorBox(-1.0f, 3.9f, z - 0.3f, 1.0f, 4.0f, z + 0.3f, Color(250, 250, 230));
+        fixture->Fill = plainFill;
+        scene->World.Add(fixture);
+        if (i < 3)
+            scene->AddLight(Vector3f(0.0f, 3.5f, z + 5.0f), Vector4f(4.0f, 4.0f, 3.5f, 1.0f));
+    }
+    scene->SetAmbient(Vector4f(0.45f, 0.45f, 0.45f, 1.0f));
+}
+
+// The models the last cull kept, from the sorted queue or else in scene order.
+static void drawScene(Soft::RenderDevice* render, Scene* scene, const SceneBVH& cull, const RenderQueue* queue,
+                      bool instance, const Matrix4f& view)
+{
+    if (queue)
+        queue->Render(scene, render, view, instance ? render : 0);
+    else
+        cull.Render(scene, render, view);
+}
+
+// One eye, as OculusRoomTinyApp::Render does it.
+static void renderEye(Soft::RenderDevice* render, Scene* scene, const SceneBVH& cull, const RenderQueue* queue,
+                      bool instance, const StereoEyeParams& stereo, const Matrix4f& view)
+{
+    render->BeginScene(PostProcess_Distortion);
+    render->ApplyStereoParams(stereo);
+    render->Clear();
+    render->SetDepthMode(true, true);
+    drawScene(render, scene, cull, queue, instance, stereo.ViewAdjust * view);
+    render->FinishScene();
+}
+
+// Sum of the frame's pixels, weighted by position, so identical runs compare equal.
+static UInt32 frameChecksum(const Soft::RenderDevice* render)
+{
+    UInt32 checksum = 0;
+    for (int y = 0; y < render->GetFrameHeight(); y++)
+    {
+        const UInt32* row = render->GetFrame() + y * render->GetFramePitch();
+        for (int x = 0; x < render->GetFrameWidth(); x++)
+            checksum = checksum * 31 + (row[x] & 0xFFFFFF);
+    }
+    return checksum;
+}
+
+static bool writeFramePPM(const Soft::RenderDevice* render, const char* path)
+{
+    FILE* f = fopen(path, "wb");
+    if (!f)
+        return false;
+
+    fprintf(f, "P6\n%d %d\n255\n", render->GetFrameWidth(), render->GetFrameHeight());
+    Array<UByte> line;
+    line.Resize(render->GetFrameWidth() * 3);
+    for (int y = 0; y < render->GetFrameHeight(); y++)
+    {
+        const UInt32* row = render->GetFrame() + y * render->GetFramePitch();
+        for (int x = 0; x < render->GetFrameWidth(); x++)
+        {
+            line[x * 3 + 0] = UByte(row[x] >> 16);
+            line[x * 3 + 1] = UByte(row[x] >> 8);
+            line[x * 3 + 2] = UByte(row[x]);
+        }
+        fwrite(&line[0], 1, line.GetSize(), f);
+    }
+    return fclose(f) == 0;
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** Recording session check
+
+static void recordSession(const char* path, unsigned count, UInt64 firstTicks, UInt64 intervalTicks)
+{
+    Ptr<ThreeSpaceRecorder> recorder = *new ThreeSpaceRecorder;
+    if (!recorder->Open(path))
+        return;
+
+    ThreeSpaceSample sample;
+    memset(&sample.Packet, 0, sizeof(sample.Packet));
+    sample.Packet.quat[3] = 1.0f;
+    for (unsigned i = 0; i < count; i++)
+    {
+        sample.SensorTimestamp = i * (UInt32)intervalTicks;
+        sample.HostTicks       = firstTicks + i * intervalTicks;
+        recorder->Record(sample);
+    }
+    recorder->Close();
+}
+
+// Appends three sessions to a new recording at 'path': one, another an hour later,
+// and one after a "reboot" whose host times start near zero. Replaying it must give
+// one timeline with no gaps or jumps back, each session one of the previous one's
+// sample intervals after it, and looping must continue it the same way.
+static bool checkRecordingSessions(const char* path)
+{
+    remove(path);
+    recordSession(path, 50, 5000000000ull, 1000);
+    recordSession(path, 50, 5000000000ull + 3600000000ull, 1000);
+    recordSession(path, 25, 2000000, 2000);
+
+    Ptr<ThreeSpaceReplaySource> replay = *new ThreeSpaceReplaySource;
+    if (!replay->Open(path))
+    {
+        printf("check-recording: can't open %s\n", path);
+        return false;
+    }
+    replay->SetPacing(ThreeSpaceReplaySource::Replay_AsFastAsPossible);
+    replay->SetLoop(true);
+
+    // Expected gap before each sample, two loops through.
+    const unsigned count = 125;
+    bool           ok    = (replay->GetSessionCount() == 3 && replay->GetRecordCount() == count + 2);
+    UInt64         lastTicks = 0;
+    for (unsigned i = 0; i < 2 * count && ok; i++)
+    {
+        ThreeSpaceSample sample;
+        if (replay->ReadSample(&sample, 0) != ThreeSpaceSource::Read_Sample)
+        {
+            ok = false;
+            break;
+        }
+
+        unsigned n        = i % count;
+        UInt64   expected = (n > 100) ? 2000 : 1000;
+        if (i == count)
+            expected = (50 * 1000 + 50 * 1000 + 24 * 2000) / (count - 1);
+        if (i && sample.HostTicks - lastTicks != expected)
+        {
+            printf("check-recording: sample %u is %lld mks after the last, expected %u\n", i,
+                   (long long)(sample.HostTicks - lastTicks), (unsigned)expected);
+            ok = false;
+        }
+        lastTicks = sample.HostTicks;
+    }
+
+    printf("check-recording: %u sessions, %s\n", (unsigned)replay->GetSessionCount(),
+           ok ? "ok" : "FAILED");
+    return ok;
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** Euler kernel benchmark
+
+static void benchEulerKernels(const ThreeSpaceReplaySource* replay)
+{
+    UPInt count = replay->GetRecordCount();
+    if (count == 0)
+    {
+        printf("bench-euler: recording is empty\n");
+        return;
+    }
+
+    float* yaw   = (float*)malloc(count * sizeof(float) * 3);
+    float* pitch = yaw + count;
+    float* roll  = pitch + count;
+
+    static const struct { EulerKernelPath Path; const char* Name; } paths[] =
+    {
+        { EulerKernel_Scalar, "scalar" },
+        { EulerKernel_SSE2,   "sse2"   },
+        { EulerKernel_AVX2,   "avx2"   }
+    };
+
+    EulerKernelPath best = GetBestEulerKernelPath();
+
+    for (unsigned p = 0; p < sizeof(paths) / sizeof(paths[0]); p++)
+    {
+        if (paths[p].Path > best)
+            break;
+
+        // Repeat short recordings so each timing covers at least ~1M conversions.
+        unsigned repeat = unsigned(1000000 / count) + 1;
+        UInt64   start  = Timer::GetTicks();
+        for (unsigned i = 0; i < repeat; i++)
+            QuatToEulerBatch(replay->GetRecords()[0].Packet.quat, sizeof(ThreeSpaceRecord), count,
+                             yaw, pitch, roll, paths[p].Path);
+        UInt64   mks    = Timer::GetTicks() - start;
+
+        double   total  = double(count) * repeat;
+        printf("bench-euler: %-6s %10.0f quats in %8.2f ms, %7.2f Mquat/s\n", paths[p].Name,
+               total, mks / 1000.0, mks ? total / mks : 0.0);
+    }
+
+    free(yaw);
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** Fusion benchmark
+
+static float quatAngle(const Quatf& a, const Quatf& b)
+{
+    float d = fabsf(a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w);
+    return 2.0f * acosf(d < 1.0f ? d : 1.0f);
+}
+
+// Runs HeadFusion over a recording taken as ground truth. The Rift is simulated as
+// the recording plus a steady yaw drift, at the recorded times; ThreeSpace as the
+// recording itself, arriving a transport latency late. Every record is one of each,
+// so the update rate is twice the recording's. Reports the drifting Rift's error,
+// the fused error, and the cost per update.
+static void benchFusion(const ThreeSpaceReplaySource* replay)
+{
+    UPInt count = replay->GetRecordCount();
+    if (count < 2)
+    {
+        printf("bench-fusion: recording is too short\n");
+        return;
+    }
+
+    const float  driftPerSecond = 0.5f * 3.141592f / 180.0f;  // 30 degrees a minute.
+    const UInt64 latencyMks     = 8000;
+
+    // Sensor timestamps, unwrapped, from the first record. Sessions are run end to
+    // end, each a millisecond after the last; their markers get the same time as the
+    // sample before and are skipped below.
+    const ThreeSpaceRecord* records = replay->GetRecords();
+    UInt64* ticks = (UInt64*)malloc(count * sizeof(UInt64));
+    ticks[0] = 0;
+    for (UPInt i = 1; i < count; i++)
+    {
+        if (IsSessionMarker(records[i]))
+            ticks[i] = ticks[i - 1];
+        else if (IsSessionMarker(records[i - 1]))
+            ticks[i] = ticks[i - 1] + 1000;
+        else
+            ticks[i] = ticks[i - 1] + (UInt32)(records[i].SensorTimestamp - records[i - 1].SensorTimestamp);
+    }
+
+    HeadFusion fusion;
+    double     riftError = 0, fusedError = 0;
+    float      maxFusedError = 0;
+    unsigned   measured = 0;
+
+    // Repeat short recordings so the timing covers at least ~1M updates.
+    unsigned repeat = unsigned(500000 / count) + 1;
+    UInt64   start  = Timer::GetTicks();
+    for (unsigned r = 0; r < repeat; r++)
+    {
+        fusion.Reset();
+        UPInt next = 0;
+        for (UPInt i = 0; i < count; i++)
+        {
+            const ThreeSpaceRecord& rec   = records[i];
+            if (IsSessionMarker(rec))
+                continue;
+            Quatf                   truth = RoomCamera::ThreeSpaceToWorld(rec.Packet.quat);
+            Quatf                   rift  = Quatf(UpVector, driftPerSecond * ticks[i] * 1e-6f) * truth;
+            fusion.AddRiftOrientation(ticks[i], rift);
+
+            while (next < count && ticks[next] + latencyMks <= ticks[i])
+            {
+                if (!IsSessionMarker(records[next]))
+                    fusion.AddThreeSpaceOrientation(ticks[next],
+                        RoomCamera::ThreeSpaceToWorld(records[next].Packet.quat));
+                next++;
+            }
+
+            // Accuracy is the same every repeat; measure it once.
+            if (r == 0 && fusion.IsAligned())
+            {
+                float e = quatAngle(fusion.GetOrientation(), truth);
+                fusedError += e;
+                riftError  += quatAngle(rift, truth);
+                if (e > maxFusedError)
+                    maxFusedError = e;
+                measured++;
+            }
+        }
+    }
+    UInt64 mks = Timer::GetTicks() - start;
+    free(ticks);
+
+    const double toDegrees = 180.0 / 3.141592;
+    double       updates   = 2.0 * double(count) * repeat;
+    printf("bench-fusion: %u records, rift drift %.1f deg/min, threespace latency %.1f ms\n",
+           (unsigned)count, driftPerSecond * 60.0 * toDegrees, latencyMks / 1000.0);
+    if (measured)
+        printf("bench-fusion: mean error rift %.3f deg, fused %.3f deg; max fused %.3f deg\n",
+               riftError / measured * toDegrees, fusedError / measured * toDegrees,
+               maxFusedError * toDegrees);
+    printf("bench-fusion: %10.0f updates in %8.2f ms, %7.2f Mupdates/s, %.1f ns/update\n",
+           updates, mks / 1000.0, mks ? updates / mks : 0.0, mks * 1000.0 / updates);
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** Distortion mesh benchmark
+
+// Builds the distortion meshes for a width x height window, as the soft device does
+// for -distortion-mesh, and compares them against the per-pixel warp: the error at
+// every pixel inside the lens in scene texels, the cost of a rebuild, and the cost
+// of warping every pixel instead.
+static void benchDistortionMesh(int width, int height)
+{
+    StereoConfig stereo;
+    stereo.SetFullViewport(Viewport(0, 0, width, height));
+    stereo.SetStereoMode(Stereo_LeftRight_Multipass);
+    stereo.SetDistortionFitPointVP(-1.0f, 0.0f);
+    float sceneScale = stereo.GetDistortionScale();
+
+    DistortionMeshParams eyes[2];
+    for (int eye = 0; eye < 2; eye++)
+    {
+        const StereoEyeParams& params = stereo.GetEyeRenderParams(eye ? StereoEye_Right : StereoEye_Left);
+        eyes[eye] = DistortionMeshParams::FromConfig(*params.pDistortion, params.VP, width, height);
+    }
+    int eyeW = width / 2, eyeH = height;
+    printf("bench-distortion: %dx%d, %dx%d per eye, scene texture %.0fx%.0f\n", width, height,
+           eyeW, eyeH, ceilf(width * sceneScale), ceilf(height * sceneScale));
+
+    // Per pixel, both eyes.
+    float  texR[2], texG[2], texB[2], sink = 0;
+    UInt64 start = Timer::GetTicks();
+    for (int eye = 0; eye < 2; eye++)
+        for (int y = 0; y < eyeH; y++)
+            for (int x = 0; x < eyeW; x++)
+            {
+                DistortionMesh::Warp(eyes[eye], eyes[eye].X + (x + 0.5f) / width, (y + 0.5f) / height,
+                                     texR, texG, texB);
+                sink += texR[0] + texB[1];
+            }
+    UInt64 pixelMks = Timer::GetTicks() - start;
+    printf("bench-distortion: per-pixel warp %8d pixels in %8.3f ms (%.1f ns/pixel)%s\n", 2 * eyeW * eyeH,
+           pixelMks / 1000.0, pixelMks * 1000.0 / (2.0 * eyeW * eyeH), (sink == 12345.0f) ? " " : "");
+
+    static const int grids[] = { 8, 16, 32, 64 };
+    for (unsigned g = 0; g < sizeof(grids) / sizeof(grids[0]); g++)
+    {
+        // Alternating eyes forces a rebuild every time, reusing the arrays as a
+        // change of IPD would.
+        DistortionMesh mesh;
+        unsigned       builds = (1000 / grids[g] + 1) * 2;
+        start = Timer::GetTicks();
+        for (unsigned i = 0; i < builds; i++)
+            mesh.Update(eyes[i & 1], grids[g]);
+        UInt64 buildMks = Timer::GetTicks() - start;
+
+        // mesh holds the right eye now. Error is measured where the shader samples.
+        double   total    = 0;
+        float    maxError = 0;
+        unsigned inside   = 0;
+        for (int y = 0; y < eyeH; y++)
+            for (int x = 0; x < eyeW; x++)
+            {
+                float u = (x + 0.5f) / eyeW, v = (y + 0.5f) / eyeH;
+                float exactR[2], exactG[2], exactB[2];
+                DistortionMesh::Warp(eyes[1], eyes[1].X + u * eyes[1].W, eyes[1].Y + v * eyes[1].H,
+                                     exactR, exactG, exactB);
+                if (!DistortionMesh::IsInside(eyes[1], exactB))
+                    continue;
+                mesh.Sample(u, v, texR, texG, texB);
+
+                const float* exact[3] = { exactR, exactG, exactB };
+                const float* approx[3] = { texR, texG, texB };
+                for (int c = 0; c < 3; c++)
+                {
+                    float dx = (approx[c][0] - exact[c][0]) * width * sceneScale;
+                    float dy = (approx[c][1] - exact[c][1]) * height * sceneScale;
+                    float e  = sqrtf(dx * dx + dy * dy);
+                    total   += e;
+                    if (e > maxError)
+                        maxError = e;
+                }
+                inside++;
+            }
+
+        printf("bench-distortion: grid %2d: %5u vertices, %5u triangles, build %8.1f mks; "
+               "error mean %.4f max %.4f texels over %u pixels\n",
+               grids[g], (unsigned)mesh.GetVertices().GetSize(), (unsigned)mesh.GetIndices().GetSize() / 3,
+               double(buildMks) / builds, inside ? total / (3.0 * inside) : 0.0, maxError, inside);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** Static batching benchmark
+
+// Renders the soft render room as -soft-render does (both eyes, culled and sorted)
+// while the camera turns a full circle in its middle: first model by model, without
+// and with instancing, then with the room merged by StaticBatch, into the largest
+// batches and into smaller ones that culling can still reject. Reports the one-off
+// cost of building the scene, and per frame the draws and submission time.
+static void benchStaticBatch(int width, int height, unsigned tables)
+{
+    enum { Frames = 120 };
+    struct Variant
+    {
+        unsigned BatchVertices;
+        bool     Instance;
+    };
+    static const Variant variants[] =
+    {
+        { 0, false }, { 0, true }, { StaticBatch::MaxVertices, true }, { 4096, true }, { 1024, true }
+    };
+
+    StereoConfig stereo;
+    stereo.SetFullViewport(Viewport(0, 0, width, height));
+    stereo.SetStereoMode(Stereo_LeftRight_Multipass);
+    stereo.SetDistortionFitPointVP(-1.0f, 0.0f);
+    const StereoEyeParams& left  = stereo.GetEyeRenderParams(StereoEye_Left);
+    const StereoEyeParams& right = stereo.GetEyeRenderParams(StereoEye_Right);
+
+    printf("bench-static: %dx%d, %u tables, %d frames turning in place\n", width, height, tables, (int)Frames);
+    for (unsigned b = 0; b < sizeof(variants) / sizeof(variants[0]); b++)
+    {
+        RendererParams          params;
+        Ptr<Soft::RenderDevice> render = *Soft::RenderDevice::CreateOffscreenDevice(params, width, height);
+        if (!render)
+        {
+            printf("bench-static: can't create a %dx%d soft render device\n", width, height);
+            return;
+        }
+        render->SetSceneRenderScale(stereo.GetDistortionScale());
+
+        Scene       scene;
+        SceneBVH    bvh;
+        RenderQueue queue;
+        StaticBatch batch;
+        UInt64      start = Timer::GetTicks();
+        populateHeadlessRoom(&scene, render, tables);
+        UInt64      batchStart = Timer::GetTicks();
+        if (variants[b].BatchVertices)
+            batch.Build(&scene.World, variants[b].BatchVertices);
+        UInt64      batchMks = Timer::GetTicks() - batchStart;
+        bvh.Build(&scene);
+        UInt64      buildMks = Timer::GetTicks() - start;
+
+        render->ResetStats();
+        UInt64   renderMks = 0;
+        Vector3f eye(0.0f, 1.6f, 0.0f);
+        for (int frame = 0; frame < Frames; frame++)
+        {
+            float    yaw  = frame * 2.0f * 3.14159265f / Frames;
+            Matrix4f view = Matrix4f::LookAtRH(eye, eye + Vector3f(sinf(yaw), 0.0f, -cosf(yaw)),
+                                               Vector3f(0.0f, 1.0f, 0.0f));
+            UInt64   frameStart = Timer::GetTicks();
+            bvh.Cull(CullFrustum::FromStereo(left, right, view));
+            queue.Clear();
+            bvh.Queue(&queue, view);
+            queue.Sort();
+            renderEye(render, &scene, bvh, &queue, variants[b].Instance, left, view);
+            renderEye(render, &scene, bvh, &queue, variants[b].Instance, right, view);
+            render->Present();
+            render->ForceFlushGPU();
+            renderMks += Timer::GetTicks() - frameStart;
+        }
+
+        const Soft::RenderDevice::Stats& stats = render->GetStats();
+        if (variants[b].BatchVertices)
+            printf("bench-static: batch %5u         ", variants[b].BatchVertices);
+        else
+            printf("bench-static: per-model%s", variants[b].Instance ? ", instanced" : "           ");
+        printf(" %5u models, build %8.3f ms (batching %7.3f ms); per frame %6.1f draws, "
+               "%8.1f triangles, %.3f ms submit, %.3f ms raster\n", bvh.GetModelCount(),
+               buildMks / 1000.0, batchMks / 1000.0, double(stats.Draws) / Frames,
+               double(stats.Triangles) / Frames, double(renderMks - stats.FlushMks) / 1000.0 / Frames,
+               double(stats.FlushMks) / 1000.0 / Frames);
+        render->Shutdown();
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** main
+
+int main(int argc, char** argv)
+{
+    UInt64 startupTicks = Timer::GetTicks();
+
+    OVR::System::Init(Log::ConfigureDefaultLog(LogMask_All));
+    AsyncLog::Start();
+
+    const char* replayPath  = 0;
+    bool        replayFast  = false;
+    bool        fuzz        = false;
+    UInt32      fuzzSeed    = 0;
+    bool        benchEuler  = false;
+    bool        benchFuse   = false;
+    unsigned    frames      = 1000;
+    unsigned    fps         = 0;
+    float       predictMs   = -1.0f;
+    bool        viewEuler   = false;
+    bool        simThread   = false;
+    const char* tracePath   = 0;
+    const char* cachePath   = 0;
+    const char* recordPath  = 0;
+    const char* inputPath   = 0;
+    const char* serialPaths[ThreeSpaceSensorGroup::MaxSensors];
+    unsigned    serialCount = 0;
+    unsigned    simRateHz   = 0;
+    unsigned    simSensors  = 1;
+    bool        softRender  = false;
+    int         renderW     = 1280;
+    int         renderH     = 800;
+    const char* dumpPath    = 0;
+    bool        singlePass  = false;
+    int         meshGrid    = 0;
+    bool        benchMesh   = false;
+    bool        cullScene   = true;
+    bool        sortScene   = true;
+    bool        instanceScene = true;
+    unsigned    roomTables  = 24;
+    int         batchVertices = -1;
+    bool        benchBatch  = false;
+    const char* scenePath   = 0;
+    const char* exportPath  = 0;
+    const char* checkRecordingPath = 0;
+
+    ThreeSpaceSimulator::Settings simSettings;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg  = argv[i];
+        const char* next = (i + 1 < argc) ? argv[i + 1] : 0;
+
+        if (!strcmp(arg, "-tss-replay") && next)      { replayPath = next; i++; }
+        else if (!strcmp(arg, "-replay-fast"))          replayFast = true;
+        else if (!strcmp(arg, "-tss-predict") && next) { predictMs = (float)atof(next); i++; }
+        else if (!strcmp(arg, "-view-euler"))           viewEuler = true;
+        else if (!strcmp(arg, "-sim-thread"))           simThread = true;
+        else if (!strcmp(arg, "-frames") && next)      { frames = (unsigned)atoi(next); i++; }
+        else if (!strcmp(arg, "-fps") && next)         { fps = (unsigned)atoi(next); i++; }
+        else if (!strcmp(arg, "-fuzz") && next)        { fuzz = true; fuzzSeed = (UInt32)strtoul(next, 0, 0); i++; }
+        else if (!strcmp(arg, "-bench-euler"))          benchEuler = true;
+        else if (!strcmp(arg, "-bench-fusion"))         benchFuse = true;
+        else if (!strcmp(arg, "-check-recording") && next) { checkRecordingPath = next; i++; }
+        else if (!strcmp(arg, "-soft-render"))          softRender = true;
+        else if (!strcmp(arg, "-render-size") && next && sscanf(next, "%dx%d", &renderW, &renderH) == 2) i++;
+        else if (!strcmp(arg, "-render-dump") && next) { dumpPath = next; softRender = true; i++; }
+        else if (!strcmp(arg, "-stereo-single-pass"))   { singlePass = true; softRender = true; }
+        else if (!strcmp(arg, "-distortion-mesh") && next) { meshGrid = atoi(next); softRender = true; i++; }
+        else if (!strcmp(arg, "-bench-distortion"))     benchMesh = true;
+        else if (!strcmp(arg, "-no-cull"))              cullScene = false;
+        else if (!strcmp(arg, "-no-sort"))              sortScene = false;
+        else if (!strcmp(arg, "-no-instance"))          instanceScene = false;
+        else if (!strcmp(arg, "-tables") && next)       { roomTables = (unsigned)atoi(next); i++; }
+        else if (!strcmp(arg, "-static-batch") && next) { batchVertices = atoi(next); i++; }
+        else if (!strcmp(arg, "-bench-static"))         benchBatch = true;
+        else if (!strcmp(arg, "-scene") && next)        { scenePath = next; softRender = true; i++; }
+        else if (!strcmp(arg, "-scene-export") && next) { exportPath = next; softRender = true; i++; }
+        else if (!strcmp(arg, "-trace") && next)       { tracePath = next; i++; }
+        else if (!strcmp(arg, "-tss-cache") && next)   { cachePath = next; i++; }
+        else if (!strcmp(arg, "-input-record") && next) { recordPath = next; i++; }
+        else if (!strcmp(arg, "-input-replay") && next) { inputPath = next; i++; }
+        else if (!strcmp(arg, "-tss-serial") && next)
+        {
+            if (serialCount < ThreeSpaceSensorGroup::MaxSensors)
+                serialPaths[serialCount++] = next;
+            i++;
+        }
+        else if (!strcmp(arg, "-tss-sim") && next)     { simRateHz = (unsigned)atoi(next); i++; }
+        else if (!strcmp(arg, "-sim-sensors") && next) { simSensors = Alg::Clamp((unsigned)atoi(next), 1u, (unsigned)ThreeSpaceSensorGroup::MaxSensors); i++; }
+        else if (!strcmp(arg, "-sim-jitter") && next)  { simSettings.JitterMks = (unsigned)atoi(next); i++; }
+        else if (!strcmp(arg, "-sim-dropout") && next) { simSettings.DropoutProbability = (float)atof(next); i++; }
+        else if (!strcmp(arg, "-sim-dropout-length") && next) { simSettings.DropoutLength = (unsigned)atoi(next); i++; }
+        else
+        {
+            fprintf(stderr, "Unknown or incomplete argument: %s\n", arg);
+            AsyncLog::Stop();
+            OVR::System::Destroy();
+            return 2;
+        }
+    }
+
+    if (checkRecordingPath)
+    {
+        bool ok = checkRecordingSessions(checkRecordingPath);
+        AsyncLog::Stop();
+        OVR::System::Destroy();
+        return ok ? 0 : 1;
+    }
+
+    Trace::SetThreadName("Main");
+    if (tracePath && !Trace::Open(tracePath))
+    {
+        AsyncLog::Stop();
+        OVR::System::Destroy();
+        return 1;
+    }
+
+    RoomCamera            camera;
+    ThreeSpaceSensorGroup sensors;
+
+    if (viewEuler)
+        camera.ViewPath = RoomCamera::ViewPath_Euler;
+    if (predictMs >= 0.0f)
+    {
+        sensors.SetPredictionEnabled(predictMs > 0.0f);
+        sensors.SetPredictionInterval(predictMs * 0.001f);
+    }
+
+    Ptr<ThreeSpaceSimulator> simulators[ThreeSpaceSensorGroup::MaxSensors];
+    Ptr<IngestProbeSource>   probes[ThreeSpaceSensorGroup::MaxSensors];
+    unsigned                 simCount = 0;
+
+    if (simRateHz && !fuzz)
+    {
+        simSettings.RateHz = Alg::Clamp(simRateHz, 100u, 1000u);
+        for (simCount = 0; simCount < simSensors; simCount++)
+        {
+            simSettings.Seed         = simCount + 1;
+            simSettings.SerialNumber = 0x1234ABC0 + simCount;
+
+            simulators[simCount] = *new ThreeSpaceSimulator(simSettings);
+            if (!simulators[simCount]->Open())
+            {
+                fprintf(stderr, "Can't create ThreeSpace simulator pty\n");
+                stopSimulators(simulators, simCount);
+                AsyncLog::Stop();
+                OVR::System::Destroy();
+                return 1;
+            }
+            simulators[simCount]->Start();
+            if (serialCount < ThreeSpaceSensorGroup::MaxSensors)
+                serialPaths[serialCount++] = simulators[simCount]->GetPortName();
+        }
+    }
+
+    if (serialCount && !fuzz)
+    {
+        // Configure every port at once, then give each its own reader thread;
+        // the sensors stream in parallel.
+        ThreeSpaceDeviceCache cache;
+        if (cachePath)
+            cache.Load(cachePath);
+
+        TaskGraph      discovery("ThreeSpace discovery");
+        SerialOpenTask opens[ThreeSpaceSensorGroup::MaxSensors];
+        for (unsigned i = 0; i < serialCount; i++)
+        {
+            opens[i].Path   = serialPaths[i];
+            opens[i].pCache = cachePath ? &cache : 0;
+            discovery.AddTask("Open serial port", &SerialOpenTask::Run, &opens[i]);
+        }
+        bool opened = discovery.Run();
+        discovery.Dump();
+        if (opened && cachePath)
+            cache.Save(cachePath);
+        if (!opened)
+        {
+            stopSimulators(simulators, simCount);
+            AsyncLog::Stop();
+            OVR::System::Destroy();
+            return 1;
+        }
+
+        for (unsigned i = 0; i < serialCount; i++)
+        {
+            probes[i] = *new IngestProbeSource(opens[i].Source);
+            Ptr<ThreeSpaceReader> reader = *new ThreeSpaceReader(probes[i]);
+            reader->Start();
+            sensors.AddSensor(reader);
+        }
+    }
+    else if (replayPath && !fuzz)
+    {
+        Ptr<ThreeSpaceReplaySource> replay = *new ThreeSpaceReplaySource;
+        if (!replay->Open(replayPath))
+        {
+            fprintf(stderr, "Can't open ThreeSpace recording %s\n", replayPath);
+            AsyncLog::Stop();
+            OVR::System::Destroy();
+            return 1;
+        }
+        if (benchEuler)
+            benchEulerKernels(replay);
+        if (benchFuse)
+            benchFusion(replay);
+
+        replay->SetPacing(replayFast ? ThreeSpaceReplaySource::Replay_AsFastAsPossible
+                                     : ThreeSpaceReplaySource::Replay_RealTime);
+        replay->SetLoop(true);
+
+        Ptr<ThreeSpaceReader> reader = *new ThreeSpaceReader(replay);
+        reader->Start();
+        sensors.AddSensor(reader);
+    }
+    else if (benchEuler || benchFuse)
+        printf("%s: needs -tss-replay\n", benchEuler ? "bench-euler" : "bench-fusion");
+
+    // Fuzz samples go straight into the head sensor's predictor.
+    if (fuzz)
+        sensors.AddSensor(0);
+
+    FuzzRandom  rnd(fuzzSeed);
+    UInt32      fuzzSensorTime = 0xFFFF0000u;
+    unsigned    badFrames = 0;
+
+    const float frameDt   = fps ? 1.0f / fps : 1.0f / 60.0f;
+    UInt64      nextFrame = Timer::GetTicks();
+    FrameTiming timing;
+
+    RoomSimulation   simulation;
+    RoomInputJournal journal;
+    RoomInputReplay  inputReplay;
+    if (recordPath && journal.Open(recordPath, simulation.GetStepMks()))
+        simulation.SetJournal(&journal);
+    if (inputPath)
+    {
+        if (!inputReplay.Open(inputPath))
+        {
+            fprintf(stderr, "Can't replay input journal %s\n", inputPath);
+            sensors.Stop();
+            stopSimulators(simulators, simCount);
+            AsyncLog::Stop();
+            OVR::System::Destroy();
+            return 1;
+        }
+        simulation.SetReplay(&inputReplay);
+        printf("input-replay: %u events over %llu steps\n", (unsigned)inputReplay.GetEventCount(),
+               (unsigned long long)inputReplay.GetLastStep());
+    }
+    if (simThread)
+        simulation.Start();
+
+    ThreeSpaceSnapshot snapshot;
+    LatencyHistogram   skew;
+
+    if (benchMesh)
+        benchDistortionMesh(renderW, renderH);
+    if (benchBatch)
+        benchStaticBatch(renderW, renderH, roomTables);
+
+    // Set up as setupRendering and setupScene do, for a window renderW x renderH.
+    Ptr<Soft::RenderDevice> render;
+    Scene                   scene;
+    SceneBVH                sceneBVH;
+    StereoConfig            stereo;
+    LatencyHistogram        renderMks;
+    LatencyHistogram        cullMks;
+    UInt64                  visibleModels = 0;
+    RenderQueue             renderQueue;
+    UInt64                  shaderChanges = 0, unsortedShaderChanges = 0;
+    UInt64                  fillChanges = 0, unsortedFillChanges = 0;
+    UInt64                  batches = 0;
+    if (softRender)
+    {
+        RendererParams params;
+        render = *Soft::RenderDevice::CreateOffscreenDevice(params, renderW, renderH);
+        if (!render)
+        {
+            fprintf(stderr, "Can't create a %dx%d soft render device\n", renderW, renderH);
+            simulation.Stop();
+            sensors.Stop();
+            stopSimulators(simulators, simCount);
+            AsyncLog::Stop();
+            OVR::System::Destroy();
+            return 1;
+        }
+        stereo.SetFullViewport(Viewport(0, 0, renderW, renderH));
+        stereo.SetStereoMode(Stereo_LeftRight_Multipass);
+        stereo.SetDistortionFitPointVP(-1.0f, 0.0f);
+        render->SetSceneRenderScale(stereo.GetDistortionScale());
+        render->SetDistortionMeshGrid(meshGrid);
+        UInt64 sceneStart = Timer::GetTicks();
+        if (scenePath)
+        {
+            SceneFile sceneFile;
+            if (!sceneFile.Open(scenePath))
+            {
+                fprintf(stderr, "Can't load scene %s\n", scenePath);
+                render->Shutdown();
+                simulation.Stop();
+                sensors.Stop();
+                stopSimulators(simulators, simCount);
+                AsyncLog::Stop();
+                OVR::System::Destroy();
+                return 1;
+            }
+            UInt64 opened = Timer::GetTicks();
+            sceneFile.Populate(&scene, render);
+            const SceneFileHeader& header = sceneFile.GetHeader();
+            printf("scene: %s: %u models, %u meshes, %u materials, %u textures; open %.3f ms, "
+                   "populate %.3f ms\n", scenePath, header.ModelCount, header.MeshCount, header.MaterialCount,
+                   header.TextureCount, (opened - sceneStart) / 1000.0, (Timer::GetTicks() - opened) / 1000.0);
+        }
+        else
+        {
+            SceneFileWriter exporter;
+            populateHeadlessRoom(&scene, render, roomTables, exportPath ? &exporter : 0);
+            printf("scene: built in code in %.3f ms\n", (Timer::GetTicks() - sceneStart) / 1000.0);
+            if (exportPath)
+            {
+                if (exporter.Write(exportPath, &scene))
+                    printf("scene-export: %s: %u models, %u meshes, %u skipped\n", exportPath,
+                           exporter.GetModelCount(), exporter.GetMeshCount(), exporter.GetSkippedCount());
+                else
+                    printf("scene-export: can't write %s\n", exportPath);
+            }
+        }
+        if (batchVertices >= 0)
+        {
+            UInt64      batchStart = Timer::GetTicks();
+            StaticBatch batch;
+            batch.Build(&scene.World, batchVertices ? (unsigned)batchVertices : (unsigned)StaticBatch::MaxVertices);
+            const StaticBatch::Stats& batchStats = batch.GetStats();
+            printf("static-batch: %u models into %u batches, %u vertices, %u triangles, %u kept; %.3f ms\n",
+                   batchStats.Models, batchStats.Batches, batchStats.Vertices, batchStats.Triangles,
+                   batchStats.Kept, (Timer::GetTicks() - batchStart) / 1000.0);
+        }
+        sceneBVH.Build(&scene);
+    }
+
+    for (unsigned frame = 0; frame < frames; frame++)
+    {
+        if (fps)
+        {
+            while (Timer::GetTicks() < nextFrame)
+                Thread::MSleep(0);
+            nextFrame += Timer::MksPerSecond / fps;
+        }
+
+        timing.BeginFrame();
+
+        // Fuzzing runs on a simulated clock, so prediction does not depend on how
+        // fast frames happen to run; movement always does, unless -sim-thread.
+        UInt64 frameTicks = UInt64(frame * frameDt * Timer::MksPerSecond);
+        UInt64 start      = fuzz ? frameTicks : Timer::GetTicks();
+        UInt64 inputTicks = simThread ? Timer::GetTicks() : frameTicks;
+
+        scriptInput(&simulation, frame, frameDt, inputTicks);
+
+        camera.BeginFrame();
+
+        if (fuzz)
+        {
+            // Synchronous, so the sequence only depends on the seed.
+            ThreeSpaceSample sample;
+            unsigned         n = rnd.Next() % 4;
+            for (unsigned i = 0; i < n; i++)
+            {
+                makeFuzzSample(rnd, &fuzzSensorTime, &sample, start);
+                sensors.GetTracker(0).Predictor.AddSample(sample);
+            }
+        }
+
+        float quat[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        sensors.Sample(start, &snapshot);
+        if (snapshot.SensorCount > 1)
+            skew.Record(snapshot.SkewMks);
+
+        const ThreeSpacePose& head = snapshot.Poses[0];
+        if (snapshot.SensorCount && head.Valid)
+        {
+            quat[0] = head.Predicted.x;
+            quat[1] = head.Predicted.y;
+            quat[2] = head.Predicted.z;
+            quat[3] = head.Predicted.w;
+            camera.ApplyThreeSpaceOrientation(quat);
+            if (!fuzz)
+                timing.SetSampleTicks(head.SampleTicks);
+        }
+        timing.Mark(FrameStage_Sensor);
+
+        bool hasSensor = snapshot.SensorCount != 0;
+        simulation.SetSensor(inputTicks, hasSensor, camera.LastSensorYaw);
+        if (fuzz && (rnd.Next() % 8) == 0)
+        {
+            int dx = int(rnd.Next() % 401) - 200;
+            int dy = int(rnd.Next() % 401) - 200;
+            simulation.PushEvent(RoomInputEvent::MouseMove(inputTicks, dx, dy));
+        }
+        // With the thread, frames catch it up to real time as the app does.
+        UInt64 motionTicks = simThread ? Timer::GetTicks() : frameTicks;
+        simulation.Advance(motionTicks);
+        camera.ApplyMotion(simulation.GetMotion(motionTicks), hasSensor);
+        timing.Mark(FrameStage_Input);
+
+        camera.UpdateView();
+        timing.Mark(FrameStage_View);
+
+        if (render)
+        {
+            UInt64 renderStart = Timer::GetTicks();
+            const StereoEyeParams& left  = stereo.GetEyeRenderParams(StereoEye_Left);
+            const StereoEyeParams& right = stereo.GetEyeRenderParams(StereoEye_Right);
+            const RenderQueue*     queue = 0;
+            // Culled and sorted once for both eyes, as the app does.
+            if (cullScene)
+                sceneBVH.Cull(CullFrustum::FromStereo(left, right, camera.View));
+            else
+                sceneBVH.CullNone();
+            visibleModels += sceneBVH.GetVisibleCount();
+            if (sortScene)
+            {
+                renderQueue.Clear();
+                sceneBVH.Queue(&renderQueue, camera.View);
+                renderQueue.Sort();
+                queue = &renderQueue;
+                const RenderQueue::Stats& queueStats = renderQueue.GetStats();
+                shaderChanges         += queueStats.ShaderChanges;
+                fillChanges           += queueStats.FillChanges;
+                batches               += queueStats.Batches;
+                unsortedShaderChanges += queueStats.UnsortedShaderChanges;
+                unsortedFillChanges   += queueStats.UnsortedFillChanges;
+            }
+            cullMks.Record(UInt32(Timer::GetTicks() - renderStart));
+            if (singlePass)
+            {
+                // Render0 is the scene pass, Render1 both eyes' distortion.
+                render->BeginStereoScene(PostProcess_Distortion, left, right);
+                render->Clear();
+                render->SetDepthMode(true, true);
+                drawScene(render, &scene, sceneBVH, queue, instanceScene, camera.View);
+                timing.Mark(FrameStage_Render0);
+                render->FinishStereoScene();
+                timing.Mark(FrameStage_Render1);
+            }
+            else
+            {
+                renderEye(render, &scene, sceneBVH, queue, instanceScene, left, camera.View);
+                timing.Mark(FrameStage_Render0);
+                renderEye(render, &scene, sceneBVH, queue, instanceScene, right, camera.View);
+                timing.Mark(FrameStage_Render1);
+            }
+            render->Present();
+            timing.Mark(FrameStage_Present);
+            render->ForceFlushGPU();
+            timing.Mark(FrameStage_Flush);
+            renderMks.Record(UInt32(Timer::GetTicks() - renderStart));
+        }
+        timing.EndFrame();
+
+        if (frame == 0)
+        {
+            UInt64 firstFrameTicks = Timer::GetTicks();
+            Trace::Complete("Time to first frame", startupTicks, firstFrameTicks);
+            printf("Time to first frame: %.2f ms\n", (firstFrameTicks - startupTicks) / 1000.0);
+        }
+
+        if (!isFinite(camera.View))
+        {
+            if (badFrames++ < 10)
+                printf("fuzz: non-finite View at frame %u, quat (%g, %g, %g, %g)\n", frame,
+                       quat[0], quat[1], quat[2], quat[3]);
+        }
+    }
+
+    UInt32 readerErrors[ThreeSpaceSensorGroup::MaxSensors];
+    for (unsigned i = 0; i < sensors.GetSensorCount(); i++)
+    {
+        ThreeSpaceReader* reader = sensors.GetTracker(i).GetReader();
+        readerErrors[i] = reader ? reader->GetErrorCount() : 0;
+    }
+    simulation.Stop();
+    simulation.SetJournal(0);
+    journal.Close();
+    sensors.Stop();
+    stopSimulators(simulators, simCount);
+    Trace::Close();
+
+    // Checksum of the final View, so runs with identical input can be compared.
+    double checksum = 0.0;
+    for (int i = 0; i < 4; i++)
+        for (int j = 0; j < 4; j++)
+            checksum += camera.View.M[i][j] * (i * 4 + j + 1);
+
+    timing.Dump();
+    printf("EyePos: (%.4f, %.4f, %.4f), EyeYaw: %.4f, View checksum: %.6f\n",
+           camera.EyePos.x, camera.EyePos.y, camera.EyePos.z, camera.EyeYaw, checksum);
+    for (unsigned i = 0; i < serialCount && probes[i]; i++)
+    {
+        const LatencyHistogram& h = probes[i]->Latency;
+        if (i < simCount)
+            printf("tss-sim %u: %u Hz, sent %u, dropped %u, command errors %u\n", i, simSettings.RateHz,
+                   simulators[i]->GetSentCount(), simulators[i]->GetDroppedCount(),
+                   simulators[i]->GetCommandErrorCount());
+        printf("tss-ingest %u: received %u, reader errors %u, latency mks min %u p50 %u p99 %u "
+               "p99.9 %u max %u\n", i, probes[i]->Received, readerErrors[i], h.GetMin(),
+               h.GetPercentile(0.5), h.GetPercentile(0.99), h.GetPercentile(0.999), h.GetMax());
+    }
+    if (skew.GetCount())
+        printf("tss-group: %u sensors, snapshot skew mks p50 %u p99 %u max %u\n",
+               sensors.GetSensorCount(), skew.GetPercentile(0.5), skew.GetPercentile(0.99), skew.GetMax());
+    if (fuzz)
+        printf("fuzz: seed %u, %u non-finite frames\n", fuzzSeed, badFrames);
+    if (render && frames)
+    {
+        // Submission is everything but resolving the bins: scene traversal, vertex
+        // shading, clipping and binning.
+        const Soft::RenderDevice::Stats& stats = render->GetStats();
+        double renderMs = renderMks.GetMean() * 0.001;
+        double rasterMs = double(stats.FlushMks) * 0.001 / frames;
+        printf("soft-render: %dx%d %s, %u threads, per frame: %u draws, %u state binds, %u triangles, "
+               "%u rasterized, %u tile entries; %.3f ms submit, %.3f ms raster, p99 %.3f ms; "
+               "frame checksum %08X\n",
+               renderW, renderH, singlePass ? "single-pass" : "multipass", render->GetThreadCount(),
+               stats.Draws / frames, stats.States / frames, stats.Triangles / frames,
+               stats.Rasterized / frames, stats.BinEntries / frames, renderMs - rasterMs, rasterMs,
+               renderMks.GetPercentile(0.99) * 0.001, frameChecksum(render));
+        printf("soft-render: %.1f of %u models visible per frame, %u tree nodes tested; "
+               "cull%s %.1f mks mean, p99 %u mks\n", double(visibleModels) / frames, sceneBVH.GetModelCount(),
+               sceneBVH.GetNodesTested(), sortScene ? " and sort" : "", cullMks.GetMean(),
+               cullMks.GetPercentile(0.99));
+        if (sortScene)
+            printf("soft-render: render queue per pass: %.1f items in %.1f batches%s; state changes "
+                   "%.1f shader (%.1f unsorted), %.1f fill (%.1f unsorted)\n",
+                   double(visibleModels) / frames, double(batches) / frames,
+                   instanceScene ? "" : " (not instanced)", double(shaderChanges) / frames,
+                   double(unsortedShaderChanges) / frames, double(fillChanges) / frames,
+                   double(unsortedFillChanges) / frames);
+        if (dumpPath && !writeFramePPM(render, dumpPath))
+            printf("soft-render: can't write %s\n", dumpPath);
+        render->Shutdown();
+    }
+
+    AsyncLog::Stop();
+    OVR::System::Destroy();
+    return badFrames ? 1 : 0;
+}
@@ -0,0 +1,166 @@
+/************************************************************************************
+
+Filename    :   OculusRoomTiny_Fusion.cpp
+Content     :   Complementary fusion of Rift and ThreeSpace head orientation
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "OculusRoomTiny_Fusion.h"
+#include "../../LibOVR/Src/Kernel/OVR_Timer.h"
+
+#include <math.h>
+
+// Normalized lerp along the shorter arc; as good as slerp for the small angles
+// between neighbouring samples and per-update corrections.
+static Quatf nlerp(const Quatf& a, const Quatf& b, float t)
+{
+    Quatf bb = b;
+    if (a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w < 0)
+        bb = b * -1.0f;
+    return (a * (1.0f - t) + bb * t).Normalized();
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** HeadFusion
+
+const float HeadFusion::MaxStepSeconds = 0.1f;
+
+HeadFusion::HeadFusion()
+    : TimeConstant(2.0f)
+{
+    Reset();
+}
+
+void HeadFusion::Reset()
+{
+    HistoryCount        = 0;
+    HistoryNext         = 0;
+    Correction          = Quatf();
+    DriftRate           = Vector3f(0, 0, 0);
+    Aligned             = false;
+    LastCorrectionTicks = 0;
+    LastError           = 0;
+}
+
+void HeadFusion::AddRiftOrientation(UInt64 ticks, const Quatf& orient)
+{
+    HistoryEntry& entry = History[HistoryNext];
+    entry.Ticks         = ticks;
+    entry.Orientation   = orient;
+    HistoryNext         = (HistoryNext + 1) % HistorySize;
+    if (HistoryCount < HistorySize)
+        HistoryCount++;
+}
+
+bool HeadFusion::getRiftAt(UInt64 ticks, Quatf* orient) const
+{
+    // Walk back from the newest entry to the first one at or before 'ticks'.
+    unsigned newer = HistorySize;
+    for (unsigned i = 0; i < HistoryCount; i++)
+    {
+        unsigned            index = (HistoryNext + HistorySize - 1 - i) % HistorySize;
+        const HistoryEntry& entry = History[index];
+
+        if (entry.Ticks > ticks)
+        {
+            newer = index;
+            continue;
+        }
+        if (newer == HistorySize || entry.Ticks == ticks)
+        {
+            // An exact hit, or past the newest entry, where nothing is known.
+            if (entry.Ticks != ticks)
+                return false;
+            *orient = entry.Orientation;
+            return true;
+        }
+
+        const HistoryEntry& next = History[newer];
+        float t = float(ticks - entry.Ticks) / float(next.Ticks - entry.Ticks);
+        *orient = nlerp(entry.Orientation, next.Orientation, t);
+        return true;
+    }
+    return false;
+}
+
+void HeadFusion::AddThreeSpaceOrientation(UInt64 ticks, const Quatf& orient)
+{
+    Quatf rift;
+    if (!getRiftAt(ticks, &rift))
+    {
+        // Newer than any Rift orientation: compare against the newest, which the
+        // next frame's would only be closer to. Older than the history: drop it.
+        if (HistoryCount == 0)
+            return;
+        const HistoryEntry& newest = History[(HistoryNext + HistorySize - 1) % HistorySize];
+        if (ticks < newest.Ticks)
+            return;
+        rift = newest.Orientation;
+    }
+
+    if (!Aligned)
+    {
+        // Whatever headings the two were reset to, they agree from here on.
+        Correction          = (orient * rift.Inverted()).Normalized();
+        Aligned             = true;
+        LastCorrectionTicks = ticks;
+        LastError           = 0;
+        return;
+    }
+
+    // World-frame rotation that would take the output at 'ticks' onto ThreeSpace,
+    // as a rotation vector.
+    Quatf error = orient * (Correction * rift).Inverted();
+    if (error.w < 0)
+        error = error * -1.0f;
+    LastError = 2.0f * acosf(error.w < 1.0f ? error.w : 1.0f);
+
+    Vector3f errorVector(0, 0, 0);
+    float    sinHalf = sqrtf(error.x * error.x + error.y * error.y + error.z * error.z);
+    if (sinHalf > 1e-7f)
+        errorVector = Vector3f(error.x, error.y, error.z) * (LastError / sinHalf);
+
+    // Samples arriving out of order or at the same time add nothing; after a long gap
+    // the correction is taken in steps no larger than MaxStepSeconds.
+    float dt = 0;
+    if (ticks > LastCorrectionTicks)
+    {
+        dt = float(ticks - LastCorrectionTicks) * (1.0f / Timer::MksPerSecond);
+        LastCorrectionTicks = ticks;
+    }
+    if (dt > MaxStepSeconds)
+        dt = MaxStepSeconds;
+
+    // Critically damped PI loop: the proportional part closes the error with time
+    // constant TimeConstant, and the integral part learns the Rift's drift rate so a
+    // steadily drifting yaw is tracked without a standing error.
+    float    omega = (TimeConstant > 0) ? 1.0f / TimeConstant : 1.0f / MaxStepSeconds;
+    DriftRate     += errorVector * (omega * omega * dt);
+    Vector3f step  = errorVector * (2.0f * omega * dt) + DriftRate * dt;
+
+    float angle = step.Length();
+    if (angle > 1e-9f)
+        Correction = (Quatf(step, angle) * Correction).Normalized();
+}
+
+Quatf HeadFusion::GetOrientation() const
+{
+    if (HistoryCount == 0)
+        return Correction;
+    const Quatf& rift = History[(HistoryNext + HistorySize - 1) % HistorySize].Orientation;
+    return Aligned ? Correction * rift : rift;
+}
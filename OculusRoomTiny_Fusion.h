@@ -0,0 +1,121 @@
+/************************************************************************************
+
+Filename    :   OculusRoomTiny_Fusion.h
+Content     :   Complementary fusion of Rift and ThreeSpace head orientation
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+#ifndef INC_OculusRoomTiny_Fusion_h
+#define INC_OculusRoomTiny_Fusion_h
+
+#include "../../LibOVR/Src/Kernel/OVR_Types.h"
+#include "../../LibOVR/Src/Kernel/OVR_Math.h"
+
+using namespace OVR;
+
+//-------------------------------------------------------------------------------------
+// ***** HeadFusion
+
+// Combines the two head IMUs into one orientation when both are present. The Rift's
+// SensorFusion is the low-latency source: its 1 kHz gyro integration is used as is
+// for everything that changes quickly. Its yaw drifts, though, and the ThreeSpace
+// sensor's magnetometer-corrected orientation does not, so ThreeSpace is the
+// low-frequency reference the output is pulled towards.
+//
+// The output is Correction * Rift, where Correction is a world-frame rotation. The
+// first ThreeSpace orientation sets it outright, which also absorbs the different
+// heading each sensor was reset or tared to. Each later one is compared against
+// the output at the ThreeSpace sample's own time, looked up in a short history of
+// Rift orientations, so ThreeSpace transport latency is not mistaken for error;
+// Correction is then steered by a critically damped PI loop: the proportional term
+// closes the error over the time constant, and the integral term learns the Rift's
+// yaw drift rate, so steady drift leaves no standing error. High frequencies come
+// from the Rift and low frequencies from ThreeSpace, with the crossover near
+// 1 / (2 pi TimeConstant).
+//
+// Both orientations are in world coordinates (ThreeSpace already mapped by
+// RoomCamera::ThreeSpaceToWorld), and the sensor is expected to be mounted on the
+// headset with its axes along the headset's.
+//
+// Updates are a handful of quaternion products and no allocation, so it runs at the
+// combined sensor rate on one core with room to spare; -bench-fusion in the headless
+// driver measures both the cost and the accuracy on a recording.
+
+class HeadFusion
+{
+public:
+    enum
+    {
+        // ~64 ms of Rift orientations at 1 kHz, or many frames when fed per frame.
+        HistorySize = 64
+    };
+
+    // Longest stretch one ThreeSpace orientation accounts for.
+    static const float MaxStepSeconds;
+
+    HeadFusion();
+
+    // Forgets everything; the next ThreeSpace orientation re-aligns the sensors.
+    void        Reset();
+
+    // Response time of the correction loop, in seconds. Default 2; shorter tracks
+    // ThreeSpace more closely but lets more of its noise and latency through.
+    void        SetTimeConstant(float seconds)  { TimeConstant = seconds; }
+    float       GetTimeConstant() const         { return TimeConstant; }
+
+    // Rift orientation as of 'ticks' (Timer::GetTicks()). Ticks must not decrease.
+    void        AddRiftOrientation(UInt64 ticks, const Quatf& orient);
+    // ThreeSpace orientation, in world coordinates, at its sample's host time. One
+    // newer than the newest Rift orientation is compared against that; one older
+    // than the history is dropped.
+    void        AddThreeSpaceOrientation(UInt64 ticks, const Quatf& orient);
+
+    // True once both sources have been seen.
+    bool        IsAligned() const               { return Aligned; }
+    // Fused orientation as of the newest Rift orientation; the Rift's own until
+    // aligned.
+    Quatf       GetOrientation() const;
+
+    // Angle in radians between ThreeSpace and the output at the last correction,
+    // before it was applied.
+    float       GetLastError() const            { return LastError; }
+    // Rift drift rate learned so far, world frame, radians/second.
+    Vector3f    GetDriftRate() const            { return DriftRate; }
+
+private:
+    struct HistoryEntry
+    {
+        UInt64  Ticks;
+        Quatf   Orientation;
+    };
+
+    // Rift orientation at 'ticks', interpolated; false if 'ticks' is after the newest
+    // or before the oldest entry.
+    bool        getRiftAt(UInt64 ticks, Quatf* orient) const;
+
+    float           TimeConstant;
+
+    HistoryEntry    History[HistorySize];
+    unsigned        HistoryCount;
+    unsigned        HistoryNext;
+
+    Quatf           Correction;
+    Vector3f        DriftRate;      // World frame, radians/second.
+    bool            Aligned;
+    UInt64          LastCorrectionTicks;
+    float           LastError;
+};
+
+#endif
@@ -0,0 +1,166 @@
+/************************************************************************************
+
+Filename    :   OculusRoomTiny_InputJournal.cpp
+Content     :   Timestamped input events and their on-disk journal
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "OculusRoomTiny_InputJournal.h"
+#include "../../LibOVR/Src/Kernel/OVR_Log.h"
+
+#include <string.h>
+
+static const char JournalMagic[4] = { 'R', 'I', 'J', 'N' };
+
+//-------------------------------------------------------------------------------------
+// ***** RoomInputEvent
+
+static RoomInputEvent makeEvent(UInt64 ticks, RoomInputEventType type)
+{
+    RoomInputEvent event;
+    memset(&event, 0, sizeof(event));
+    event.Ticks = ticks;
+    event.Type  = UByte(type);
+    return event;
+}
+
+RoomInputEvent RoomInputEvent::Key(UInt64 ticks, unsigned key, bool down)
+{
+    RoomInputEvent event = makeEvent(ticks, InputEvent_Key);
+    event.KeyCode = key;
+    event.Down    = down ? 1 : 0;
+    return event;
+}
+
+RoomInputEvent RoomInputEvent::MouseMove(UInt64 ticks, int dx, int dy)
+{
+    RoomInputEvent event = makeEvent(ticks, InputEvent_MouseMove);
+    event.X = dx;
+    event.Y = dy;
+    return event;
+}
+
+RoomInputEvent RoomInputEvent::Gamepad(UInt64 ticks, float lx, float ly, float rx, float ry)
+{
+    RoomInputEvent event = makeEvent(ticks, InputEvent_Gamepad);
+    event.Axes[0] = lx;
+    event.Axes[1] = ly;
+    event.Axes[2] = rx;
+    event.Axes[3] = ry;
+    return event;
+}
+
+RoomInputEvent RoomInputEvent::Sensor(UInt64 ticks, bool hasSensor, float yaw)
+{
+    RoomInputEvent event = makeEvent(ticks, InputEvent_Sensor);
+    event.Down    = hasSensor ? 1 : 0;
+    event.Axes[0] = yaw;
+    return event;
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** RoomInputJournal
+
+RoomInputJournal::RoomInputJournal()
+    : pFile(0), EventCount(0)
+{
+}
+
+RoomInputJournal::~RoomInputJournal()
+{
+    Close();
+}
+
+bool RoomInputJournal::Open(const char* path, UInt32 stepMks)
+{
+    Close();
+
+    pFile = fopen(path, "wb");
+    if (!pFile)
+    {
+        LogText("Input: Failed to open journal %s\n", path);
+        return false;
+    }
+    setvbuf(pFile, 0, _IOFBF, 64 * 1024);
+
+    RoomInputJournalHeader header;
+    memcpy(header.Magic, JournalMagic, sizeof(JournalMagic));
+    header.Version    = RoomInputJournal_Version;
+    header.RecordSize = sizeof(RoomInputEvent);
+    header.StepMks    = stepMks;
+    fwrite(&header, sizeof(header), 1, pFile);
+
+    EventCount = 0;
+    return true;
+}
+
+void RoomInputJournal::Close()
+{
+    if (pFile)
+    {
+        fclose(pFile);
+        pFile = 0;
+    }
+}
+
+void RoomInputJournal::Write(const RoomInputEvent& event)
+{
+    if (pFile && fwrite(&event, sizeof(event), 1, pFile) == 1)
+        EventCount++;
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** RoomInputReplay
+
+bool RoomInputReplay::Open(const char* path)
+{
+    Events.Clear();
+
+    FILE* file = fopen(path, "rb");
+    if (!file)
+    {
+        LogText("Input: Can't open journal %s\n", path);
+        return false;
+    }
+
+    RoomInputJournalHeader header;
+    bool valid = fread(&header, sizeof(header), 1, file) == 1 &&
+                 memcmp(header.Magic, JournalMagic, sizeof(JournalMagic)) == 0 &&
+                 header.Version == RoomInputJournal_Version &&
+                 header.RecordSize == sizeof(RoomInputEvent) && header.StepMks != 0;
+    if (!valid)
+    {
+        LogText("Input: %s is not a compatible input journal\n", path);
+        fclose(file);
+        return false;
+    }
+    StepMks = header.StepMks;
+
+    // A session cut short by a crash just ends at its last whole event.
+    RoomInputEvent event;
+    while (fread(&event, sizeof(event), 1, file) == 1)
+        Events.PushBack(event);
+
+    fclose(file);
+    return true;
+}
+
+UInt64 RoomInputReplay::GetLastStep() const
+{
+    return Events.GetSize() ? Events.Back().Step : 0;
+}
@@ -0,0 +1,142 @@
+/************************************************************************************
+
+Filename    :   OculusRoomTiny_InputJournal.h
+Content     :   Timestamped input events and their on-disk journal
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+#ifndef INC_OculusRoomTiny_InputJournal_h
+#define INC_OculusRoomTiny_InputJournal_h
+
+#include <stdio.h>
+
+#include "../../LibOVR/Src/Kernel/OVR_Types.h"
+#include "../../LibOVR/Src/Kernel/OVR_Array.h"
+
+using namespace OVR;
+
+//-------------------------------------------------------------------------------------
+// ***** RoomInputEvent
+
+// Every input that moves the camera, as an event: keys, mouse, gamepad, and the head
+// sensor's heading (which steers movement). Sources queue them on RoomSimulation,
+// which applies each at a simulation step; the journal records that step, so a
+// replay applies it at the same one.
+
+enum RoomInputEventType
+{
+    InputEvent_Key,         // KeyCode, Down.
+    InputEvent_MouseMove,   // X, Y: relative motion.
+    InputEvent_Gamepad,     // Axes: left x, left y, right x, right y, -1..1.
+    InputEvent_Sensor       // Down: a head sensor is present; Axes[0]: its heading yaw.
+};
+
+// Key codes are Windows virtual-key codes; letters are their upper-case ASCII.
+enum RoomKeyCode
+{
+    RoomKey_Shift = 0x10,
+    RoomKey_Up    = 0x26,
+    RoomKey_Down  = 0x28
+};
+
+#pragma pack(push,1)
+struct RoomInputEvent
+{
+    UInt64      Step;       // Simulation step it was applied at; set by RoomSimulation.
+    UInt64      Ticks;      // Timer::GetTicks() when it arrived.
+    UByte       Type;       // RoomInputEventType.
+    UByte       Down;
+    UInt16      Reserved;
+    UInt32      KeyCode;
+    SInt32      X, Y;
+    float       Axes[4];
+
+    static RoomInputEvent Key(UInt64 ticks, unsigned key, bool down);
+    static RoomInputEvent MouseMove(UInt64 ticks, int dx, int dy);
+    static RoomInputEvent Gamepad(UInt64 ticks, float lx, float ly, float rx, float ry);
+    static RoomInputEvent Sensor(UInt64 ticks, bool hasSensor, float yaw);
+};
+#pragma pack(pop)
+
+
+//-------------------------------------------------------------------------------------
+// ***** Journal file format
+
+// A fixed header followed by one RoomInputEvent per applied event, in step order.
+// All fields are little-endian. A journal holds one session and is rewritten, not
+// appended to.
+
+#pragma pack(push,1)
+struct RoomInputJournalHeader
+{
+    char        Magic[4];   // "RIJN"
+    UInt16      Version;
+    UInt16      RecordSize; // sizeof(RoomInputEvent) when written.
+    UInt32      StepMks;    // RoomSimulation step the Step fields count.
+};
+#pragma pack(pop)
+
+enum { RoomInputJournal_Version = 1 };
+
+
+//-------------------------------------------------------------------------------------
+// ***** RoomInputJournal
+
+// Writes applied events. Write() is called from the simulation step, under its
+// lock, and only touches the stdio buffer.
+
+class RoomInputJournal
+{
+public:
+    RoomInputJournal();
+    ~RoomInputJournal();
+
+    bool        Open(const char* path, UInt32 stepMks);
+    void        Close();
+
+    void        Write(const RoomInputEvent& event);
+
+    UInt32      GetEventCount() const { return EventCount; }
+
+private:
+    FILE*       pFile;
+    UInt32      EventCount;
+};
+
+
+//-------------------------------------------------------------------------------------
+// ***** RoomInputReplay
+
+// A whole journal, loaded for RoomSimulation::SetReplay.
+
+class RoomInputReplay
+{
+public:
+    RoomInputReplay() : StepMks(0) { }
+
+    bool                    Open(const char* path);
+
+    UInt32                  GetStepMks() const      { return StepMks; }
+    UPInt                   GetEventCount() const   { return Events.GetSize(); }
+    const RoomInputEvent&   GetEvent(UPInt i) const { return Events[i]; }
+    // Step of the last event; 0 if there are none.
+    UInt64                  GetLastStep() const;
+
+private:
+    UInt32                  StepMks;
+    Array<RoomInputEvent>   Events;
+};
+
+#endif
@@ -0,0 +1,647 @@
+/************************************************************************************
+
+Filename    :   OculusRoomTiny_Pipeline.cpp
+Content     :   Platform-neutral sensor, movement and camera logic of OculusRoomTiny
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "OculusRoomTiny_Pipeline.h"
+#include "Util_EulerKernel.h"
+#include "Util_Trace.h"
+#include "../../LibOVR/Src/Kernel/OVR_Timer.h"
+#include "../../LibOVR/Src/Kernel/OVR_Log.h"
+
+//-------------------------------------------------------------------------------------
+// ***** RoomInput
+
+void RoomInput::ApplyKey(unsigned key, bool down)
+{
+    // Keys and arrows set different bits, so releasing one leaves the other's
+    // movement going.
+    switch(key)
+    {
+    case 'W':           MoveForward = down ? (MoveForward | 1) : (MoveForward & ~1); break;
+    case 'S':           MoveBack    = down ? (MoveBack    | 1) : (MoveBack    & ~1); break;
+    case 'A':           MoveLeft    = down ? (MoveLeft    | 1) : (MoveLeft    & ~1); break;
+    case 'D':           MoveRight   = down ? (MoveRight   | 1) : (MoveRight   & ~1); break;
+    case RoomKey_Up:    MoveForward = down ? (MoveForward | 2) : (MoveForward & ~2); break;
+    case RoomKey_Down:  MoveBack    = down ? (MoveBack    | 2) : (MoveBack    & ~2); break;
+    case RoomKey_Shift: ShiftDown   = down; break;
+    }
+}
+
+void RoomInput::ApplyGamepad(float lx, float ly, float rx, float ry)
+{
+    GamepadMove   = Vector3f(lx * lx * (lx > 0 ? 1 : -1),
+                             0,
+                             ly * ly * (ly > 0 ? -1 : 1));
+    GamepadRotate = Vector3f(2 * rx, -2 * ry, 0);
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** RoomMotion
+
+void RoomMotion::ApplyMouseMove(int dx, int dy, bool hasSensor)
+{
+    const float maxPitch = ((3.1415f/2)*0.98f);
+
+    // Apply to rotation. Subtract for right body frame rotation,
+    // since yaw rotation is positive CCW when looking down on XZ plane.
+    Yaw   -= (Sensitivity * dx)/ 360.0f;
+
+    if (!hasSensor)
+    {
+        Pitch -= (Sensitivity * dy)/ 360.0f;
+        
+        if (Pitch > maxPitch)
+            Pitch = maxPitch;
+        if (Pitch < -maxPitch)
+            Pitch = -maxPitch;
+    }    
+}
+
+void RoomMotion::Move(const RoomInput& input, float sensorYaw, float dt, bool hasSensor)
+{
+    // Gamepad rotation.
+    Yaw -= input.GamepadRotate.x * dt;
+
+    if (!hasSensor)
+    {
+        // Allow gamepad to look up/down, but only if there is no head sensor.
+        Pitch -= input.GamepadRotate.y * dt;
+
+        const float maxPitch = ((3.1415f/2)*0.98f);
+        if (Pitch > maxPitch)
+            Pitch = maxPitch;
+        if (Pitch < -maxPitch)
+            Pitch = -maxPitch;
+    }
+    
+    // Handle keyboard movement.
+    // This translates EyePos based on Yaw vector direction and keys pressed.
+    // Note that Pitch and Roll do not affect movement (they only affect view).
+    if (input.MoveForward || input.MoveBack || input.MoveLeft || input.MoveRight)
+    {
+        Vector3f localMoveVector(0,0,0);
+        Matrix4f yawRotate = Matrix4f::RotationY(Yaw + sensorYaw);
+
+        if (input.MoveForward)
+            localMoveVector = ForwardVector;
+        else if (input.MoveBack)
+            localMoveVector = -ForwardVector;
+
+        if (input.MoveRight)
+            localMoveVector += RightVector;
+        else if (input.MoveLeft)
+            localMoveVector -= RightVector;
+
+        // Normalize vector so we don't move faster diagonally.
+        localMoveVector.Normalize();
+        Vector3f orientationVector = yawRotate.Transform(localMoveVector);
+        orientationVector *= MoveSpeed * dt * (input.ShiftDown ? 3.0f : 1.0f);
+
+        EyePos += orientationVector;
+    }
+
+    else if (input.GamepadMove.LengthSq() > 0)
+    {
+        Matrix4f yawRotate = Matrix4f::RotationY(Yaw + sensorYaw);
+        Vector3f orientationVector = yawRotate.Transform(input.GamepadMove);
+        orientationVector *= MoveSpeed * dt;
+        EyePos += orientationVector;
+    }
+}
+
+RoomMotion RoomMotion::Lerp(const RoomMotion& a, const RoomMotion& b, float t)
+{
+    RoomMotion m;
+    m.EyePos = a.EyePos + (b.EyePos - a.EyePos) * t;
+    m.Yaw    = a.Yaw   + (b.Yaw   - a.Yaw)   * t;
+    m.Pitch  = a.Pitch + (b.Pitch - a.Pitch) * t;
+    return m;
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** RoomSimulation
+
+RoomSimulation::RoomSimulation(UInt32 stepMks)
+    : StepMks(stepMks ? stepMks : (UInt32)DefaultStepMks),
+      pJournal(0), pReplay(0), ReplayNext(0),
+      QueuedHasSensor(false), QueuedSensorYaw(0),
+      HasSensor(false), SensorYaw(0),
+      CurrentTicks(0), StepCount(0), Started(false)
+{
+}
+
+RoomSimulation::~RoomSimulation()
+{
+    Stop();
+}
+
+void RoomSimulation::PushEvent(const RoomInputEvent& event)
+{
+    Mutex::Locker lock(&SimLock);
+    if (!pReplay)
+        Pending.PushBack(event);
+}
+
+void RoomSimulation::SetSensor(UInt64 ticks, bool hasSensor, float sensorYaw)
+{
+    Mutex::Locker lock(&SimLock);
+    if (pReplay || (hasSensor == QueuedHasSensor && sensorYaw == QueuedSensorYaw))
+        return;
+    QueuedHasSensor = hasSensor;
+    QueuedSensorYaw = sensorYaw;
+    Pending.PushBack(RoomInputEvent::Sensor(ticks, hasSensor, sensorYaw));
+}
+
+void RoomSimulation::SetJournal(RoomInputJournal* journal)
+{
+    Mutex::Locker journalLock(&JournalLock);
+    Mutex::Locker lock(&SimLock);
+    pJournal = journal;
+}
+
+void RoomSimulation::SetReplay(const RoomInputReplay* replay)
+{
+    Mutex::Locker lock(&SimLock);
+    pReplay    = replay;
+    ReplayNext = 0;
+    Pending.Clear();
+
+    if (replay && replay->GetStepMks() != StepMks)
+        LogText("Input: Journal was recorded at %u mks steps, not %u; replay will drift\n",
+                replay->GetStepMks(), StepMks);
+}
+
+void RoomSimulation::applyEvent(const RoomInputEvent& event)
+{
+    switch(event.Type)
+    {
+    case InputEvent_Key:
+        Input.ApplyKey(event.KeyCode, event.Down != 0);
+        break;
+    case InputEvent_MouseMove:
+        Current.ApplyMouseMove(event.X, event.Y, HasSensor);
+        break;
+    case InputEvent_Gamepad:
+        Input.ApplyGamepad(event.Axes[0], event.Axes[1], event.Axes[2], event.Axes[3]);
+        break;
+    case InputEvent_Sensor:
+        HasSensor = (event.Down != 0);
+        SensorYaw = event.Axes[0];
+        break;
+    }
+
+    if (pJournal)
+    {
+        RoomInputEvent applied = event;
+        applied.Step = StepCount;
+        Applied.PushBack(applied);
+    }
+}
+
+void RoomSimulation::Advance(UInt64 ticks)
+{
+    // Applied events are journaled after SimLock is released, so a slow write
+    // holds up other Advance() callers but never PushEvent() or GetMotion().
+    Mutex::Locker journalLock(&JournalLock);
+    if (advanceSteps(ticks))
+    {
+        for (UPInt i = 0; i < Applied.GetSize(); i++)
+            pJournal->Write(Applied[i]);
+        Applied.Clear();
+    }
+}
+
+// Returns whether there are Applied events to journal.
+bool RoomSimulation::advanceSteps(UInt64 ticks)
+{
+    Mutex::Locker lock(&SimLock);
+
+    if (!Started)
+    {
+        Started      = true;
+        CurrentTicks = ticks;
+        Previous     = Current;
+        return false;
+    }
+
+    if (ticks > CurrentTicks + MaxCatchUpMks)
+        CurrentTicks = ticks - MaxCatchUpMks;
+
+    const float dt = StepMks * (1.0f / Timer::MksPerSecond);
+    while (CurrentTicks + StepMks <= ticks)
+    {
+        Previous = Current;
+
+        if (pReplay)
+        {
+            while (ReplayNext < pReplay->GetEventCount() &&
+                   pReplay->GetEvent(ReplayNext).Step <= StepCount)
+                applyEvent(pReplay->GetEvent(ReplayNext++));
+        }
+        else
+        {
+            // In queue order; an event not yet due holds back those queued after it.
+            UPInt applied = 0;
+            while (applied < Pending.GetSize() &&
+                   Pending[applied].Ticks <= CurrentTicks + StepMks)
+                applyEvent(Pending[applied++]);
+            if (applied == Pending.GetSize())
+                Pending.Clear();
+            else if (applied)
+                Pending.RemoveMultipleAt(0, applied);
+        }
+
+        Current.Move(Input, SensorYaw, dt, HasSensor);
+        CurrentTicks += StepMks;
+        StepCount++;
+    }
+    return pJournal && Applied.GetSize();
+}
+
+RoomMotion RoomSimulation::GetMotion(UInt64 ticks) const
+{
+    Mutex::Locker lock(&SimLock);
+
+    // Previous..Current covers CurrentTicks - StepMks..CurrentTicks; shifted by a
+    // step, ticks is CurrentTicks..CurrentTicks + StepMks.
+    float t = (ticks > CurrentTicks) ? float(ticks - CurrentTicks) / StepMks : 0.0f;
+    return RoomMotion::Lerp(Previous, Current, (t < 1.0f) ? t : 1.0f);
+}
+
+UInt64 RoomSimulation::GetStepCount() const
+{
+    Mutex::Locker lock(&SimLock);
+    return StepCount;
+}
+
+bool RoomSimulation::Start()
+{
+    if (pThread)
+        return true;
+    pThread = *new Thread(&threadFn, this);
+    return pThread->Start();
+}
+
+void RoomSimulation::Stop()
+{
+    if (!pThread)
+        return;
+    pThread->SetExitFlag(true);
+    while (!pThread->IsFinished())
+        Thread::MSleep(1);
+    pThread.Clear();
+}
+
+int RoomSimulation::threadFn(Thread* thread, void* simulationPtr)
+{
+    RoomSimulation* simulation = (RoomSimulation*)simulationPtr;
+    Trace::SetThreadName("Room Simulation");
+
+    while (!thread->GetExitFlag())
+    {
+        simulation->Advance(Timer::GetTicks());
+        // Steps are on a fixed grid, so waking late only means more steps at once.
+        // Sleeps can be a whole scheduler tick (15.6 ms on Windows by default), so
+        // readers Advance() to their own time before GetMotion() as well.
+        Thread::MSleep(1);
+    }
+    return 0;
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** RoomCamera
+
+RoomCamera::RoomCamera()
+    : EyePos(EyePosInitial),
+      EyeYaw(YawInitial), EyePitch(0), EyeRoll(0),
+      LastSensorYaw(0),
+      ViewPath(ViewPath_Quaternion),
+      HaveSensorOrient(false)
+{
+}
+
+void RoomCamera::BeginFrame()
+{
+    HaveSensorOrient = false;
+}
+
+// Heading of an orientation: the yaw of its forward vector projected onto
+// the XZ plane, with the same sign convention as EyeYaw.
+float RoomCamera::getHeadingYaw(const Quatf& orient)
+{
+    Vector3f forward = orient.Rotate(ForwardVector);
+    return atan2(-forward.x, -forward.z);
+}
+
+void RoomCamera::applySensorYaw(float yaw)
+{
+    //we are allowing combination of gamepad yaw and headtracker yaw therefore
+    EyeYaw += (yaw - LastSensorYaw);
+    LastSensorYaw = yaw;
+}
+
+// We extract Yaw, Pitch, Roll instead of directly using the orientation
+// to allow "additional" yaw manipulation with mouse/controller.
+// The quaternion path keeps the orientation and only extracts the heading.
+void RoomCamera::ApplyRiftOrientation(const Quatf& hmdOrient)
+{
+    float yaw = 0.0f;
+
+    if (ViewPath == ViewPath_Quaternion)
+    {
+        SensorOrient     = hmdOrient;
+        HaveSensorOrient = true;
+        yaw = getHeadingYaw(SensorOrient);
+    }
+    else
+        hmdOrient.GetEulerAngles<Axis_Y, Axis_X, Axis_Z>(&yaw, &EyePitch, &EyeRoll);
+
+    applySensorYaw(yaw);
+}
+
+Quatf RoomCamera::ThreeSpaceToWorld(const float quat[4])
+{
+    // The Euler decomposition in ApplyThreeSpaceOrientation maps sensor Z/Y/X
+    // rotations onto world yaw/pitch/roll (Y/X/Z); permuting the axes does the same
+    // to the quaternion itself.
+    return Quatf(quat[1], quat[2], quat[0], quat[3]);
+}
+
+void RoomCamera::ApplyFusedOrientation(const Quatf& orient)
+{
+    // Same conventions as the Rift's.
+    ApplyRiftOrientation(orient);
+}
+
+void RoomCamera::ApplyThreeSpaceOrientation(const float quat[4])
+{
+    float yaw = 0.0f;
+
+    if (ViewPath == ViewPath_Quaternion)
+    {
+        SensorOrient     = ThreeSpaceToWorld(quat);
+        HaveSensorOrient = true;
+        yaw = getHeadingYaw(SensorOrient);
+    }
+    else
+    {
+        // Same conversion (and gimbal-lock handling) as offline processing uses.
+        QuatToEuler(quat, &yaw, &EyePitch, &EyeRoll);
+    }
+
+    applySensorYaw(yaw);
+}
+
+void RoomCamera::ApplyMotion(const RoomMotion& motion, bool hasSensor)
+{
+    EyePos = motion.EyePos;
+    EyeYaw = motion.Yaw + LastSensorYaw;
+    if (!hasSensor)
+        EyePitch = motion.Pitch;
+}
+
+void RoomCamera::UpdateView()
+{
+    // Minimal head modelling.
+    float headBaseToEyeHeight     = 0.15f;  // Vertical height of eye from base of head
+    float headBaseToEyeProtrusion = 0.09f;  // Distance forward of eye from base of head
+
+    Vector3f eyeCenterInHeadFrame(0.0f, headBaseToEyeHeight, -headBaseToEyeProtrusion);
+
+    if (HaveSensorOrient)
+    {
+        // Compose the user's additional yaw directly with the sensor orientation
+        // and build View from a single quaternion-to-matrix conversion.
+        Quatf    orient = Quatf(UpVector, EyeYaw - LastSensorYaw) * SensorOrient;
+
+        Vector3f shiftedEyePos = EyePos + orient.Rotate(eyeCenterInHeadFrame);
+        shiftedEyePos.y -= eyeCenterInHeadFrame.y; // Bring the head back down to original height
+
+        View = Matrix4f(orient.Inverted()) * Matrix4f::Translation(-shiftedEyePos);
+    }
+    else
+    {
+        // Rotate and position View Camera, using YawPitchRoll in BodyFrame coordinates.
+        // 
+        Matrix4f rollPitchYaw = Matrix4f::RotationY(EyeYaw) * Matrix4f::RotationX(EyePitch) *
+                                Matrix4f::RotationZ(EyeRoll);
+        Vector3f up      = rollPitchYaw.Transform(UpVector);
+        Vector3f forward = rollPitchYaw.Transform(ForwardVector);
+
+        Vector3f shiftedEyePos = EyePos + rollPitchYaw.Transform(eyeCenterInHeadFrame);
+        shiftedEyePos.y -= eyeCenterInHeadFrame.y; // Bring the head back down to original height
+
+        View = Matrix4f::LookAtRH(shiftedEyePos, shiftedEyePos + forward, up); 
+    }
+
+    // This is what transformation would be without head modeling.    
+    // View = Matrix4f::LookAtRH(EyePos, EyePos + forward, up);    
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** ThreeSpaceTracker
+
+void ThreeSpaceTracker::Stop()
+{
+    if (pReader)
+    {
+        pReader->Stop();
+        pReader.Clear();
+    }
+}
+
+void ThreeSpaceTracker::Update()
+{
+    //The reader thread does the serial I/O; here we only pick up the samples it
+    //read since last frame. The predictor sees all of them to estimate velocity.
+    ThreeSpaceSample sample;
+    while (pReader && pReader->PopSample(&sample))
+    {
+        LastSample = sample;
+        Predictor.AddSample(sample);
+
+        HistoryEntry& entry = History[HistoryNext];
+        entry.HostTicks     = sample.HostTicks;
+        entry.Orientation   = Predictor.GetOrientation();
+        HistoryNext         = (HistoryNext + 1) % HistorySize;
+        if (HistoryCount < HistorySize)
+            HistoryCount++;
+    }
+}
+
+bool ThreeSpaceTracker::Sample(UInt64 nowTicks, float quat[4])
+{
+    Update();
+
+    if (!Predictor.HasSample())
+        return false;
+
+    // Extrapolate to when this frame's photons will be shown.
+    Quatf orient = Predictor.GetPredictedOrientation(nowTicks);
+    quat[0] = orient.x;
+    quat[1] = orient.y;
+    quat[2] = orient.z;
+    quat[3] = orient.w;
+    return true;
+}
+
+bool ThreeSpaceTracker::GetOrientationAt(UInt64 hostTicks, Quatf* orient) const
+{
+    if (HistoryCount == 0)
+    {
+        // Fed directly through Predictor; only the newest orientation is known.
+        if (!Predictor.HasSample())
+            return false;
+        *orient = Predictor.GetOrientation();
+        return true;
+    }
+
+    // Walk back from the newest entry to the first one at or before hostTicks.
+    unsigned newer = HistoryNext;
+    for (unsigned i = 0; i < HistoryCount; i++)
+    {
+        unsigned            index = (HistoryNext + HistorySize - 1 - i) % HistorySize;
+        const HistoryEntry& entry = History[index];
+
+        if (entry.HostTicks > hostTicks && i + 1 < HistoryCount)
+        {
+            newer = index;
+            continue;
+        }
+        if (i == 0 || entry.HostTicks > hostTicks)
+        {
+            // After the newest or before the oldest sample.
+            *orient = entry.Orientation;
+            return true;
+        }
+
+        // Samples are at most a few ms apart, where normalized lerp is as good as slerp.
+        const HistoryEntry& next = History[newer];
+        float t   = float(hostTicks - entry.HostTicks) / float(next.HostTicks - entry.HostTicks);
+        Quatf b   = next.Orientation;
+        Quatf a   = entry.Orientation;
+        if (a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w < 0)
+            b = b * -1.0f;
+        *orient = (a * (1.0f - t) + b * t).Normalized();
+        return true;
+    }
+    return false;
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** ThreeSpaceSensorGroup
+
+ThreeSpaceSensorGroup::ThreeSpaceSensorGroup()
+    : SensorCount(0),
+      EnablePrediction(Trackers[0].Predictor.IsPredictionEnabled()),
+      PredictionInterval(Trackers[0].Predictor.GetPredictionInterval())
+{
+}
+
+int ThreeSpaceSensorGroup::AddSensor(ThreeSpaceReader* reader)
+{
+    if (SensorCount >= (unsigned)MaxSensors)
+        return -1;
+
+    ThreeSpaceTracker& tracker = Trackers[SensorCount];
+    tracker.SetReader(reader);
+    tracker.Predictor.SetPredictionEnabled(EnablePrediction);
+    tracker.Predictor.SetPredictionInterval(PredictionInterval);
+    return int(SensorCount++);
+}
+
+bool ThreeSpaceSensorGroup::HasReader() const
+{
+    for (unsigned i = 0; i < SensorCount; i++)
+        if (Trackers[i].HasReader())
+            return true;
+    return false;
+}
+
+void ThreeSpaceSensorGroup::Stop()
+{
+    for (unsigned i = 0; i < SensorCount; i++)
+        Trackers[i].Stop();
+}
+
+void ThreeSpaceSensorGroup::SetPredictionEnabled(bool enable)
+{
+    EnablePrediction = enable;
+    for (unsigned i = 0; i < SensorCount; i++)
+        Trackers[i].Predictor.SetPredictionEnabled(enable);
+}
+
+void ThreeSpaceSensorGroup::SetPredictionInterval(float seconds)
+{
+    PredictionInterval = seconds;
+    for (unsigned i = 0; i < SensorCount; i++)
+        Trackers[i].Predictor.SetPredictionInterval(seconds);
+}
+
+void ThreeSpaceSensorGroup::Sample(UInt64 nowTicks, ThreeSpaceSnapshot* snapshot)
+{
+    UInt64 oldest = 0, newest = 0;
+    bool   haveLive = false;
+
+    snapshot->SensorCount = SensorCount;
+
+    // Every reader has been filling its own ring in parallel; collect them all
+    // first, so the alignment sees each sensor's newest data.
+    for (unsigned i = 0; i < SensorCount; i++)
+    {
+        ThreeSpaceTracker& tracker = Trackers[i];
+        ThreeSpacePose&    pose    = snapshot->Poses[i];
+
+        tracker.Update();
+
+        pose.Valid = tracker.Predictor.HasSample();
+        if (!pose.Valid)
+            continue;
+
+        pose.Predicted       = tracker.Predictor.GetPredictedOrientation(nowTicks);
+        pose.AngularVelocity = tracker.Predictor.GetAngularVelocity();
+        pose.SampleTicks     = tracker.HasReader() ? tracker.GetLastSample().HostTicks : nowTicks;
+        pose.Stale           = (nowTicks > pose.SampleTicks + StaleMks);
+
+        if (!pose.Stale)
+        {
+            if (!haveLive || pose.SampleTicks < oldest)
+                oldest = pose.SampleTicks;
+            if (!haveLive || pose.SampleTicks > newest)
+                newest = pose.SampleTicks;
+            haveLive = true;
+        }
+    }
+
+    // The newest instant every live sensor has reached.
+    snapshot->AlignedTicks = haveLive ? oldest : nowTicks;
+    snapshot->SkewMks      = haveLive ? UInt32(newest - oldest) : 0;
+
+    for (unsigned i = 0; i < SensorCount; i++)
+    {
+        ThreeSpacePose& pose = snapshot->Poses[i];
+        if (pose.Valid)
+            Trackers[i].GetOrientationAt(snapshot->AlignedTicks, &pose.Orientation);
+    }
+}
@@ -0,0 +1,403 @@
+/************************************************************************************
+
+Filename    :   OculusRoomTiny_Pipeline.h
+Content     :   Platform-neutral sensor, movement and camera logic of OculusRoomTiny
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+#ifndef INC_OculusRoomTiny_Pipeline_h
+#define INC_OculusRoomTiny_Pipeline_h
+
+#include "../../LibOVR/Src/Kernel/OVR_Math.h"
+#include "../../LibOVR/Src/Kernel/OVR_Threads.h"
+#include "ThreeSpace_Reader.h"
+#include "ThreeSpace_Predictor.h"
+#include "OculusRoomTiny_InputJournal.h"
+#include "OculusRoomTiny_Fusion.h"
+
+using namespace OVR;
+
+//-------------------------------------------------------------------------------------
+// ***** Pipeline Description
+
+// Everything OnIdle does before rendering, with no dependency on Win32, D3D or
+// the Rift device code, so it can be built and profiled headless on Linux:
+//
+//  ThreeSpaceTracker - Drains the ThreeSpace reader and predicts orientation.
+//  ThreeSpaceSensorGroup - Several trackers (head, hands, torso...) sampled as one
+//                      time-aligned snapshot.
+//  RoomSimulation    - Integrates movement input into a RoomMotion at a fixed
+//                      step, on its own thread or driven by the caller.
+//  HeadFusion        - Fuses Rift and ThreeSpace orientation when both are present.
+//  RoomCamera        - Combines sensor orientation and the simulated motion into
+//                      EyePos/EyeYaw and the View matrix, including head modeling.
+//
+// Input handlers queue RoomInputEvents with Simulation.PushEvent() as input
+// arrives. Per frame, the caller does:
+//
+//  Camera.BeginFrame();
+//  Camera.ApplyRiftOrientation(...), Camera.ApplyThreeSpaceOrientation(...), or
+//  with both sensors Camera.ApplyFusedOrientation(Fusion.GetOrientation());
+//  Simulation.SetSensor(nowTicks, hasSensor, Camera.LastSensorYaw);
+//  Simulation.Advance(nowTicks);
+//  Camera.ApplyMotion(Simulation.GetMotion(nowTicks), hasSensor);
+//  Camera.UpdateView();
+
+// The world RHS coordinate system is defines as follows (as seen in perspective view):
+//  Y - Up
+//  Z - Back
+//  X - Right
+const Vector3f UpVector(0.0f, 1.0f, 0.0f);
+const Vector3f ForwardVector(0.0f, 0.0f, -1.0f);
+const Vector3f RightVector(1.0f, 0.0f, 0.0f);
+
+// We start out looking in the positive Z (180 degree rotation).
+const float    YawInitial  = 3.141592f;
+const Vector3f EyePosInitial(0.0f, 1.6f, -5.0f);
+const float    Sensitivity = 1.0f;
+const float    MoveSpeed   = 3.0f; // m/s
+
+
+//-------------------------------------------------------------------------------------
+// ***** RoomInput
+
+// Movement input state, as of the key and gamepad events applied so far.
+
+struct RoomInput
+{
+    // Movement state; different bits may be set based on the state of keys.
+    UByte       MoveForward;
+    UByte       MoveBack;
+    UByte       MoveLeft;
+    UByte       MoveRight;
+    Vector3f    GamepadMove, GamepadRotate;
+
+    // Shift accelerates movement/adjustment velocity.
+    bool        ShiftDown;
+
+    RoomInput()
+        : MoveForward(0), MoveBack(0), MoveLeft(0), MoveRight(0),
+          GamepadMove(0), GamepadRotate(0), ShiftDown(false)
+    { }
+
+    // A key going down or up; keys that do not move the camera are ignored.
+    void        ApplyKey(unsigned key, bool down);
+    // Stick positions, -1..1, shaped for finer control near the center.
+    void        ApplyGamepad(float lx, float ly, float rx, float ry);
+};
+
+
+//-------------------------------------------------------------------------------------
+// ***** RoomMotion
+
+// The part of the camera that input moves: position, and the yaw and pitch the
+// user adds on top of any head sensor's orientation.
+
+struct RoomMotion
+{
+    Vector3f    EyePos;
+    float       Yaw;        // Gamepad and mouse yaw; RoomCamera adds the sensor's heading.
+    float       Pitch;      // Gamepad and mouse pitch; only used without a head sensor.
+
+    RoomMotion() : EyePos(EyePosInitial), Yaw(YawInitial), Pitch(0) { }
+
+    // Gamepad rotation and keyboard/gamepad movement over dt seconds. Movement is
+    // along the view heading, Yaw plus the head sensor's sensorYaw.
+    void        Move(const RoomInput& input, float sensorYaw, float dt, bool hasSensor);
+    // Relative mouse motion. Mouse pitch only applies without a head sensor.
+    void        ApplyMouseMove(int dx, int dy, bool hasSensor);
+
+    static RoomMotion Lerp(const RoomMotion& a, const RoomMotion& b, float t);
+};
+
+
+//-------------------------------------------------------------------------------------
+// ***** RoomSimulation
+
+// Integrates RoomMotion in fixed steps (1 ms by default) on a fixed time grid, so
+// movement does not depend on when or how often frames render: a hitch no longer
+// turns into one long step, and the same input over the same time gives the same
+// position. Frames read the motion interpolated between the two steps around the
+// render time, one step behind the newest.
+//
+// Start() runs the steps on their own thread against Timer::GetTicks(), so input
+// keeps being applied between frames; frames still Advance() to their own time,
+// as the thread's sleeps are only as fine as the scheduler's tick. Without it the
+// caller drives Advance() alone, e.g. on a simulated clock for reproducible runs.
+//
+// All input arrives as RoomInputEvents, which may be pushed from any thread; each
+// step first applies the queued events that arrived by its time. With a journal
+// set, every applied event is written along with its step. With a replay set,
+// live events are dropped and the replay's events are applied at the steps they
+// were recorded at instead, which reproduces the recorded motion exactly as long
+// as the step size matches.
+
+class RoomSimulation
+{
+public:
+    enum
+    {
+        DefaultStepMks  = 1000,
+        // After a longer stall (a debugger break, say), time skips ahead instead of
+        // simulating all of it at once.
+        MaxCatchUpMks   = 250000
+    };
+
+    RoomSimulation(UInt32 stepMks = DefaultStepMks);
+    ~RoomSimulation();
+
+    // Queues an event for the first step at or after its Ticks.
+    void        PushEvent(const RoomInputEvent& event);
+    // Whether a head sensor drives pitch, and its current heading
+    // (RoomCamera::LastSensorYaw). Queues a sensor event if either changed.
+    void        SetSensor(UInt64 ticks, bool hasSensor, float sensorYaw);
+
+    // Both must outlive the simulation, or be reset to null first.
+    void        SetJournal(RoomInputJournal* journal);
+    void        SetReplay(const RoomInputReplay* replay);
+
+    // Runs every step whose time is at or before 'ticks'. The first call sets the
+    // time of the first step. Safe to call from several threads; steps already run
+    // are not run again.
+    void        Advance(UInt64 ticks);
+    // Motion at 'ticks' minus one step, interpolated. Only as recent as the last
+    // Advance(), so Advance() to 'ticks' first.
+    RoomMotion  GetMotion(UInt64 ticks) const;
+
+    UInt32      GetStepMks() const      { return StepMks; }
+    UInt64      GetStepCount() const;
+
+    // Steps in real time on a thread of its own until Stop().
+    bool        Start();
+    void        Stop();
+
+private:
+    static int  threadFn(Thread* thread, void* simulation);
+    bool        advanceSteps(UInt64 ticks);
+    void        applyEvent(const RoomInputEvent& event);
+
+    UInt32              StepMks;
+
+    // Taken before SimLock when both are; held while journaling.
+    Mutex               JournalLock;
+    mutable Mutex       SimLock;
+    Array<RoomInputEvent> Pending;
+    RoomInputJournal*   pJournal;
+    // Applied this Advance(), to journal once SimLock is released.
+    Array<RoomInputEvent> Applied;
+    const RoomInputReplay* pReplay;
+    UPInt               ReplayNext;
+    // Last sensor state queued, so unchanged headings are not queued every frame.
+    bool                QueuedHasSensor;
+    float               QueuedSensorYaw;
+
+    RoomInput           Input;
+    bool                HasSensor;
+    float               SensorYaw;
+
+    // Previous is one step before Current, at CurrentTicks.
+    RoomMotion          Previous, Current;
+    UInt64              CurrentTicks;
+    UInt64              StepCount;
+    bool                Started;
+
+    Ptr<Thread>         pThread;
+};
+
+
+//-------------------------------------------------------------------------------------
+// ***** RoomCamera
+
+class RoomCamera
+{
+public:
+    // How sensor orientation is turned into View.
+    //  ViewPath_Euler      - Decompose into EyeYaw/EyePitch/EyeRoll and rebuild
+    //                        the rotation from three matrices and LookAtRH.
+    //  ViewPath_Quaternion - Compose the user yaw offset with the sensor quaternion
+    //                        and convert once; no gimbal-lock precision loss.
+    enum ViewPathType
+    {
+        ViewPath_Euler,
+        ViewPath_Quaternion
+    };
+
+    RoomCamera();
+
+    // Forgets last frame's sensor orientation.
+    void        BeginFrame();
+
+    // Sensor orientations for this frame. Rift orientation is in world coordinates,
+    // ThreeSpace orientation is the sensor's quaternion (x, y, z, w) as streamed.
+    void        ApplyRiftOrientation(const Quatf& hmdOrient);
+    void        ApplyThreeSpaceOrientation(const float quat[4]);
+    // Both at once, as fused by HeadFusion; in world coordinates like the Rift's.
+    void        ApplyFusedOrientation(const Quatf& orient);
+
+    // ThreeSpace quaternion (x, y, z, w) in world coordinates.
+    static Quatf ThreeSpaceToWorld(const float quat[4]);
+
+    // Position and input yaw/pitch from RoomSimulation; call after the sensor
+    // orientations, since EyeYaw adds the sensor heading to motion.Yaw.
+    void        ApplyMotion(const RoomMotion& motion, bool hasSensor);
+
+    // Computes View from the current orientation and position.
+    void        UpdateView();
+
+    // Position and look. The following apply:
+    Vector3f        EyePos;
+    float           EyeYaw;         // Rotation around Y, CCW positive when looking at RHS (X,Z) plane.
+    float           EyePitch;       // Pitch. If sensor is plugged in, only read from sensor.
+    float           EyeRoll;        // Roll, only accessible from Sensor.
+    float           LastSensorYaw;  // Stores previous Yaw value from to support computing delta.
+
+    ViewPathType    ViewPath;
+    Matrix4f        View;
+
+private:
+    void            applySensorYaw(float yaw);
+    static float    getHeadingYaw(const Quatf& orient);
+
+    // Sensor orientation in world coordinates, used by ViewPath_Quaternion.
+    Quatf           SensorOrient;
+    bool            HaveSensorOrient;
+};
+
+
+//-------------------------------------------------------------------------------------
+// ***** ThreeSpaceTracker
+
+// Render-thread side of the ThreeSpace sensor: consumes everything the reader
+// thread published since last frame and returns the predicted orientation.
+
+class ThreeSpaceTracker
+{
+public:
+    ThreeSpaceTracker() : HistoryCount(0), HistoryNext(0) { }
+
+    // Takes over a started reader.
+    void        SetReader(ThreeSpaceReader* reader) { pReader = reader; }
+    bool        HasReader() const                   { return pReader.GetPtr() != 0; }
+    // Stops and releases the reader thread.
+    void        Stop();
+
+    // Drains new samples into the predictor and writes the orientation predicted for
+    // nowTicks (Timer::GetTicks()). Returns false until the first sample arrives.
+    bool        Sample(UInt64 nowTicks, float quat[4]);
+
+    // Just the draining part of Sample().
+    void        Update();
+
+    // Sensor orientation at hostTicks, interpolated between the recent samples
+    // around it and clamped to the oldest and newest. False before the first sample.
+    bool        GetOrientationAt(UInt64 hostTicks, Quatf* orient) const;
+
+    const ThreeSpaceSample& GetLastSample() const   { return LastSample; }
+    ThreeSpaceReader*       GetReader() const       { return pReader; }
+
+    ThreeSpacePredictor     Predictor;
+
+private:
+    // ~30 ms at the sensor's 1 kHz maximum; enough to align against a sensor one
+    // frame behind.
+    enum { HistorySize = 32 };
+
+    struct HistoryEntry
+    {
+        UInt64  HostTicks;
+        Quatf   Orientation;
+    };
+
+    Ptr<ThreeSpaceReader>   pReader;
+    ThreeSpaceSample        LastSample;
+    HistoryEntry            History[HistorySize];
+    unsigned                HistoryCount;
+    unsigned                HistoryNext;
+};
+
+
+//-------------------------------------------------------------------------------------
+// ***** ThreeSpaceSensorGroup
+
+// One sensor's entry in a ThreeSpaceSnapshot. Orientations are in the sensor's frame,
+// as streamed.
+struct ThreeSpacePose
+{
+    Quatf       Orientation;        // At the snapshot's AlignedTicks.
+    Quatf       Predicted;          // At photon time, as ThreeSpaceTracker::Sample.
+    Vector3f    AngularVelocity;    // Body frame, radians/second.
+    UInt64      SampleTicks;        // HostTicks of the newest sample.
+    bool        Valid;              // Has had a sample.
+    bool        Stale;              // Newest sample too old to align to; not aligned.
+
+    ThreeSpacePose() : SampleTicks(0), Valid(false), Stale(false) { }
+};
+
+struct ThreeSpaceSnapshot
+{
+    enum { MaxSensors = 8 };
+
+    UInt64          AlignedTicks;   // Host time every live Orientation refers to.
+    UInt32          SkewMks;        // Spread of the live sensors' newest sample times.
+    unsigned        SensorCount;
+    ThreeSpacePose  Poses[MaxSensors];
+
+    ThreeSpaceSnapshot() : AlignedTicks(0), SkewMks(0), SensorCount(0) { }
+};
+
+// Several ThreeSpace sensors, each with its own reader thread and ring, so ingest
+// scales with the number of sensors instead of being serialized on the render
+// thread. Once per frame Sample() drains all of them and builds a snapshot in which
+// every pose is for the same instant: the newest time all live sensors have data
+// for, so no sensor is extrapolated to match another.
+//
+// Sensor 0 is the head.
+
+class ThreeSpaceSensorGroup
+{
+public:
+    enum { MaxSensors = ThreeSpaceSnapshot::MaxSensors };
+
+    ThreeSpaceSensorGroup();
+
+    // Takes over a started reader; returns the sensor index, or -1 if the group is
+    // full. A null reader adds a sensor whose Predictor the caller feeds directly.
+    int                 AddSensor(ThreeSpaceReader* reader);
+    unsigned            GetSensorCount() const              { return SensorCount; }
+    ThreeSpaceTracker&  GetTracker(unsigned index)          { return Trackers[index]; }
+    bool                HasReader() const;
+    // Stops and releases every reader thread.
+    void                Stop();
+
+    // Applied to every sensor's predictor, including ones added later.
+    void                SetPredictionEnabled(bool enable);
+    bool                IsPredictionEnabled() const         { return EnablePrediction; }
+    void                SetPredictionInterval(float seconds);
+    float               GetPredictionInterval() const       { return PredictionInterval; }
+
+    // Drains every sensor and fills 'snapshot' for nowTicks (Timer::GetTicks()).
+    void                Sample(UInt64 nowTicks, ThreeSpaceSnapshot* snapshot);
+
+private:
+    // A sensor whose newest sample is older than this does not hold the others back.
+    enum { StaleMks = 100000 };
+
+    ThreeSpaceTracker   Trackers[MaxSensors];
+    unsigned            SensorCount;
+    bool                EnablePrediction;
+    float               PredictionInterval;
+};
+
+#endif
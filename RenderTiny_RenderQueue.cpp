@@ -0,0 +1,185 @@
+/************************************************************************************
+
+Filename    :   RenderTiny_RenderQueue.cpp
+Content     :   Sorted draw list, built once per frame and replayed per eye
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "RenderTiny_RenderQueue.h"
+#include "../../LibOVR/Src/Kernel/OVR_Alg.h"
+
+#include <string.h>
+
+namespace OVR { namespace RenderTiny {
+
+// Key fields, most significant first.
+enum
+{
+    KeyShaderShift  = 48,
+    KeyFillShift    = 32,
+    KeyMeshShift    = 16,
+    KeyIdMask       = 0xFFFF
+};
+
+RenderQueue::RenderQueue()
+    : Count(0)
+{
+}
+
+void RenderQueue::Clear()
+{
+    Count      = 0;
+    QueueStats = Stats();
+}
+
+void RenderQueue::Add(Model* model, const Matrix4f& world, unsigned shaderId, unsigned fillId,
+                      unsigned meshId, float depth)
+{
+    // Non-negative floats order the same as their bits, and the top 16 keep
+    // about two significant digits; anything behind the camera, or NaN, sorts
+    // first.
+    UInt32 depthBits = 0;
+    if (depth > 0.0f)
+        memcpy(&depthBits, &depth, sizeof(depthBits));
+
+    if (Count == Items.GetSize())
+    {
+        Items.PushBack(Item());
+        Entries.PushBack(SortEntry());
+    }
+    Items[Count].pModel = model;
+    Items[Count].World  = world;
+    Items[Count].MeshId = meshId;
+    Entries[Count].Key  = (UInt64(shaderId & KeyIdMask) << KeyShaderShift) |
+                          (UInt64(fillId & KeyIdMask) << KeyFillShift) |
+                          (UInt64(meshId & KeyIdMask) << KeyMeshShift) | (depthBits >> 16);
+    Entries[Count].Item = UInt32(Count);
+    Count++;
+}
+
+// Adjacent entries whose key field at 'shift' differs, counting the first.
+UInt32 RenderQueue::countChanges(const SortEntry* entries, UPInt count, int shift)
+{
+    UInt32 changes = count ? 1 : 0;
+    for (UPInt i = 1; i < count; i++)
+        if (((entries[i].Key ^ entries[i - 1].Key) >> shift) & KeyIdMask)
+            changes++;
+    return changes;
+}
+
+void RenderQueue::Sort()
+{
+    UPInt count = Count;
+    QueueStats  = Stats();
+    QueueStats.Items = UInt32(count);
+    if (!count)
+        return;
+
+    QueueStats.UnsortedShaderChanges = countChanges(&Entries[0], count, KeyShaderShift);
+    QueueStats.UnsortedFillChanges   = countChanges(&Entries[0], count, KeyFillShift);
+
+    // LSD radix sort, a byte per pass, stable so equal keys keep the order they
+    // were added in. A byte every key shares (most of the id bytes, usually) is
+    // a pass skipped.
+    if (Scratch.GetSize() < count)
+        Scratch.Resize(count);
+    SortEntry* from = &Entries[0];
+    SortEntry* to   = &Scratch[0];
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        UPInt histogram[256];
+        memset(histogram, 0, sizeof(histogram));
+        for (UPInt i = 0; i < count; i++)
+            histogram[(from[i].Key >> shift) & 0xFF]++;
+        if (histogram[(from[0].Key >> shift) & 0xFF] == count)
+            continue;
+
+        UPInt offset = 0;
+        for (int b = 0; b < 256; b++)
+        {
+            UPInt n      = histogram[b];
+            histogram[b] = offset;
+            offset      += n;
+        }
+        for (UPInt i = 0; i < count; i++)
+            to[histogram[(from[i].Key >> shift) & 0xFF]++] = from[i];
+        Alg::Swap(from, to);
+    }
+    if (from != &Entries[0])
+        memcpy(&Entries[0], from, count * sizeof(SortEntry));
+
+    QueueStats.ShaderChanges = countChanges(&Entries[0], count, KeyShaderShift);
+    QueueStats.FillChanges   = countChanges(&Entries[0], count, KeyFillShift);
+    for (UPInt i = 0; i < count; i++)
+        if (i == 0 || !continuesRun(Entries[i - 1], Entries[i]))
+            QueueStats.Batches++;
+}
+
+// Whether 'entry' can be drawn as another instance of 'previous'.
+bool RenderQueue::continuesRun(const SortEntry& previous, const SortEntry& entry) const
+{
+    const Item& a = Items[previous.Item];
+    const Item& b = Items[entry.Item];
+    return b.MeshId && b.MeshId == a.MeshId && b.pModel->Fill == a.pModel->Fill;
+}
+
+// Items from 'start' that continuesRun chains together, at least one.
+UPInt RenderQueue::runLength(UPInt start) const
+{
+    UPInt end = start + 1;
+    while (end < Count && continuesRun(Entries[end - 1], Entries[end]))
+        end++;
+    return end - start;
+}
+
+void RenderQueue::Render(Scene* scene, RenderDevice* ren, const Matrix4f& view,
+                         InstanceRenderer* instancer) const
+{
+    scene->Lighting.Update(view, scene->LightPos);
+    ren->SetLighting(&scene->Lighting);
+
+    UPInt i = 0;
+    while (i < Count)
+    {
+        UPInt run = instancer ? runLength(i) : 1;
+        if (run == 1)
+        {
+            const Item& item = Items[Entries[i].Item];
+            if (item.pModel->Visible)
+                ren->Render(view * item.World, item.pModel);
+            i++;
+            continue;
+        }
+
+        // Any model of the run can stand for the others' geometry.
+        if (InstanceMatrices.GetSize() < run)
+            InstanceMatrices.Resize(run);
+        unsigned instances = 0;
+        Model*   model     = 0;
+        for (UPInt end = i + run; i < end; i++)
+        {
+            const Item& item = Items[Entries[i].Item];
+            if (!item.pModel->Visible)
+                continue;
+            InstanceMatrices[instances++] = view * item.World;
+            model = item.pModel;
+        }
+        if (instances)
+            instancer->RenderInstances(&InstanceMatrices[0], instances, model);
+    }
+}
+
+}} // OVR::RenderTiny
@@ -0,0 +1,133 @@
+/************************************************************************************
+
+Filename    :   RenderTiny_RenderQueue.h
+Content     :   Sorted draw list, built once per frame and replayed per eye
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+#ifndef INC_RenderTiny_RenderQueue_h
+#define INC_RenderTiny_RenderQueue_h
+
+#include "RenderTiny_Device.h"
+
+namespace OVR { namespace RenderTiny {
+
+//-------------------------------------------------------------------------------------
+// ***** InstanceRenderer
+
+// A device that can draw one model's geometry at many transforms in a single draw,
+// binding its state once. RenderTiny::RenderDevice has no instanced draw, so
+// devices that support one implement this as well.
+
+class InstanceRenderer
+{
+public:
+    virtual ~InstanceRenderer() { }
+
+    // Draws 'model' once per matrix, each the model-to-view transform Render(matrix,
+    // model) would take.
+    virtual void RenderInstances(const Matrix4f* matrices, unsigned count, Model* model) = 0;
+};
+
+
+//-------------------------------------------------------------------------------------
+// ***** RenderQueue
+
+// The models to draw this frame, in the order that changes device state least.
+// Each item gets a 64-bit key, 16 bits per field, most significant first: shader
+// set, fill (the fill being what carries textures and uniforms), mesh, then view
+// depth (nearest first, so depth testing rejects more). Sort() radix-sorts the keys
+// once; Render() replays the list, and is meant to be called for each eye of the
+// frame (or once for single-pass stereo) without sorting again.
+//
+// Items with the same fill and the same nonzero mesh id sort next to each other,
+// and Render() draws each such run as one instanced draw when given an
+// InstanceRenderer, with the instances' transforms gathered into one buffer.
+//
+// The ids in the keys come from the caller, which can assign them once rather
+// than per frame; SceneBVH::Queue does. Mesh ids must only be shared by models
+// with identical geometry. Fills don't say whether they are translucent, so
+// everything is sorted as opaque: draw translucent models separately, after the
+// queue.
+
+class RenderQueue
+{
+public:
+    // State changes a replay of the list makes, per Render() call.
+    struct Stats
+    {
+        UInt32      Items;
+        // Draws, with runs of a mesh drawn instanced.
+        UInt32      Batches;
+        UInt32      ShaderChanges;
+        UInt32      FillChanges;
+        // The same, had the items been drawn in the order they were added.
+        UInt32      UnsortedShaderChanges;
+        UInt32      UnsortedFillChanges;
+
+        Stats() { memset(this, 0, sizeof(*this)); }
+    };
+
+    RenderQueue();
+
+    void        Clear();
+    // 'world' is the model's world transform; 'depth' its distance in front of
+    // the camera, for ordering only. A meshId of 0 is never instanced.
+    void        Add(Model* model, const Matrix4f& world, unsigned shaderId, unsigned fillId,
+                    unsigned meshId, float depth);
+    void        Sort();
+
+    // Draws the sorted items, setting up the scene's lighting as Scene::Render does;
+    // runs of a mesh go to 'instancer' if there is one, which is usually 'ren'.
+    void        Render(Scene* scene, RenderDevice* ren, const Matrix4f& view,
+                       InstanceRenderer* instancer = 0) const;
+
+    UPInt       GetSize() const             { return Count; }
+    // For the list as of the last Sort().
+    const Stats& GetStats() const           { return QueueStats; }
+
+private:
+    struct Item
+    {
+        Model*      pModel;
+        Matrix4f    World;
+        unsigned    MeshId;
+    };
+
+    struct SortEntry
+    {
+        UInt64      Key;
+        UInt32      Item;
+    };
+
+    static UInt32       countChanges(const SortEntry* entries, UPInt count, int shift);
+    bool                continuesRun(const SortEntry& previous, const SortEntry& entry) const;
+    UPInt               runLength(UPInt start) const;
+
+    // The first Count of each are this frame's; they only grow, so refilling the
+    // queue every frame does not reallocate it. Models aren't referenced: the
+    // queue is refilled every frame, while the scene holds them.
+    UPInt               Count;
+    Array<Item>         Items;
+    Array<SortEntry>    Entries;
+    Array<SortEntry>    Scratch;
+    Stats               QueueStats;
+    // The current run's model-to-view transforms, for the instancer.
+    mutable Array<Matrix4f> InstanceMatrices;
+};
+
+}} // OVR::RenderTiny
+
+#endif
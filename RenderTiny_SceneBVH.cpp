@@ -0,0 +1,445 @@
+/************************************************************************************
+
+Filename    :   RenderTiny_SceneBVH.cpp
+Content     :   Bounding volume hierarchy for view-frustum culling a Scene
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "RenderTiny_SceneBVH.h"
+#include "../../LibOVR/Src/Kernel/OVR_Alg.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace OVR { namespace RenderTiny {
+
+// Bounds of a model that can't be bounded; inside or straddling every plane.
+static const float UnboundedExtent = 1e30f;
+
+//-------------------------------------------------------------------------------------
+// ***** CullFrustum
+
+CullFrustum CullFrustum::FromMatrix(const Matrix4f& m)
+{
+    // Gribb/Hartmann: each plane is the w row plus or minus the x, y or z row.
+    static const int   rows[Plane_Count]  = { 0, 0, 1, 1, 2, 2 };
+    static const float signs[Plane_Count] = { 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f };
+
+    CullFrustum f;
+    for (int p = 0; p < Plane_Count; p++)
+    {
+        int      r = rows[p];
+        float    s = signs[p];
+        Vector3f n(m.M[3][0] + s * m.M[r][0], m.M[3][1] + s * m.M[r][1], m.M[3][2] + s * m.M[r][2]);
+        float    d = m.M[3][3] + s * m.M[r][3];
+        float    length = n.Length();
+        if (length > 0.0f)
+        {
+            n = n / length;
+            d = d / length;
+        }
+        f.N[p] = n;
+        f.D[p] = d;
+    }
+    f.PlaneCount = Plane_Count;
+    return f;
+}
+
+// Where planes a, b and c meet; false if two of them are parallel.
+static bool intersectPlanes(const CullFrustum& f, int a, int b, int c, Vector3f* point)
+{
+    Vector3f bc    = f.N[b].Cross(f.N[c]);
+    float    denom = f.N[a].Dot(bc);
+    if (fabs(denom) < 1e-6f)
+        return false;
+    *point = (bc * -f.D[a] + f.N[c].Cross(f.N[a]) * -f.D[b] + f.N[a].Cross(f.N[b]) * -f.D[c]) / denom;
+    return true;
+}
+
+CullFrustum CullFrustum::Combine(const CullFrustum& left, const CullFrustum& right)
+{
+    CullFrustum combined;
+    if (left.PlaneCount != Plane_Count || right.PlaneCount != Plane_Count)
+        return combined;
+
+    Vector3f corners[16];
+    int      cornerCount = 0;
+    for (int e = 0; e < 2; e++)
+    {
+        const CullFrustum& f = e ? right : left;
+        for (int x = Plane_Left; x <= Plane_Right; x++)
+            for (int y = Plane_Bottom; y <= Plane_Top; y++)
+                for (int z = Plane_Near; z <= Plane_Far; z++)
+                {
+                    if (!intersectPlanes(f, x, y, z, &corners[cornerCount]) ||
+                        !(corners[cornerCount].LengthSq() < UnboundedExtent))
+                        return combined;
+                    cornerCount++;
+                }
+    }
+
+    for (int p = 0; p < Plane_Count; p++)
+    {
+        const CullFrustum& source = (p == Plane_Right) ? right : left;
+        Vector3f n = source.N[p];
+        float    d = source.D[p];
+        for (int i = 0; i < cornerCount; i++)
+        {
+            float distance = n.Dot(corners[i]) + d;
+            if (distance < 0.0f)
+                d -= distance;
+        }
+        combined.N[p] = n;
+        combined.D[p] = d;
+    }
+    combined.PlaneCount = Plane_Count;
+    return combined;
+}
+
+CullFrustum CullFrustum::FromStereo(const StereoEyeParams& left, const StereoEyeParams& right,
+                                    const Matrix4f& view)
+{
+    return Combine(FromMatrix(left.Projection * left.ViewAdjust * view),
+                   FromMatrix(right.Projection * right.ViewAdjust * view));
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** SceneBVH
+
+SceneBVH::SceneBVH()
+    : VisibleCount(0), NodesTested(0)
+{
+}
+
+void SceneBVH::Clear()
+{
+    Items.Clear();
+    ItemOrder.Clear();
+    Tree.Clear();
+    Visible.Clear();
+    VisibleCount = 0;
+    NodesTested  = 0;
+}
+
+void SceneBVH::Build(Scene* scene)
+{
+    Clear();
+    addNode(&scene->World, Matrix4f());
+
+    assignSortIds();
+
+    ItemOrder.Resize(Items.GetSize());
+    for (UPInt i = 0; i < Items.GetSize(); i++)
+        ItemOrder[i] = (int)i;
+    if (Items.GetSize())
+    {
+        Tree.Reserve(Items.GetSize() * 2);
+        buildNode(0, (int)Items.GetSize());
+    }
+    CullNone();
+}
+
+void SceneBVH::addNode(Node* node, const Matrix4f& parent)
+{
+    Matrix4f world = parent * node->GetMatrix();
+
+    if (node->GetType() == Node::Node_Container)
+    {
+        Container* container = (Container*)node;
+        for (UPInt i = 0; i < container->Nodes.GetSize(); i++)
+            addNode(container->Nodes[i], world);
+        return;
+    }
+    if (node->GetType() != Node::Node_Model)
+        return;
+
+    Model* model = (Model*)node;
+    Item   item;
+    item.pModel = model;
+    item.World  = world;
+    if (model->Vertices.GetSize() == 0)
+    {
+        item.Min = Vector3f(-UnboundedExtent, -UnboundedExtent, -UnboundedExtent);
+        item.Max = Vector3f( UnboundedExtent,  UnboundedExtent,  UnboundedExtent);
+    }
+    else
+    {
+        // Model-space box, then the world-space box around its eight corners.
+        Vector3f lo = model->Vertices[0].Pos, hi = lo;
+        for (UPInt i = 1; i < model->Vertices.GetSize(); i++)
+        {
+            const Vector3f& p = model->Vertices[i].Pos;
+            lo = Vector3f(Alg::Min(lo.x, p.x), Alg::Min(lo.y, p.y), Alg::Min(lo.z, p.z));
+            hi = Vector3f(Alg::Max(hi.x, p.x), Alg::Max(hi.y, p.y), Alg::Max(hi.z, p.z));
+        }
+        for (int c = 0; c < 8; c++)
+        {
+            Vector3f p = world.Transform(Vector3f((c & 1) ? hi.x : lo.x, (c & 2) ? hi.y : lo.y,
+                                                  (c & 4) ? hi.z : lo.z));
+            if (c == 0)
+                item.Min = item.Max = p;
+            item.Min = Vector3f(Alg::Min(item.Min.x, p.x), Alg::Min(item.Min.y, p.y), Alg::Min(item.Min.z, p.z));
+            item.Max = Vector3f(Alg::Max(item.Max.x, p.x), Alg::Max(item.Max.y, p.y), Alg::Max(item.Max.z, p.z));
+        }
+    }
+    Items.PushBack(item);
+}
+
+// FNV-1a, to find models whose geometry may be the same without comparing them all.
+static UInt32 hashBytes(UInt32 hash, const void* data, UPInt size)
+{
+    const UByte* bytes = (const UByte*)data;
+    for (UPInt i = 0; i < size; i++)
+        hash = (hash ^ bytes[i]) * 16777619u;
+    return hash;
+}
+
+static bool sameGeometry(const Model* a, const Model* b)
+{
+    return a->GetPrimType() == b->GetPrimType() &&
+           a->Vertices.GetSize() == b->Vertices.GetSize() && a->Indices.GetSize() == b->Indices.GetSize() &&
+           !memcmp(&a->Vertices[0], &b->Vertices[0], a->Vertices.GetSize() * sizeof(Vertex)) &&
+           (!a->Indices.GetSize() ||
+            !memcmp(&a->Indices[0], &b->Indices[0], a->Indices.GetSize() * sizeof(UInt16)));
+}
+
+void SceneBVH::assignSortIds()
+{
+    // Numbered in order of first use. Models in a scene share a handful of fills,
+    // so a search of the ones seen so far is cheap enough for a build; meshes are
+    // compared only when their hashes match.
+    Array<const void*> shaderSets, fills;
+    Array<const Model*> meshes;
+    Array<UInt32>       meshHashes;
+    for (UPInt i = 0; i < Items.GetSize(); i++)
+    {
+        Item&  item  = Items[i];
+        Model* model = item.pModel;
+        Fill*  fill  = model->Fill;
+        item.ShaderId = item.FillId = item.MeshId = 0;
+
+        if (model->Vertices.GetSize())
+        {
+            UInt32 hash = hashBytes(2166136261u, &model->Vertices[0], model->Vertices.GetSize() * sizeof(Vertex));
+            if (model->Indices.GetSize())
+                hash = hashBytes(hash, &model->Indices[0], model->Indices.GetSize() * sizeof(UInt16));
+            UPInt m = 0;
+            while (m < meshes.GetSize() && !(meshHashes[m] == hash && sameGeometry(meshes[m], model)))
+                m++;
+            if (m == meshes.GetSize())
+            {
+                meshes.PushBack(model);
+                meshHashes.PushBack(hash);
+            }
+            // Past 16 bits, ids would alias and instance different meshes together.
+            item.MeshId = (m + 1 < 0xFFFF) ? UInt16(m + 1) : 0;
+        }
+
+        if (!fill)
+            continue;
+
+        // Every Fill is a ShaderFill, as the D3D device also assumes.
+        const void* shaders = ((ShaderFill*)fill)->GetShaders();
+        UPInt       s = 0, f = 0;
+        while (s < shaderSets.GetSize() && shaderSets[s] != shaders)
+            s++;
+        if (s == shaderSets.GetSize())
+            shaderSets.PushBack(shaders);
+        while (f < fills.GetSize() && fills[f] != fill)
+            f++;
+        if (f == fills.GetSize())
+            fills.PushBack(fill);
+        item.ShaderId = UInt16(Alg::Min<UPInt>(s + 1, 0xFFFF));
+        item.FillId   = UInt16(Alg::Min<UPInt>(f + 1, 0xFFFF));
+    }
+}
+
+void SceneBVH::buildNode(int first, int count)
+{
+    int index = (int)Tree.GetSize();
+    Tree.PushBack(TreeNode());
+
+    // Box around the models, and around their centers to choose the split.
+    const Item& firstItem = Items[ItemOrder[first]];
+    Vector3f lo = firstItem.Min, hi = firstItem.Max;
+    Vector3f centerLo = (firstItem.Min + firstItem.Max) * 0.5f, centerHi = centerLo;
+    for (int i = first + 1; i < first + count; i++)
+    {
+        const Item& item   = Items[ItemOrder[i]];
+        Vector3f    center = (item.Min + item.Max) * 0.5f;
+        lo       = Vector3f(Alg::Min(lo.x, item.Min.x), Alg::Min(lo.y, item.Min.y), Alg::Min(lo.z, item.Min.z));
+        hi       = Vector3f(Alg::Max(hi.x, item.Max.x), Alg::Max(hi.y, item.Max.y), Alg::Max(hi.z, item.Max.z));
+        centerLo = Vector3f(Alg::Min(centerLo.x, center.x), Alg::Min(centerLo.y, center.y), Alg::Min(centerLo.z, center.z));
+        centerHi = Vector3f(Alg::Max(centerHi.x, center.x), Alg::Max(centerHi.y, center.y), Alg::Max(centerHi.z, center.z));
+    }
+    Tree[index].Min = lo;
+    Tree[index].Max = hi;
+
+    if (count <= MaxLeafModels)
+    {
+        Tree[index].Second = 0;
+        Tree[index].First  = first;
+        Tree[index].Count  = count;
+        return;
+    }
+
+    // Split the centers' box in half along its longest axis; if that leaves a side
+    // empty (models stacked on one center), split the list in half instead.
+    Vector3f extent = centerHi - centerLo;
+    int      axis   = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : ((extent.y >= extent.z) ? 1 : 2);
+    float    split  = (axis == 0) ? (centerLo.x + centerHi.x) * 0.5f :
+                      (axis == 1) ? (centerLo.y + centerHi.y) * 0.5f : (centerLo.z + centerHi.z) * 0.5f;
+    int      middle = first;
+    for (int i = first; i < first + count; i++)
+    {
+        const Item& item   = Items[ItemOrder[i]];
+        float       center = (axis == 0) ? (item.Min.x + item.Max.x) * 0.5f :
+                             (axis == 1) ? (item.Min.y + item.Max.y) * 0.5f : (item.Min.z + item.Max.z) * 0.5f;
+        if (center < split)
+            Alg::Swap(ItemOrder[i], ItemOrder[middle++]);
+    }
+    if (middle == first || middle == first + count)
+        middle = first + count / 2;
+
+    Tree[index].Count = 0;
+    Tree[index].First = 0;
+    buildNode(first, middle - first);
+    Tree[index].Second = (int)Tree.GetSize();
+    buildNode(middle, first + count - middle);
+}
+
+void SceneBVH::CullNone()
+{
+    Visible.Resize(Items.GetSize());
+    for (UPInt i = 0; i < Visible.GetSize(); i++)
+        Visible[i] = 1;
+    VisibleCount = (unsigned)Items.GetSize();
+    NodesTested  = 0;
+}
+
+void SceneBVH::Cull(const CullFrustum& frustum)
+{
+    Visible.Resize(Items.GetSize());
+    for (UPInt i = 0; i < Visible.GetSize(); i++)
+        Visible[i] = 0;
+    VisibleCount = 0;
+    NodesTested  = 0;
+    if (Tree.GetSize() == 0)
+        return;
+
+    // Depth-first, with the planes each node still straddles; a node entirely
+    // inside a plane passes that plane on to its children as done.
+    enum { MaxDepth = 64 };
+    struct Entry { int Node; unsigned Planes; } stack[MaxDepth];
+    int depth = 0;
+    stack[depth].Node   = 0;
+    stack[depth].Planes = (1u << frustum.PlaneCount) - 1;
+    depth++;
+
+    while (depth)
+    {
+        depth--;
+        int             index  = stack[depth].Node;
+        unsigned        planes = stack[depth].Planes;
+        const TreeNode& node   = Tree[index];
+        bool            culled = false;
+        NodesTested++;
+
+        for (int p = 0; p < frustum.PlaneCount && !culled; p++)
+        {
+            if (!(planes & (1u << p)))
+                continue;
+            const Vector3f& n = frustum.N[p];
+            // The box corners farthest along and against the plane normal.
+            Vector3f outer(n.x >= 0 ? node.Max.x : node.Min.x, n.y >= 0 ? node.Max.y : node.Min.y,
+                           n.z >= 0 ? node.Max.z : node.Min.z);
+            Vector3f inner(n.x >= 0 ? node.Min.x : node.Max.x, n.y >= 0 ? node.Min.y : node.Max.y,
+                           n.z >= 0 ? node.Min.z : node.Max.z);
+            if (n.Dot(outer) + frustum.D[p] < 0.0f)
+                culled = true;
+            else if (n.Dot(inner) + frustum.D[p] >= 0.0f)
+                planes &= ~(1u << p);
+        }
+        if (culled)
+            continue;
+
+        if (node.Count || !planes)
+        {
+            // A leaf, or a subtree entirely inside: everything in it is visible.
+            int first = node.First, count = node.Count;
+            if (!node.Count)
+            {
+                // Subtree items are contiguous in ItemOrder, from its leftmost leaf
+                // to its rightmost.
+                int leftmost = index, rightmost = index;
+                while (Tree[leftmost].Count == 0)
+                    leftmost++;
+                while (Tree[rightmost].Count == 0)
+                    rightmost = Tree[rightmost].Second;
+                first = Tree[leftmost].First;
+                count = Tree[rightmost].First + Tree[rightmost].Count - first;
+            }
+            for (int i = first; i < first + count; i++)
+                Visible[ItemOrder[i]] = 1;
+            VisibleCount += count;
+            continue;
+        }
+
+        if (depth + 2 > MaxDepth)
+        {
+            // Deeper than any tree Build makes from a sane scene; draw it all.
+            stack[depth].Node   = index;
+            stack[depth].Planes = 0;
+            depth++;
+            continue;
+        }
+        stack[depth].Node   = node.Second;
+        stack[depth].Planes = planes;
+        depth++;
+        stack[depth].Node   = index + 1;
+        stack[depth].Planes = planes;
+        depth++;
+    }
+}
+
+void SceneBVH::Render(Scene* scene, RenderDevice* ren, const Matrix4f& view) const
+{
+    scene->Lighting.Update(view, scene->LightPos);
+    ren->SetLighting(&scene->Lighting);
+
+    for (UPInt i = 0; i < Items.GetSize(); i++)
+    {
+        const Item& item = Items[i];
+        if (Visible[i] && item.pModel->Visible)
+            ren->Render(view * item.World, item.pModel);
+    }
+}
+
+void SceneBVH::Queue(RenderQueue* queue, const Matrix4f& view) const
+{
+    for (UPInt i = 0; i < Items.GetSize(); i++)
+    {
+        const Item& item = Items[i];
+        if (!Visible[i] || !item.pModel->Visible)
+            continue;
+        // Distance in front of the camera, which looks down -z.
+        Vector3f center = view.Transform((item.Min + item.Max) * 0.5f);
+        queue->Add(item.pModel, item.World, item.ShaderId, item.FillId, item.MeshId, -center.z);
+    }
+}
+
+}} // OVR::RenderTiny
@@ -0,0 +1,141 @@
+/************************************************************************************
+
+Filename    :   RenderTiny_SceneBVH.h
+Content     :   Bounding volume hierarchy for view-frustum culling a Scene
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+#ifndef INC_RenderTiny_SceneBVH_h
+#define INC_RenderTiny_SceneBVH_h
+
+#include "RenderTiny_Device.h"
+#include "RenderTiny_RenderQueue.h"
+
+namespace OVR { namespace RenderTiny {
+
+//-------------------------------------------------------------------------------------
+// ***** CullFrustum
+
+// Up to six world-space planes, N.Dot(p) + D >= 0 inside. A frustum with no planes
+// contains everything.
+struct CullFrustum
+{
+    enum
+    {
+        Plane_Left, Plane_Right, Plane_Bottom, Plane_Top, Plane_Near, Plane_Far,
+        Plane_Count
+    };
+
+    Vector3f    N[Plane_Count];
+    float       D[Plane_Count];
+    int         PlaneCount;
+
+    CullFrustum() : PlaneCount(0) { }
+
+    // The frustum of clip = viewProj * world, e.g. Projection * ViewAdjust * View.
+    // The near plane is taken as clip z = -w, so it holds for both 0..w and -w..w
+    // depth ranges.
+    static CullFrustum FromMatrix(const Matrix4f& viewProj);
+
+    // One frustum containing both 'left' and 'right': left's planes, except the
+    // right plane which is right's, each moved out until it contains both frusta's
+    // corners. For the side-by-side eye frusta of StereoConfig this is close to
+    // their convex hull, so culling against it once serves both eyes. If a corner
+    // can't be found (an infinite far plane), the result contains everything.
+    static CullFrustum Combine(const CullFrustum& left, const CullFrustum& right);
+    // Combine of both eyes' frusta for a camera at 'view'.
+    static CullFrustum FromStereo(const StereoEyeParams& left, const StereoEyeParams& right,
+                                  const Matrix4f& view);
+};
+
+
+//-------------------------------------------------------------------------------------
+// ***** SceneBVH
+
+// Culls a Scene's models against a frustum, so that models nobody can see are not
+// submitted. Build() flattens the scene graph into its models with their world
+// transforms and world-space bounds, and builds a binary tree of boxes over them;
+// Cull() walks the tree once per frame, skipping planes a box is already entirely
+// inside of, and records which models are in view. Render() then draws those, in
+// the scene's order, and can be called for each eye (or once for single-pass
+// stereo) with the result of one Cull() against the eyes' combined frustum.
+//
+// Bounds are taken at Build() time. Build again after adding, removing or moving
+// models; Model::Visible is still honored at Render() time. Models with no
+// Vertices (buffers only) are never culled.
+
+class SceneBVH
+{
+public:
+    enum { MaxLeafModels = 4 };
+
+    SceneBVH();
+
+    void        Build(Scene* scene);
+    void        Clear();
+
+    // Marks the models that 'frustum' may contain.
+    void        Cull(const CullFrustum& frustum);
+    // Everything visible, as if Cull had not been called; for A/B comparison.
+    void        CullNone();
+
+    // Draws the models the last Cull marked, as Scene::Render(ren, view) would.
+    void        Render(Scene* scene, RenderDevice* ren, const Matrix4f& view) const;
+    // Adds them to 'queue' instead, with shader, fill and mesh ids assigned at
+    // Build() and their depth from a camera at 'view'. Models with identical
+    // geometry get the same mesh id, so the queue can draw them instanced.
+    void        Queue(RenderQueue* queue, const Matrix4f& view) const;
+
+    unsigned    GetModelCount() const       { return (unsigned)Items.GetSize(); }
+    unsigned    GetVisibleCount() const     { return VisibleCount; }
+    // Tree nodes the last Cull tested.
+    unsigned    GetNodesTested() const      { return NodesTested; }
+
+private:
+    struct Item
+    {
+        Ptr<Model>  pModel;
+        Matrix4f    World;
+        Vector3f    Min, Max;
+        // Sort ids of the model's ShaderSet and Fill, 0 for none (DefaultFill),
+        // and of its geometry, shared by every model with identical vertices and
+        // indices, 0 if it has none.
+        UInt16      ShaderId, FillId, MeshId;
+    };
+
+    // Interior nodes have their first child next to them and the second at Second;
+    // leaves have Count > 0 models at ItemOrder[First..].
+    struct TreeNode
+    {
+        Vector3f    Min, Max;
+        int         Second;
+        int         First, Count;
+    };
+
+    void        addNode(Node* node, const Matrix4f& parent);
+    void        buildNode(int first, int count);
+    void        assignSortIds();
+
+    Array<Item>     Items;
+    Array<int>      ItemOrder;
+    Array<TreeNode> Tree;
+    Array<UByte>    Visible;
+    unsigned        VisibleCount;
+    unsigned        NodesTested;
+};
+
+}} // OVR::RenderTiny
+
+#endif
@@ -0,0 +1,462 @@
+/************************************************************************************
+
+Filename    :   RenderTiny_SceneFile.cpp
+Content     :   Binary scene files, memory mapped to load, and their exporter
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "RenderTiny_SceneFile.h"
+#include "../../LibOVR/Src/Kernel/OVR_Alg.h"
+#include "../../LibOVR/Src/Kernel/OVR_Log.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace OVR { namespace RenderTiny {
+
+static const char SceneFileMagic[4] = { 'R', 'T', 'S', 'C' };
+
+// RGBA textures larger than this each way are taken for a corrupt file.
+static const UInt32 MaxTextureSize = 16384;
+
+static UInt64 alignOffset(UInt64 offset)
+{
+    return (offset + SceneFile_Alignment - 1) & ~UInt64(SceneFile_Alignment - 1);
+}
+
+static void storeVector(float* out, const Vector4f& v)
+{
+    out[0] = v.x;
+    out[1] = v.y;
+    out[2] = v.z;
+    out[3] = v.w;
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** SceneFile
+
+SceneFile::SceneFile()
+    : pHeader(0)
+{
+}
+
+bool SceneFile::Open(const char* path)
+{
+    Close();
+
+    if (!File.Open(path))
+    {
+        LogText("Scene: Failed to open %s\n", path);
+        return false;
+    }
+    if (File.GetSize() < sizeof(SceneFileHeader))
+    {
+        LogText("Scene: %s is not a compatible scene file\n", path);
+        File.Close();
+        return false;
+    }
+
+    pHeader = (const SceneFileHeader*)File.GetData();
+    if (!validate())
+    {
+        LogText("Scene: %s is not a compatible scene file\n", path);
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void SceneFile::Close()
+{
+    pHeader = 0;
+    File.Close();
+}
+
+// Whether 'count' records of 'size' bytes at 'offset' are aligned and inside the file.
+bool SceneFile::inFile(UInt32 offset, UInt32 count, UPInt size) const
+{
+    return (offset % SceneFile_Alignment) == 0 &&
+           UInt64(offset) + UInt64(count) * size <= UInt64(File.GetSize());
+}
+
+// Everything Populate() and the accessors rely on. Vertices are not read, but
+// every index is checked against its mesh's vertex count, as consumers such as
+// StaticBatch take a Model's indices as they are.
+bool SceneFile::validate() const
+{
+    const SceneFileHeader& h = *pHeader;
+    if (memcmp(h.Magic, SceneFileMagic, sizeof(SceneFileMagic)) != 0 ||
+        h.Version != SceneFile_Version || h.VertexSize != sizeof(Vertex) || h.LightCount > 8)
+        return false;
+    if (!inFile(h.TextureOffset, h.TextureCount, sizeof(SceneFileTexture)) ||
+        !inFile(h.MaterialOffset, h.MaterialCount, sizeof(SceneFileMaterial)) ||
+        !inFile(h.MeshOffset, h.MeshCount, sizeof(SceneFileMesh)) ||
+        !inFile(h.ModelOffset, h.ModelCount, sizeof(SceneFileModel)) ||
+        !inFile(h.LightOffset, h.LightCount, sizeof(SceneFileLight)))
+        return false;
+
+    const SceneFileTexture* textures = GetTextures();
+    for (UInt32 i = 0; i < h.TextureCount; i++)
+    {
+        const SceneFileTexture& t = textures[i];
+        if ((t.Format & Texture_TypeMask) != Texture_RGBA ||
+            t.Width == 0 || t.Width > MaxTextureSize || t.Height == 0 || t.Height > MaxTextureSize ||
+            UInt64(t.DataSize) < UInt64(t.Width) * t.Height * 4 || !inFile(t.DataOffset, t.DataSize, 1))
+            return false;
+    }
+
+    const SceneFileMaterial* materials = GetMaterials();
+    for (UInt32 i = 0; i < h.MaterialCount; i++)
+    {
+        const SceneFileMaterial& m = materials[i];
+        if (m.VertexShader >= VShader_Count || m.FragmentShader >= FShader_Count ||
+            m.Texture < -1 || m.Texture >= (SInt32)h.TextureCount)
+            return false;
+    }
+
+    const SceneFileMesh* meshes = GetMeshes();
+    for (UInt32 i = 0; i < h.MeshCount; i++)
+    {
+        const SceneFileMesh& m = meshes[i];
+        if (m.PrimType >= Prim_Unknown || m.VertexCount > 0x10000 ||
+            !inFile(m.VertexOffset, m.VertexCount, sizeof(Vertex)) ||
+            !inFile(m.IndexOffset, m.IndexCount, sizeof(UInt16)))
+            return false;
+
+        const UInt16* indices = GetIndices(m);
+        for (UInt32 j = 0; j < m.IndexCount; j++)
+            if (indices[j] >= m.VertexCount)
+                return false;
+    }
+
+    const SceneFileModel* models = GetModels();
+    for (UInt32 i = 0; i < h.ModelCount; i++)
+    {
+        const SceneFileModel& m = models[i];
+        if (m.Mesh >= h.MeshCount || m.Material < -1 || m.Material >= (SInt32)h.MaterialCount)
+            return false;
+    }
+    return true;
+}
+
+void SceneFile::Populate(Scene* scene, RenderDevice* render) const
+{
+    if (!pHeader)
+        return;
+    const SceneFileHeader& h = *pHeader;
+
+    Array<Ptr<Texture> > textures;
+    textures.Resize(h.TextureCount);
+    for (UInt32 i = 0; i < h.TextureCount; i++)
+    {
+        const SceneFileTexture& t = GetTextures()[i];
+        textures[i] = *render->CreateTexture(t.Format, t.Width, t.Height, GetPixels(t));
+    }
+
+    Array<Ptr<Fill> > fills;
+    fills.Resize(h.MaterialCount);
+    for (UInt32 i = 0; i < h.MaterialCount; i++)
+    {
+        const SceneFileMaterial& m       = GetMaterials()[i];
+        Ptr<ShaderSet>           shaders = *render->CreateShaderSet();
+        Ptr<Shader>              vs      = *render->LoadBuiltinShader(Shader_Vertex, m.VertexShader);
+        Ptr<Shader>              fs      = *render->LoadBuiltinShader(Shader_Fragment, m.FragmentShader);
+        shaders->SetShader(vs);
+        shaders->SetShader(fs);
+
+        ShaderFill* fill = new ShaderFill(shaders);
+        if (m.Texture >= 0 && textures[m.Texture])
+            fill->SetTexture(0, textures[m.Texture]);
+        fills[i] = *fill;
+    }
+
+    // Buffers straight from the mapping, one pair per mesh; a device that can't
+    // create them leaves the models to create their own.
+    Array<Ptr<Buffer> > vertexBuffers, indexBuffers;
+    vertexBuffers.Resize(h.MeshCount);
+    indexBuffers.Resize(h.MeshCount);
+    for (UInt32 i = 0; i < h.MeshCount; i++)
+    {
+        const SceneFileMesh& mesh = GetMeshes()[i];
+        if (!mesh.VertexCount || !mesh.IndexCount)
+            continue;
+        Ptr<Buffer> vb = *render->CreateBuffer();
+        Ptr<Buffer> ib = *render->CreateBuffer();
+        if (!vb || !ib)
+            continue;
+        vb->Data(Buffer_Vertex | Buffer_ReadOnly, GetVertices(mesh), mesh.VertexCount * sizeof(Vertex));
+        ib->Data(Buffer_Index | Buffer_ReadOnly, GetIndices(mesh), mesh.IndexCount * sizeof(UInt16));
+        vertexBuffers[i] = vb;
+        indexBuffers[i]  = ib;
+    }
+
+    for (UInt32 i = 0; i < h.ModelCount; i++)
+    {
+        const SceneFileModel& m    = GetModels()[i];
+        const SceneFileMesh&  mesh = GetMeshes()[m.Mesh];
+        Ptr<Model>            model = *new Model((PrimitiveType)mesh.PrimType);
+
+        model->Vertices.Resize(mesh.VertexCount);
+        if (mesh.VertexCount)
+            memcpy(&model->Vertices[0], GetVertices(mesh), mesh.VertexCount * sizeof(Vertex));
+        model->Indices.Resize(mesh.IndexCount);
+        if (mesh.IndexCount)
+            memcpy(&model->Indices[0], GetIndices(mesh), mesh.IndexCount * sizeof(UInt16));
+        model->VertexBuffer = vertexBuffers[m.Mesh];
+        model->IndexBuffer  = indexBuffers[m.Mesh];
+        if (m.Material >= 0)
+            model->Fill = fills[m.Material];
+        model->Visible = (m.Flags & SceneFileModel_Hidden) == 0;
+
+        Matrix4f world;
+        memcpy(world.M, m.World, sizeof(m.World));
+        model->SetMatrix(world);
+        scene->World.Add(model);
+    }
+
+    for (UInt32 i = 0; i < h.LightCount && scene->Lighting.LightCount < 8; i++)
+    {
+        const SceneFileLight& light = GetLights()[i];
+        scene->AddLight(Vector3f(light.Position[0], light.Position[1], light.Position[2]),
+                        Vector4f(light.Color[0], light.Color[1], light.Color[2], light.Color[3]));
+    }
+    scene->SetAmbient(Vector4f(h.Ambient[0], h.Ambient[1], h.Ambient[2], h.Ambient[3]));
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** SceneFileWriter
+
+SceneFileWriter::SceneFileWriter()
+    : Skipped(0)
+{
+}
+
+int SceneFileWriter::AddTexture(int format, int width, int height, const void* pixels)
+{
+    SceneFileTexture t;
+    t.Format     = (UInt32)format;
+    t.Width      = (UInt32)width;
+    t.Height     = (UInt32)height;
+    t.DataSize   = t.Width * t.Height * 4;
+    t.DataOffset = (UInt32)Pixels.GetSize();  // Into Pixels until Write().
+    Pixels.Resize(Pixels.GetSize() + t.DataSize);
+    memcpy(&Pixels[t.DataOffset], pixels, t.DataSize);
+    Textures.PushBack(t);
+    return (int)Textures.GetSize() - 1;
+}
+
+void SceneFileWriter::AddMaterial(const Fill* fill, int vertexShader, int fragmentShader, int texture)
+{
+    SceneFileMaterial m;
+    m.VertexShader   = (UInt32)vertexShader;
+    m.FragmentShader = (UInt32)fragmentShader;
+    m.Texture        = texture;
+    MaterialFills.PushBack(fill);
+    Materials.PushBack(m);
+}
+
+void SceneFileWriter::addNode(const Node* node, const Matrix4f& parent)
+{
+    Matrix4f world = parent * node->GetMatrix();
+
+    if (node->GetType() == Node::Node_Container)
+    {
+        const Container* container = (const Container*)node;
+        for (UPInt i = 0; i < container->Nodes.GetSize(); i++)
+            addNode(container->Nodes[i], world);
+        return;
+    }
+    if (node->GetType() != Node::Node_Model)
+        return;
+
+    const Model* model = (const Model*)node;
+    if (model->Vertices.GetSize() == 0 || model->Indices.GetSize() == 0)
+    {
+        Skipped++;
+        return;
+    }
+    ModelEntry entry;
+    entry.pModel = model;
+    entry.World  = world;
+    entry.Mesh   = findMesh(model);
+    Models.PushBack(entry);
+}
+
+// The mesh with the same geometry as 'model', added if there is none yet. As in
+// SceneBVH, FNV-1a hashes narrow the search and the data is compared to confirm.
+UInt32 SceneFileWriter::findMesh(const Model* model)
+{
+    UPInt        vertexBytes = model->Vertices.GetSize() * sizeof(Vertex);
+    UPInt        indexBytes  = model->Indices.GetSize() * sizeof(UInt16);
+    UInt32       hash        = 2166136261u ^ (UInt32)model->GetPrimType();
+    const UByte* bytes       = (const UByte*)&model->Vertices[0];
+    for (UPInt i = 0; i < vertexBytes; i++)
+        hash = (hash ^ bytes[i]) * 16777619u;
+    bytes = (const UByte*)&model->Indices[0];
+    for (UPInt i = 0; i < indexBytes; i++)
+        hash = (hash ^ bytes[i]) * 16777619u;
+
+    for (UPInt m = 0; m < Meshes.GetSize(); m++)
+    {
+        const Model* other = Meshes[m];
+        if (MeshHashes[m] == hash && other->GetPrimType() == model->GetPrimType() &&
+            other->Vertices.GetSize() == model->Vertices.GetSize() &&
+            other->Indices.GetSize() == model->Indices.GetSize() &&
+            memcmp(&other->Vertices[0], &model->Vertices[0], vertexBytes) == 0 &&
+            memcmp(&other->Indices[0], &model->Indices[0], indexBytes) == 0)
+            return (UInt32)m;
+    }
+    Meshes.PushBack(model);
+    MeshHashes.PushBack(hash);
+    return (UInt32)Meshes.GetSize() - 1;
+}
+
+// Writes 'size' bytes at 'offset', zero-padding up to it from 'position'.
+static bool writeAt(FILE* f, UInt64* position, UInt64 offset, const void* data, UPInt size)
+{
+    static const UByte zeros[SceneFile_Alignment] = { 0 };
+    while (*position < offset)
+    {
+        UPInt pad = (UPInt)Alg::Min(offset - *position, UInt64(sizeof(zeros)));
+        if (fwrite(zeros, 1, pad, f) != pad)
+            return false;
+        *position += pad;
+    }
+    if (size && fwrite(data, 1, size, f) != size)
+        return false;
+    *position += size;
+    return true;
+}
+
+bool SceneFileWriter::Write(const char* path, const Scene* scene)
+{
+    Meshes.Clear();
+    MeshHashes.Clear();
+    Models.Clear();
+    Skipped = 0;
+    // Relative to World, as Populate() adds them to it.
+    for (UPInt i = 0; i < scene->World.Nodes.GetSize(); i++)
+        addNode(scene->World.Nodes[i], Matrix4f());
+
+    // Layout: the header, the tables, then the blobs, each aligned.
+    SceneFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.Magic, SceneFileMagic, sizeof(SceneFileMagic));
+    header.Version       = SceneFile_Version;
+    header.VertexSize    = sizeof(Vertex);
+    header.TextureCount  = (UInt32)Textures.GetSize();
+    header.MaterialCount = (UInt32)Materials.GetSize();
+    header.MeshCount     = (UInt32)Meshes.GetSize();
+    header.ModelCount    = (UInt32)Models.GetSize();
+    header.LightCount    = Alg::Min((UInt32)scene->Lighting.LightCount, 8u);
+    storeVector(header.Ambient, scene->Lighting.Ambient);
+
+    UInt64 end = sizeof(header);
+    UInt64 offsets[5];
+    UInt64 tableSizes[5] = { header.TextureCount * sizeof(SceneFileTexture),
+                             header.MaterialCount * sizeof(SceneFileMaterial),
+                             header.MeshCount * sizeof(SceneFileMesh),
+                             header.ModelCount * sizeof(SceneFileModel),
+                             header.LightCount * sizeof(SceneFileLight) };
+    for (int t = 0; t < 5; t++)
+    {
+        offsets[t] = alignOffset(end);
+        end        = offsets[t] + tableSizes[t];
+    }
+
+    Array<SceneFileTexture> textures(Textures);
+    for (UPInt i = 0; i < textures.GetSize(); i++)
+    {
+        textures[i].DataOffset = (UInt32)alignOffset(end);
+        end = UInt64(textures[i].DataOffset) + textures[i].DataSize;
+    }
+    Array<SceneFileMesh> meshes;
+    meshes.Resize(Meshes.GetSize());
+    for (UPInt i = 0; i < meshes.GetSize(); i++)
+    {
+        const Model* model = Meshes[i];
+        meshes[i].PrimType     = (UInt32)model->GetPrimType();
+        meshes[i].VertexCount  = (UInt32)model->Vertices.GetSize();
+        meshes[i].VertexOffset = (UInt32)alignOffset(end);
+        end = UInt64(meshes[i].VertexOffset) + meshes[i].VertexCount * sizeof(Vertex);
+        meshes[i].IndexCount   = (UInt32)model->Indices.GetSize();
+        meshes[i].IndexOffset  = (UInt32)alignOffset(end);
+        end = UInt64(meshes[i].IndexOffset) + meshes[i].IndexCount * sizeof(UInt16);
+    }
+    if (end > 0xFFFFFFFFu)
+    {
+        LogText("Scene: %s would be larger than 4 GB\n", path);
+        return false;
+    }
+    header.TextureOffset  = (UInt32)offsets[0];
+    header.MaterialOffset = (UInt32)offsets[1];
+    header.MeshOffset     = (UInt32)offsets[2];
+    header.ModelOffset    = (UInt32)offsets[3];
+    header.LightOffset    = (UInt32)offsets[4];
+
+    Array<SceneFileModel> models;
+    models.Resize(Models.GetSize());
+    for (UPInt i = 0; i < models.GetSize(); i++)
+    {
+        const ModelEntry& entry = Models[i];
+        memcpy(models[i].World, entry.World.M, sizeof(models[i].World));
+        models[i].Mesh     = entry.Mesh;
+        models[i].Material = -1;
+        models[i].Flags    = entry.pModel->Visible ? 0 : SceneFileModel_Hidden;
+        for (UPInt m = 0; m < MaterialFills.GetSize(); m++)
+            if (MaterialFills[m] == entry.pModel->Fill.GetPtr())
+            {
+                models[i].Material = (SInt32)m;
+                break;
+            }
+    }
+    SceneFileLight lights[8];
+    for (UInt32 i = 0; i < header.LightCount; i++)
+    {
+        storeVector(lights[i].Position, scene->LightPos[i]);
+        storeVector(lights[i].Color, scene->Lighting.LightColor[i]);
+    }
+
+    FILE* f = fopen(path, "wb");
+    if (!f)
+    {
+        LogText("Scene: Failed to create %s\n", path);
+        return false;
+    }
+    UInt64 position = 0;
+    bool   ok = writeAt(f, &position, 0, &header, sizeof(header)) &&
+                writeAt(f, &position, offsets[0], textures.GetSize() ? &textures[0] : 0, (UPInt)tableSizes[0]) &&
+                writeAt(f, &position, offsets[1], Materials.GetSize() ? &Materials[0] : 0, (UPInt)tableSizes[1]) &&
+                writeAt(f, &position, offsets[2], meshes.GetSize() ? &meshes[0] : 0, (UPInt)tableSizes[2]) &&
+                writeAt(f, &position, offsets[3], models.GetSize() ? &models[0] : 0, (UPInt)tableSizes[3]) &&
+                writeAt(f, &position, offsets[4], lights, (UPInt)tableSizes[4]);
+    for (UPInt i = 0; ok && i < textures.GetSize(); i++)
+        ok = writeAt(f, &position, textures[i].DataOffset, &Pixels[Textures[i].DataOffset], textures[i].DataSize);
+    for (UPInt i = 0; ok && i < meshes.GetSize(); i++)
+        ok = writeAt(f, &position, meshes[i].VertexOffset, &Meshes[i]->Vertices[0],
+                     meshes[i].VertexCount * sizeof(Vertex)) &&
+             writeAt(f, &position, meshes[i].IndexOffset, &Meshes[i]->Indices[0],
+                     meshes[i].IndexCount * sizeof(UInt16));
+    if (fclose(f) != 0)
+        ok = false;
+    if (!ok)
+        LogText("Scene: Failed to write %s\n", path);
+    return ok;
+}
+
+}} // OVR::RenderTiny
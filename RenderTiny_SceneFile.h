@@ -0,0 +1,197 @@
+/************************************************************************************
+
+Filename    :   RenderTiny_SceneFile.h
+Content     :   Binary scene files, memory mapped to load, and their exporter
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+#ifndef INC_RenderTiny_SceneFile_h
+#define INC_RenderTiny_SceneFile_h
+
+#include "RenderTiny_Device.h"
+#include "Util_MappedFile.h"
+
+namespace OVR { namespace RenderTiny {
+
+//-------------------------------------------------------------------------------------
+// ***** Scene file format
+
+// A scene file is a header followed by tables of fixed-size records and the blobs
+// they point at, everything at an offset from the start of the file. Tables and
+// blobs start on 16-byte boundaries, so once the file is mapped every record,
+// vertex and index can be used where it lies. All fields are little-endian.
+//
+// Vertex blobs are arrays of RenderTiny::Vertex exactly as it is laid out in
+// memory (the header records sizeof(Vertex) to catch a mismatch); index blobs are
+// UInt16. Models name a mesh, so models with identical geometry share one, and a
+// material, which is a builtin vertex and fragment shader and an optional RGBA
+// texture.
+
+#pragma pack(push,1)
+struct SceneFileHeader
+{
+    char        Magic[4];       // "RTSC"
+    UInt16      Version;
+    UInt16      VertexSize;     // sizeof(Vertex) when written.
+    UInt32      TextureCount,  TextureOffset;
+    UInt32      MaterialCount, MaterialOffset;
+    UInt32      MeshCount,     MeshOffset;
+    UInt32      ModelCount,    ModelOffset;
+    UInt32      LightCount,    LightOffset;
+    float       Ambient[4];
+};
+
+struct SceneFileTexture
+{
+    UInt32      Format;         // TextureFormat; only Texture_RGBA ones are written.
+    UInt32      Width, Height;
+    UInt32      DataOffset, DataSize;
+};
+
+struct SceneFileMaterial
+{
+    UInt32      VertexShader;   // BuiltinShaders
+    UInt32      FragmentShader;
+    SInt32      Texture;        // -1 for none.
+};
+
+struct SceneFileMesh
+{
+    UInt32      PrimType;       // PrimitiveType
+    UInt32      VertexCount, VertexOffset;
+    UInt32      IndexCount,  IndexOffset;
+};
+
+struct SceneFileModel
+{
+    float       World[4][4];    // Matrix4f::M, row-major.
+    UInt32      Mesh;
+    SInt32      Material;       // -1 draws with the device's default fill.
+    UInt32      Flags;
+};
+
+struct SceneFileLight
+{
+    float       Position[4];
+    float       Color[4];
+};
+#pragma pack(pop)
+
+enum
+{
+    SceneFile_Version       = 1,
+    SceneFile_Alignment     = 16,
+    SceneFileModel_Hidden   = 1     // SceneFileModel::Flags
+};
+
+
+//-------------------------------------------------------------------------------------
+// ***** SceneFile
+
+// A scene file, mapped. Open() checks the header, that every table and blob lies
+// inside the file and that every index names one of its mesh's vertices; the
+// accessors then point straight into the mapping.
+//
+// Populate() adds the file's lights and models to a scene. Every mesh's vertex and
+// index buffers are created on the device directly from the mapped blobs, once,
+// and shared by all the models that use the mesh. RenderTiny draws a Model's
+// Indices and culls and instances by its Vertices, so each model also gets its
+// mesh's arrays, one block copy each. Nothing keeps the file in use afterwards;
+// close it, or Clear() the scene and populate it from another file to swap rooms.
+
+class SceneFile
+{
+public:
+    SceneFile();
+
+    bool        Open(const char* path);
+    void        Close();
+    bool        IsOpen() const                      { return pHeader != 0; }
+
+    void        Populate(Scene* scene, RenderDevice* render) const;
+
+    const SceneFileHeader&   GetHeader() const      { return *pHeader; }
+    const SceneFileTexture*  GetTextures() const    { return (const SceneFileTexture*)at(pHeader->TextureOffset); }
+    const SceneFileMaterial* GetMaterials() const   { return (const SceneFileMaterial*)at(pHeader->MaterialOffset); }
+    const SceneFileMesh*     GetMeshes() const      { return (const SceneFileMesh*)at(pHeader->MeshOffset); }
+    const SceneFileModel*    GetModels() const      { return (const SceneFileModel*)at(pHeader->ModelOffset); }
+    const SceneFileLight*    GetLights() const      { return (const SceneFileLight*)at(pHeader->LightOffset); }
+
+    const Vertex*   GetVertices(const SceneFileMesh& mesh) const { return (const Vertex*)at(mesh.VertexOffset); }
+    const UInt16*   GetIndices(const SceneFileMesh& mesh) const  { return (const UInt16*)at(mesh.IndexOffset); }
+    const void*     GetPixels(const SceneFileTexture& tex) const { return at(tex.DataOffset); }
+
+private:
+    const UByte*    at(UInt32 offset) const         { return File.GetData() + offset; }
+    bool            validate() const;
+    bool            inFile(UInt32 offset, UInt32 count, UPInt size) const;
+
+    MappedFile              File;
+    const SceneFileHeader*  pHeader;
+};
+
+
+//-------------------------------------------------------------------------------------
+// ***** SceneFileWriter
+
+// Exports a scene built in code. A Fill can't be read back, so what each one is
+// made of is registered first with AddMaterial(), and its texture's pixels with
+// AddTexture(); models with a fill that wasn't registered are written with the
+// default fill. Write() flattens the scene graph into models with world
+// transforms, and gives models with identical geometry one mesh. Models without
+// Vertices and Indices (buffers only) can't be written and are skipped.
+
+class SceneFileWriter
+{
+public:
+    SceneFileWriter();
+
+    // Returns the texture's index for AddMaterial. Pixels are RGBA, copied.
+    int         AddTexture(int format, int width, int height, const void* pixels);
+    void        AddMaterial(const Fill* fill, int vertexShader, int fragmentShader, int texture = -1);
+
+    bool        Write(const char* path, const Scene* scene);
+
+    // For the last Write().
+    unsigned    GetMeshCount() const                { return (unsigned)Meshes.GetSize(); }
+    unsigned    GetModelCount() const               { return (unsigned)Models.GetSize(); }
+    unsigned    GetSkippedCount() const             { return Skipped; }
+
+private:
+    struct ModelEntry
+    {
+        const Model*    pModel;
+        Matrix4f        World;
+        UInt32          Mesh;
+    };
+
+    void        addNode(const Node* node, const Matrix4f& parent);
+    UInt32      findMesh(const Model* model);
+
+    Array<SceneFileTexture>     Textures;
+    Array<UByte>                Pixels;
+    Array<const Fill*>          MaterialFills;
+    Array<SceneFileMaterial>    Materials;
+
+    // Write() state: each mesh's first model stands for its geometry.
+    Array<const Model*>         Meshes;
+    Array<UInt32>               MeshHashes;
+    Array<ModelEntry>           Models;
+    unsigned                    Skipped;
+};
+
+}} // OVR::RenderTiny
+
+#endif
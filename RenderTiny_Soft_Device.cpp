@@ -0,0 +1,1632 @@
+/************************************************************************************
+
+Filename    :   RenderTiny_Soft_Device.cpp
+Content     :   Multithreaded tile-based software RenderDevice
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "RenderTiny_Soft_Device.h"
+#include "Util_Trace.h"
+#include "../../LibOVR/Src/Kernel/OVR_Timer.h"
+#include "../../LibOVR/Src/Kernel/OVR_Log.h"
+
+#include <math.h>
+#include <string.h>
+
+#if defined(OVR_OS_WIN32)
+#include <Windows.h>
+#endif
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define SOFT_RASTER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace OVR { namespace RenderTiny { namespace Soft {
+
+static inline float clamp01(float v)
+{
+    return (v < 0) ? 0 : ((v > 1.0f) ? 1.0f : v);
+}
+
+static inline UInt32 packColor(const float c[4])
+{
+    return (UInt32(clamp01(c[3]) * 255.0f + 0.5f) << 24) |
+           (UInt32(clamp01(c[0]) * 255.0f + 0.5f) << 16) |
+           (UInt32(clamp01(c[1]) * 255.0f + 0.5f) << 8)  |
+            UInt32(clamp01(c[2]) * 255.0f + 0.5f);
+}
+
+static inline void unpackColor(UInt32 p, float c[4])
+{
+    const float scale = 1.0f / 255.0f;
+    c[0] = float((p >> 16) & 0xff) * scale;
+    c[1] = float((p >> 8) & 0xff) * scale;
+    c[2] = float(p & 0xff) * scale;
+    c[3] = float(p >> 24) * scale;
+}
+
+// a + (b - a) * t / 256 on each channel, two channels per multiply.
+static inline UInt32 lerpPixel(UInt32 a, UInt32 b, UInt32 t)
+{
+    UInt32 rb = (((a & 0x00ff00ff) * (256 - t) + (b & 0x00ff00ff) * t) >> 8) & 0x00ff00ff;
+    UInt32 ag = (((a >> 8) & 0x00ff00ff) * (256 - t) + ((b >> 8) & 0x00ff00ff) * t) & 0xff00ff00;
+    return rb | ag;
+}
+
+// m * (x, y, z, w).
+static inline void transform(const Matrix4f& m, float x, float y, float z, float w, float out[4])
+{
+    for (int i = 0; i < 4; i++)
+        out[i] = m.M[i][0] * x + m.M[i][1] * y + m.M[i][2] * z + m.M[i][3] * w;
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** Buffer
+
+Buffer::~Buffer()
+{
+    if (pData)
+        OVR_FREE(pData);
+}
+
+void* Buffer::Map(size_t start, size_t size, int flags)
+{
+    OVR_UNUSED(flags);
+    if (start + size > Size)
+        return NULL;
+    return pData + start;
+}
+
+bool Buffer::Unmap(void* m)
+{
+    OVR_UNUSED(m);
+    return true;
+}
+
+bool Buffer::Data(int use, const void* buffer, size_t size)
+{
+    if (size != Size)
+    {
+        if (pData)
+            OVR_FREE(pData);
+        pData = size ? (UByte*)OVR_ALLOC(size) : NULL;
+        Size  = size;
+    }
+    Use = use;
+    if (buffer && size)
+        memcpy(pData, buffer, size);
+    return true;
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** Texture
+
+Texture::Texture(RenderDevice* ren, int format, int width, int height)
+    : Ren(ren), Format(format), Width(width), Height(height),
+      Pitch((width + 3) & ~3), SampleMode(Sample_Linear), pPixels(NULL), pDepth(NULL)
+{
+    size_t count = size_t(Pitch) * size_t(Height);
+    if (IsDepth())
+    {
+        pDepth = (float*)OVR_ALLOC_ALIGNED(count * sizeof(float), 16);
+        for (size_t i = 0; i < count; i++)
+            pDepth[i] = 1.0f;
+    }
+    else
+    {
+        pPixels = (UInt32*)OVR_ALLOC_ALIGNED(count * sizeof(UInt32), 16);
+        memset(pPixels, 0, count * sizeof(UInt32));
+    }
+}
+
+Texture::~Texture()
+{
+    if (pPixels)
+        OVR_FREE_ALIGNED(pPixels);
+    if (pDepth)
+        OVR_FREE_ALIGNED(pDepth);
+    for (UPInt i = 0; i < Mips.GetSize(); i++)
+        OVR_FREE_ALIGNED(Mips[i].pPixels);
+}
+
+void Texture::Set(int slot, ShaderStage stage) const
+{
+    OVR_UNUSED(stage);
+    Ren->setTexture(slot, this);
+}
+
+void Texture::SetPixels(const void* rgba)
+{
+    if (!pPixels)
+        return;
+    const UByte* src = (const UByte*)rgba;
+    for (int y = 0; y < Height; y++)
+    {
+        UInt32* row = pPixels + y * Pitch;
+        for (int x = 0; x < Width; x++, src += 4)
+            row[x] = (UInt32(src[3]) << 24) | (UInt32(src[0]) << 16) | (UInt32(src[1]) << 8) | src[2];
+    }
+
+    for (UPInt i = 0; i < Mips.GetSize(); i++)
+        OVR_FREE_ALIGNED(Mips[i].pPixels);
+    Mips.Clear();
+    if (!(Format & Texture_GenMipmaps))
+        return;
+
+    // Each level is a 2x2 box filter of the one above; odd edges repeat their last
+    // texel.
+    MipLevel above = { pPixels, Width, Height, Pitch };
+    while (above.Width > 1 || above.Height > 1)
+    {
+        MipLevel level;
+        level.Width   = (above.Width  > 1) ? above.Width  / 2 : 1;
+        level.Height  = (above.Height > 1) ? above.Height / 2 : 1;
+        level.Pitch   = (level.Width + 3) & ~3;
+        level.pPixels = (UInt32*)OVR_ALLOC_ALIGNED(size_t(level.Pitch) * level.Height * sizeof(UInt32), 16);
+
+        for (int y = 0; y < level.Height; y++)
+        {
+            const UInt32* row0 = above.pPixels + (2 * y) * above.Pitch;
+            const UInt32* row1 = (2 * y + 1 < above.Height) ? row0 + above.Pitch : row0;
+            for (int x = 0; x < level.Width; x++)
+            {
+                int x0 = 2 * x, x1 = (x0 + 1 < above.Width) ? x0 + 1 : x0;
+                level.pPixels[y * level.Pitch + x] =
+                    lerpPixel(lerpPixel(row0[x0], row0[x1], 128), lerpPixel(row1[x0], row1[x1], 128), 128);
+            }
+        }
+        Mips.PushBack(level);
+        above = level;
+    }
+}
+
+void Texture::Sample(float u, float v, float footprint, float rgba[4]) const
+{
+    if (!pPixels)
+    {
+        rgba[0] = rgba[1] = rgba[2] = rgba[3] = 1.0f;
+        return;
+    }
+
+    MipLevel top = { pPixels, Width, Height, Pitch };
+    if (Mips.GetSize() == 0 || footprint <= 0)
+    {
+        sampleLevel(top, u, v, rgba);
+        return;
+    }
+
+    // Nearest level whose texels are about one pixel across: LOD = log2 of the
+    // footprint in top-level texels, rounded.
+    float texels = footprint * float((Width > Height) ? Width : Height);
+    int   lod    = 0;
+    for (float size = 1.4142136f; size < texels && lod < (int)Mips.GetSize(); size *= 2.0f)
+        lod++;
+    sampleLevel(lod ? Mips[lod - 1] : top, u, v, rgba);
+}
+
+void Texture::sampleLevel(const MipLevel& level, float u, float v, float rgba[4]) const
+{
+    const int     width  = level.Width;
+    const int     height = level.Height;
+    const UInt32* pixels = level.pPixels;
+
+    bool  clamp = (SampleMode & Sample_AddressMask) != Sample_Repeat;
+    float x     = u * width;
+    float y     = v * height;
+
+    if ((SampleMode & Sample_FilterMask) == Sample_Nearest)
+    {
+        int ix = int(floorf(x)), iy = int(floorf(y));
+        if (clamp)
+        {
+            ix = (ix < 0) ? 0 : ((ix >= width) ? width - 1 : ix);
+            iy = (iy < 0) ? 0 : ((iy >= height) ? height - 1 : iy);
+        }
+        else
+        {
+            ix %= width;  if (ix < 0) ix += width;
+            iy %= height; if (iy < 0) iy += height;
+        }
+        unpackColor(pixels[iy * level.Pitch + ix], rgba);
+        return;
+    }
+
+    // Bilinear between the four texel centers around (x, y), in 8-bit fixed point.
+    x -= 0.5f;
+    y -= 0.5f;
+    float fx = floorf(x), fy = floorf(y);
+    int   x0 = int(fx), y0 = int(fy), x1 = x0 + 1, y1 = y0 + 1;
+    UInt32 tx = UInt32((x - fx) * 256.0f);
+    UInt32 ty = UInt32((y - fy) * 256.0f);
+
+    if (x0 < 0 || y0 < 0 || x1 >= width || y1 >= height)
+    {
+        if (clamp)
+        {
+            x0 = (x0 < 0) ? 0 : ((x0 >= width)  ? width - 1  : x0);
+            x1 = (x1 < 0) ? 0 : ((x1 >= width)  ? width - 1  : x1);
+            y0 = (y0 < 0) ? 0 : ((y0 >= height) ? height - 1 : y0);
+            y1 = (y1 < 0) ? 0 : ((y1 >= height) ? height - 1 : y1);
+        }
+        else
+        {
+            x0 %= width;  if (x0 < 0) x0 += width;
+            x1 %= width;  if (x1 < 0) x1 += width;
+            y0 %= height; if (y0 < 0) y0 += height;
+            y1 %= height; if (y1 < 0) y1 += height;
+        }
+    }
+
+    const UInt32* row0 = pixels + y0 * level.Pitch;
+    const UInt32* row1 = pixels + y1 * level.Pitch;
+    UInt32 top    = lerpPixel(row0[x0], row0[x1], tx);
+    UInt32 bottom = lerpPixel(row1[x0], row1[x1], tx);
+    unpackColor(lerpPixel(top, bottom, ty), rgba);
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** Shader
+
+void Shader::Set(PrimitiveType prim) const
+{
+    OVR_UNUSED(prim);
+    Ren->setShader(this);
+}
+
+bool Shader::SetUniform(const char* name, int n, const float* v)
+{
+    if (n > 16)
+        n = 16;
+
+    Uniform* uniform = NULL;
+    for (UPInt i = 0; i < Uniforms.GetSize(); i++)
+        if (Uniforms[i].Name == name)
+            uniform = &Uniforms[i];
+    if (!uniform)
+    {
+        Uniforms.PushBack(Uniform());
+        uniform = &Uniforms.Back();
+        uniform->Name = name;
+    }
+
+    memset(uniform->V, 0, sizeof(uniform->V));
+    memcpy(uniform->V, v, n * sizeof(float));
+    Ren->invalidateState();
+    return true;
+}
+
+bool Shader::GetUniform(const char* name, float* v, int n) const
+{
+    for (UPInt i = 0; i < Uniforms.GetSize(); i++)
+        if (Uniforms[i].Name == name)
+        {
+            memcpy(v, Uniforms[i].V, n * sizeof(float));
+            return true;
+        }
+    return false;
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** RenderDevice
+
+RenderDevice::RenderDevice(const RendererParams& p, void* oswnd, int width, int height)
+    : hWnd(oswnd), pTarget(NULL), pTargetDepth(NULL),
+      pVertexShader(NULL), pPixelShader(NULL), pBoundTexture(NULL),
+      DepthEnable(false), DepthWrite(false), DepthFunc(Compare_Less), CurrentLighting(-1),
+      StateVersion(0), LastDrawState(~UPInt(0)), LastDrawVersion(0),
+      StereoActive(false), StereoPostProcess(PostProcess_None), DistortionMeshGrid(0),
+      StateCount(0), LightingCount(0), TriangleCount(0), TilesX(0), TilesY(0),
+      WorkerCount(0), WorkersStarted(0), JobGeneration(0), WorkersBusy(0), Exiting(false)
+{
+    Params        = p;
+    WindowWidth   = width;
+    WindowHeight  = height;
+    memset(&Light, 0, sizeof(Light));
+    NextTile      = 0;
+
+    pFrame        = *new Texture(this, Texture_RGBA | Texture_RenderTarget, width, height);
+    pFrameDepth   = *new Texture(this, Texture_Depth, width, height);
+    pTarget       = pFrame;
+    pTargetDepth  = pFrameDepth;
+    RasterVP      = Viewport(0, 0, width, height);
+    allocateBins();
+
+    // The calling thread rasterizes too, so one worker fewer than there are CPUs.
+    int cpus    = Thread::GetCPUCount();
+    WorkerCount = (cpus > 1) ? unsigned(cpus - 1) : 0;
+    if (WorkerCount > MaxRasterThreads)
+        WorkerCount = MaxRasterThreads;
+    for (unsigned i = 0; i < WorkerCount; i++)
+    {
+        Workers[i] = *new Thread(&workerThreadFn, this);
+        Workers[i]->Start();
+    }
+
+    DefaultFill = *CreateSimpleFill();
+}
+
+RenderDevice::~RenderDevice()
+{
+    Shutdown();
+}
+
+RenderDevice* RenderDevice::CreateDevice(const RendererParams& rp, void* oswnd)
+{
+    int width = 0, height = 0;
+#if defined(OVR_OS_WIN32)
+    RECT rc;
+    if (oswnd && GetClientRect((HWND)oswnd, &rc))
+    {
+        width  = rc.right - rc.left;
+        height = rc.bottom - rc.top;
+    }
+#endif
+    if (width <= 0 || height <= 0)
+        return NULL;
+    return new RenderDevice(rp, oswnd, width, height);
+}
+
+RenderDevice* RenderDevice::CreateOffscreenDevice(const RendererParams& rp, int width, int height)
+{
+    if (width <= 0 || height <= 0)
+        return NULL;
+    return new RenderDevice(rp, NULL, width, height);
+}
+
+void RenderDevice::Shutdown()
+{
+    if (WorkerCount)
+    {
+        {
+            Mutex::Locker lock(&JobLock);
+            Exiting = true;
+            JobChanged.NotifyAll();
+        }
+        for (unsigned i = 0; i < WorkerCount; i++)
+        {
+            while (!Workers[i]->IsFinished())
+                Thread::MSleep(1);
+            Workers[i].Clear();
+        }
+        WorkerCount = 0;
+    }
+}
+
+Buffer* RenderDevice::CreateBuffer()
+{
+    return new Buffer;
+}
+
+Texture* RenderDevice::CreateTexture(int format, int width, int height, const void* data, int mipcount)
+{
+    OVR_UNUSED(mipcount);
+    if (width <= 0 || height <= 0)
+        return NULL;
+
+    Texture* texture = new Texture(this, format, width, height);
+    if (data && (format & Texture_TypeMask) == Texture_RGBA)
+        texture->SetPixels(data);
+    return texture;
+}
+
+Shader* RenderDevice::LoadBuiltinShader(ShaderStage stage, int shader)
+{
+    return new Shader(this, stage, shader);
+}
+
+Fill* RenderDevice::CreateSimpleFill()
+{
+    Ptr<ShaderSet> shaders = *CreateShaderSet();
+    Ptr<Shader>    vs      = *LoadBuiltinShader(Shader_Vertex, VShader_MVP);
+    Ptr<Shader>    ps      = *LoadBuiltinShader(Shader_Fragment, FShader_Gouraud);
+    shaders->SetShader(vs);
+    shaders->SetShader(ps);
+    return new ShaderFill(shaders);
+}
+
+void RenderDevice::setShader(const Shader* shader)
+{
+    if (shader->GetStage() == Shader_Vertex && pVertexShader != shader)
+    {
+        pVertexShader = shader;
+        invalidateState();
+    }
+    else if (shader->GetStage() == Shader_Fragment && pPixelShader != shader)
+    {
+        pPixelShader = shader;
+        invalidateState();
+    }
+}
+
+void RenderDevice::setTexture(int slot, const Texture* texture)
+{
+    // The builtin shaders only sample slot 0.
+    if (slot == 0 && pBoundTexture != texture)
+    {
+        pBoundTexture = texture;
+        invalidateState();
+    }
+}
+
+void RenderDevice::SetRealViewport(const Viewport& vp)
+{
+    RasterVP = vp;
+}
+
+void RenderDevice::getScissor(int* x0, int* y0, int* x1, int* y1) const
+{
+    *x0 = (RasterVP.x > 0) ? RasterVP.x : 0;
+    *y0 = (RasterVP.y > 0) ? RasterVP.y : 0;
+    *x1 = RasterVP.x + RasterVP.w - 1;
+    *y1 = RasterVP.y + RasterVP.h - 1;
+    if (*x1 >= pTarget->GetWidth())
+        *x1 = pTarget->GetWidth() - 1;
+    if (*y1 >= pTarget->GetHeight())
+        *y1 = pTarget->GetHeight() - 1;
+}
+
+void RenderDevice::SetRenderTarget(RenderTiny::Texture* color, RenderTiny::Texture* depth, RenderTiny::Texture* stencil)
+{
+    OVR_UNUSED(stencil);
+
+    Texture* target      = color ? (Texture*)color : pFrame.GetPtr();
+    Texture* targetDepth = (Texture*)depth;
+    if (!targetDepth)
+    {
+        if (!color)
+            targetDepth = pFrameDepth;
+        else
+        {
+            if (!pSceneDepth ||
+                pSceneDepth->GetWidth() < target->GetWidth() || pSceneDepth->GetHeight() < target->GetHeight())
+            {
+                Flush();
+                pSceneDepth = *new Texture(this, Texture_Depth, target->GetWidth(), target->GetHeight());
+            }
+            targetDepth = pSceneDepth;
+        }
+    }
+
+    if (target == pTarget && targetDepth == pTargetDepth)
+        return;
+
+    // Bins are per target, so whatever was drawn to the old one is resolved now.
+    Flush();
+    pTarget      = target;
+    pTargetDepth = targetDepth;
+    allocateBins();
+}
+
+void RenderDevice::SetDepthMode(bool enable, bool write, CompareFunc func)
+{
+    if (enable == DepthEnable && write == DepthWrite && func == DepthFunc)
+        return;
+    DepthEnable = enable;
+    DepthWrite  = write;
+    DepthFunc   = func;
+    invalidateState();
+}
+
+void RenderDevice::SetWorldUniforms(const Matrix4f& proj)
+{
+    WorldProj = proj;
+}
+
+void RenderDevice::SetLighting(const LightingParams* light)
+{
+    if (!light)
+        return;
+
+    Light.Ambient[0] = light->Ambient.x;
+    Light.Ambient[1] = light->Ambient.y;
+    Light.Ambient[2] = light->Ambient.z;
+    Light.Count      = int(light->LightCount);
+    if (Light.Count > 8)
+        Light.Count = 8;
+    for (int i = 0; i < Light.Count; i++)
+    {
+        Light.Pos[i][0]   = light->LightPos[i].x;
+        Light.Pos[i][1]   = light->LightPos[i].y;
+        Light.Pos[i][2]   = light->LightPos[i].z;
+        Light.Color[i][0] = light->LightColor[i].x;
+        Light.Color[i][1] = light->LightColor[i].y;
+        Light.Color[i][2] = light->LightColor[i].z;
+    }
+    CurrentLighting = -1;
+    invalidateState();
+}
+
+void RenderDevice::allocateBins()
+{
+    TilesX = (pTarget->GetWidth() + TileSize - 1) / TileSize;
+    TilesY = (pTarget->GetHeight() + TileSize - 1) / TileSize;
+    if (Bins.GetSize() < UPInt(TilesX * TilesY))
+        Bins.Resize(TilesX * TilesY);
+    for (UPInt i = 0; i < Bins.GetSize(); i++)
+        Bins[i].Count = 0;
+}
+
+RenderDevice::DrawState& RenderDevice::newState()
+{
+    if (StateCount == States.GetSize())
+        States.PushBack(DrawState());
+    DrawState& state = States[StateCount++];
+    state.Lighting   = -1;
+    return state;
+}
+
+RenderDevice::RasterTriangle& RenderDevice::newTriangle()
+{
+    if (TriangleCount == Triangles.GetSize())
+        Triangles.Resize(TriangleCount + 1);
+    return Triangles[TriangleCount++];
+}
+
+void RenderDevice::binToTiles(UInt32 index)
+{
+    const RasterTriangle& tri = Triangles[index];
+    int tx0 = tri.MinX / TileSize, tx1 = tri.MaxX / TileSize;
+    int ty0 = tri.MinY / TileSize, ty1 = tri.MaxY / TileSize;
+
+    for (int ty = ty0; ty <= ty1; ty++)
+        for (int tx = tx0; tx <= tx1; tx++)
+        {
+            TileBin& bin = Bins[ty * TilesX + tx];
+            if (bin.Count == bin.Entries.GetSize())
+                bin.Entries.PushBack(index);
+            else
+                bin.Entries[bin.Count] = index;
+            bin.Count++;
+        }
+    FrameStats.BinEntries += UInt32((tx1 - tx0 + 1) * (ty1 - ty0 + 1));
+}
+
+void RenderDevice::Clear(float r, float g, float b, float a, float depth)
+{
+    if (!StereoActive)
+    {
+        binClear(r, g, b, a, depth);
+        return;
+    }
+
+    Viewport vp = RasterVP;
+    for (int eye = 0; eye < 2; eye++)
+    {
+        RasterVP = StereoVP[eye];
+        binClear(r, g, b, a, depth);
+    }
+    RasterVP = vp;
+}
+
+void RenderDevice::binClear(float r, float g, float b, float a, float depth)
+{
+    int x0, y0, x1, y1;
+    getScissor(&x0, &y0, &x1, &y1);
+    if (x1 < x0 || y1 < y0)
+        return;
+
+    const float color[4] = { r, g, b, a };
+    DrawState&  state    = newState();
+    state.PixelShader    = PixelShader_Clear;
+    state.Mipmapped      = false;
+    state.pTexture.Clear();
+    state.ClearColor     = packColor(color);
+    state.ClearDepth     = depth;
+
+    RasterTriangle& clear = newTriangle();
+    clear.State = UInt32(StateCount - 1);
+    clear.MinX  = x0;
+    clear.MinY  = y0;
+    clear.MaxX  = x1;
+    clear.MaxY  = y1;
+    binToTiles(UInt32(TriangleCount - 1));
+}
+
+void RenderDevice::Render(const Matrix4f& matrix, Model* model)
+{
+    RenderInstances(&matrix, 1, model);
+}
+
+void RenderDevice::RenderInstances(const Matrix4f* matrices, unsigned instanceCount, Model* model)
+{
+    // Buffers are created on first use, as the D3D device does.
+    if (!model->VertexBuffer)
+    {
+        Ptr<Buffer> vb = *CreateBuffer();
+        vb->Data(Buffer_Vertex, &model->Vertices[0], model->Vertices.GetSize() * sizeof(Vertex));
+        model->VertexBuffer = vb.GetPtr();
+    }
+    if (!model->IndexBuffer)
+    {
+        Ptr<Buffer> ib = *CreateBuffer();
+        ib->Data(Buffer_Index, &model->Indices[0], model->Indices.GetSize() * 2);
+        model->IndexBuffer = ib.GetPtr();
+    }
+
+    renderInstances(model->Fill ? (const Fill*)model->Fill : (const Fill*)DefaultFill,
+                    model->VertexBuffer, model->IndexBuffer, matrices, instanceCount,
+                    0, (int)model->Indices.GetSize(), model->GetPrimType());
+}
+
+void RenderDevice::Render(const Fill* fill, RenderTiny::Buffer* vertices, RenderTiny::Buffer* indices,
+                          const Matrix4f& matrix, int offset, int count, PrimitiveType prim)
+{
+    renderInstances(fill, vertices, indices, &matrix, 1, offset, count, prim);
+}
+
+void RenderDevice::renderInstances(const Fill* fill, RenderTiny::Buffer* vertices, RenderTiny::Buffer* indices,
+                                   const Matrix4f* matrices, unsigned instanceCount,
+                                   int offset, int count, PrimitiveType prim)
+{
+    // Lines are not rasterized; nothing in the room is drawn with them.
+    if (prim != Prim_Triangles && prim != Prim_TriangleStrip)
+        return;
+
+    fill->Set(prim);
+    if (!pVertexShader || !pPixelShader || !vertices || count < 3 || !instanceCount)
+        return;
+
+    FrameStats.Draws++;
+
+    // Indexed draws offset the index buffer, others the vertex buffer, in bytes.
+    const UByte*   vertexData  = ((Buffer*)vertices)->GetData();
+    UPInt          vertexCount = vertices->GetSize() / sizeof(Vertex);
+    const UInt16*  index       = NULL;
+    if (indices)
+    {
+        if (UPInt(offset) + UPInt(count) * sizeof(UInt16) > indices->GetSize())
+            return;
+        index = (const UInt16*)(((Buffer*)indices)->GetData() + offset);
+    }
+    else
+    {
+        vertexData  += offset;
+        vertexCount  = (vertices->GetSize() - offset) / sizeof(Vertex);
+    }
+    const Vertex* vertex = (const Vertex*)vertexData;
+
+    unsigned first = 0, last = unsigned(count - 1);
+    if (index)
+    {
+        first = last = index[0];
+        for (int i = 1; i < count; i++)
+        {
+            if (index[i] < first) first = index[i];
+            if (index[i] > last)  last  = index[i];
+        }
+    }
+    if (last >= vertexCount)
+        return;
+
+    // One snapshot serves every instance, and both eyes.
+    UInt32 stateIndex = drawState();
+
+    // In single-pass stereo every vertex is transformed for each eye, and eye
+    // 'eye' of vertex i lands in Shaded[eye * span + i - first].
+    int      vs   = pVertexShader->GetBuiltin();
+    int      eyes = (StereoActive && vs != VShader_PostProcess) ? 2 : 1;
+    UPInt    span = last - first + 1;
+    Matrix4f texm;
+    if (vs == VShader_PostProcess)
+    {
+        // Uniform matrices arrive transposed.
+        float t[16];
+        if (pVertexShader->GetUniform("Texm", t, 16))
+            for (int i = 0; i < 4; i++)
+                for (int j = 0; j < 4; j++)
+                    texm.M[i][j] = t[j * 4 + i];
+    }
+
+    if (Shaded.GetSize() < span * eyes)
+        Shaded.Resize(span * eyes);
+
+    // Instances are drawn one after another, each binned before the next is
+    // shaded into the same vertices.
+    for (unsigned instance = 0; instance < instanceCount; instance++)
+    {
+        // *** Vertex stage
+
+        const Matrix4f& matrix = matrices[instance];
+        Matrix4f        mvp[2];
+        if (vs == VShader_MV)
+        {
+            // Positions are already in clip space once 'matrix' is applied.
+            mvp[0] = mvp[1] = matrix;
+        }
+        else if (eyes > 1)
+        {
+            mvp[0] = StereoProj[0] * matrix;
+            mvp[1] = StereoProj[1] * matrix;
+        }
+        else
+            mvp[0] = WorldProj * matrix;
+
+        const float colorScale = 1.0f / 255.0f;
+        for (unsigned i = first; i <= last; i++)
+        {
+            const Vertex& v   = vertex[i];
+            ShadedVertex& out = Shaded[i - first];
+            float*        var = out.Varyings;
+
+            var[2] = v.C.R * colorScale;
+            var[3] = v.C.G * colorScale;
+            var[4] = v.C.B * colorScale;
+            var[5] = v.C.A * colorScale;
+
+            if (vs == VShader_PostProcess)
+            {
+                transform(matrix, v.Pos.x, v.Pos.y, v.Pos.z, 1.0f, out.Clip);
+                float tc[4];
+                transform(texm, v.U, v.V, 0, 1.0f, tc);
+                var[0] = tc[0];
+                var[1] = tc[1];
+                var[6] = var[7] = var[8] = var[9] = var[10] = var[11] = 0;
+            }
+            else
+            {
+                transform(mvp[0], v.Pos.x, v.Pos.y, v.Pos.z, 1.0f, out.Clip);
+                var[0] = v.U;
+                var[1] = v.V;
+                float p[4], n[4];
+                transform(matrix, v.Pos.x, v.Pos.y, v.Pos.z, 1.0f, p);
+                transform(matrix, v.Norm.x, v.Norm.y, v.Norm.z, 0, n);
+                var[6]  = p[0]; var[7]  = p[1]; var[8]  = p[2];
+                var[9]  = n[0]; var[10] = n[1]; var[11] = n[2];
+
+                // The other eye differs only in position; lighting is in the center
+                // view's space, which ViewAdjust only translates.
+                if (eyes > 1)
+                {
+                    ShadedVertex& right = Shaded[span + i - first];
+                    memcpy(right.Varyings, var, sizeof(right.Varyings));
+                    transform(mvp[1], v.Pos.x, v.Pos.y, v.Pos.z, 1.0f, right.Clip);
+                }
+            }
+        }
+
+        // *** Primitive assembly
+
+        // Both eyes share the state; each bins into its own viewport.
+        int      step = (prim == Prim_Triangles) ? 3 : 1;
+        Viewport vp   = RasterVP;
+        for (int eye = 0; eye < eyes; eye++)
+        {
+            const ShadedVertex* shaded = &Shaded[eye * span];
+            if (eyes > 1)
+                RasterVP = StereoVP[eye];
+
+            for (int i = 0; i + 2 < count; i += step)
+            {
+                // Odd strip triangles swap their first two vertices to keep the winding.
+                int      odd = (prim == Prim_TriangleStrip) ? (i & 1) : 0;
+                unsigned i0  = index ? index[i + odd]     : unsigned(i + odd);
+                unsigned i1  = index ? index[i + 1 - odd] : unsigned(i + 1 - odd);
+                unsigned i2  = index ? index[i + 2]       : unsigned(i + 2);
+                clipAndBin(shaded[i0 - first], shaded[i1 - first], shaded[i2 - first], stateIndex);
+                FrameStats.Triangles++;
+            }
+        }
+        RasterVP = vp;
+    }
+}
+
+UInt32 RenderDevice::drawState()
+{
+    // Fills bind their shaders and textures on every draw; if that, and everything
+    // else, left the state as the last draw had it, so is its snapshot.
+    if (LastDrawState < StateCount && LastDrawVersion == StateVersion)
+        return UInt32(LastDrawState);
+
+    DrawState& state = newState();
+    state.PixelShader = pPixelShader->GetBuiltin();
+    state.pTexture    = const_cast<Texture*>(pBoundTexture);
+    state.DepthEnable = DepthEnable;
+    state.DepthWrite  = DepthWrite;
+    state.DepthFunc   = DepthFunc;
+
+    // Only what the pixel shader reads is interpolated per pixel.
+    switch (state.PixelShader)
+    {
+    case FShader_Solid:                 state.Varyings = 0; break;
+    case FShader_PostProcess:
+    case FShader_PostProcessWithChromAb:state.Varyings = 2; break;
+    case FShader_Gouraud:
+    case FShader_Texture:               state.Varyings = 6; break;
+    default:                            state.Varyings = VaryingCount; break;
+    }
+    state.Mipmapped = state.pTexture && state.pTexture->HasMipmaps() &&
+                      (state.PixelShader == FShader_Texture || state.PixelShader == FShader_LitTexture);
+
+    state.SolidColor[0] = state.SolidColor[1] = state.SolidColor[2] = state.SolidColor[3] = 1.0f;
+    if (state.PixelShader == FShader_Solid)
+        pPixelShader->GetUniform("Color", state.SolidColor, 4);
+
+    if (state.PixelShader == FShader_PostProcess || state.PixelShader == FShader_PostProcessWithChromAb)
+    {
+        memset(state.Distortion, 0, sizeof(state.Distortion));
+        pPixelShader->GetUniform("LensCenter",   state.Distortion + 0, 2);
+        pPixelShader->GetUniform("ScreenCenter", state.Distortion + 2, 2);
+        pPixelShader->GetUniform("Scale",        state.Distortion + 4, 2);
+        pPixelShader->GetUniform("ScaleIn",      state.Distortion + 6, 2);
+        pPixelShader->GetUniform("HmdWarpParam", state.Distortion + 8, 4);
+        pPixelShader->GetUniform("ChromAbParam", state.Distortion + 12, 4);
+    }
+
+    if (state.PixelShader == FShader_LitGouraud || state.PixelShader == FShader_LitTexture)
+    {
+        if (CurrentLighting < 0)
+        {
+            if (LightingCount == Lightings.GetSize())
+                Lightings.PushBack(Light);
+            else
+                Lightings[LightingCount] = Light;
+            CurrentLighting = int(LightingCount++);
+        }
+        state.Lighting = CurrentLighting;
+    }
+
+    FrameStats.States++;
+    LastDrawState   = StateCount - 1;
+    LastDrawVersion = StateVersion;
+    return UInt32(LastDrawState);
+}
+
+void RenderDevice::BeginStereoScene(PostProcessType pp, const StereoEyeParams& left,
+                                    const StereoEyeParams& right)
+{
+    BeginScene(pp);
+    StereoPostProcess = CurPostProcess;
+    StereoEyes[0]     = left;
+    StereoEyes[1]     = right;
+
+    // ApplyStereoParams scales each viewport to the scene target as it would for
+    // a single eye.
+    for (int eye = 0; eye < 2; eye++)
+    {
+        ApplyStereoParams(StereoEyes[eye]);
+        StereoVP[eye]   = RasterVP;
+        StereoProj[eye] = StereoEyes[eye].Projection * StereoEyes[eye].ViewAdjust;
+    }
+    StereoActive = true;
+}
+
+void RenderDevice::FinishStereoScene()
+{
+    StereoActive = false;
+
+    // FinishScene resolves the scene target on the first eye and ends the post
+    // process; each eye gets its own distortion pass from the same target.
+    for (int eye = 0; eye < 2; eye++)
+    {
+        CurPostProcess = StereoPostProcess;
+        ApplyStereoParams(StereoEyes[eye]);
+        FinishScene();
+    }
+}
+
+void RenderDevice::FinishScene()
+{
+    if (!DistortionMeshGrid || CurPostProcess != PostProcess_Distortion)
+    {
+        RenderTiny::RenderDevice::FinishScene();
+        return;
+    }
+
+    // As FinishScene1 does it, with the eye's mesh in place of the full-screen quad.
+    SetRenderTarget(0);
+    SetRealViewport(VP);
+    Clear(0.0f, 0.0f, 0.0f, 1.0f);
+
+    DistortionMeshParams params = DistortionMeshParams::FromConfig(Distortion, VP, WindowWidth, WindowHeight);
+    DistortionMesh&      mesh   = EyeMeshes[(VP.x + VP.w / 2 > WindowWidth / 2) ? 1 : 0];
+    mesh.Update(params, DistortionMeshGrid);
+    renderDistortionMesh(mesh, GetPostProcessShader() == PostProcessShader_DistortionAndChromAb);
+
+    CurPostProcess = PostProcess_None;
+}
+
+void RenderDevice::renderDistortionMesh(const DistortionMesh& mesh, bool chromAb)
+{
+    const Array<DistortionMesh::Vertex>& vertices = mesh.GetVertices();
+    const Array<UInt16>&                 indices  = mesh.GetIndices();
+
+    if (Shaded.GetSize() < vertices.GetSize())
+        Shaded.Resize(vertices.GetSize());
+    for (UPInt i = 0; i < vertices.GetSize(); i++)
+    {
+        const DistortionMesh::Vertex& v   = vertices[i];
+        ShadedVertex&                 out = Shaded[i];
+        out.Clip[0]     = v.X;
+        out.Clip[1]     = v.Y;
+        out.Clip[2]     = 0;
+        out.Clip[3]     = 1.0f;
+        out.Varyings[0] = v.TexG[0]; out.Varyings[1] = v.TexG[1];
+        out.Varyings[2] = v.TexR[0]; out.Varyings[3] = v.TexR[1];
+        out.Varyings[4] = v.TexB[0]; out.Varyings[5] = v.TexB[1];
+    }
+
+    DrawState& state = newState();
+    state.PixelShader = chromAb ? PixelShader_DistortionMeshWithChromAb : PixelShader_DistortionMesh;
+    state.Varyings    = chromAb ? 6 : 2;
+    state.Mipmapped   = false;
+    state.pTexture    = (Texture*)pSceneColorTex.GetPtr();
+    state.DepthEnable = false;
+    state.DepthWrite  = false;
+    state.DepthFunc   = Compare_Less;
+    memset(state.Distortion, 0, sizeof(state.Distortion));
+    state.Distortion[2] = mesh.GetParams().ScreenCenter[0];
+    state.Distortion[3] = mesh.GetParams().ScreenCenter[1];
+    FrameStats.Draws++;
+
+    UInt32 stateIndex = UInt32(StateCount - 1);
+    for (UPInt i = 0; i + 2 < indices.GetSize(); i += 3)
+    {
+        binTriangle(Shaded[indices[i]], Shaded[indices[i + 1]], Shaded[indices[i + 2]], stateIndex);
+        FrameStats.Triangles++;
+    }
+}
+
+// Signed distance of a clip-space position from clip plane 'plane'; inside is >= 0.
+// Plane 0 is D3D's near plane, z = 0; the rest are a guard band GuardBand viewports
+// wide, which keeps window coordinates small enough for float edge functions.
+static inline float clipDistance(const float* clip, int plane)
+{
+    const float GuardBand = 4.0f;
+    switch (plane)
+    {
+    case 0:  return clip[2];
+    case 1:  return GuardBand * clip[3] - clip[0];
+    case 2:  return GuardBand * clip[3] + clip[0];
+    case 3:  return GuardBand * clip[3] - clip[1];
+    default: return GuardBand * clip[3] + clip[1];
+    }
+}
+
+void RenderDevice::clipAndBin(const ShadedVertex& v0, const ShadedVertex& v1,
+                              const ShadedVertex& v2, UInt32 state)
+{
+    enum { PlaneCount = 5, MaxVertices = 3 + PlaneCount };
+
+    const ShadedVertex* in[3] = { &v0, &v1, &v2 };
+    unsigned outside[3]  = { 0, 0, 0 };
+    for (int i = 0; i < 3; i++)
+        for (int plane = 0; plane < PlaneCount; plane++)
+            if (clipDistance(in[i]->Clip, plane) < 0)
+                outside[i] |= 1 << plane;
+
+    if (!(outside[0] | outside[1] | outside[2]))
+    {
+        binTriangle(v0, v1, v2, state);
+        return;
+    }
+    if (outside[0] & outside[1] & outside[2])
+        return;
+
+    // Each plane crossed can add a vertex to the polygon.
+    ShadedVertex buffers[2][MaxVertices];
+    ShadedVertex* polygon = buffers[0];
+    ShadedVertex* clipped = buffers[1];
+    int           count   = 3;
+    for (int i = 0; i < 3; i++)
+        polygon[i] = *in[i];
+
+    unsigned crossed = outside[0] | outside[1] | outside[2];
+    for (int plane = 0; plane < PlaneCount && count >= 3; plane++)
+    {
+        if (!(crossed & (1 << plane)))
+            continue;
+
+        int clippedCount = 0;
+        for (int i = 0; i < count; i++)
+        {
+            const ShadedVertex& a = polygon[i];
+            const ShadedVertex& b = polygon[(i + 1) % count];
+            float da = clipDistance(a.Clip, plane);
+            float db = clipDistance(b.Clip, plane);
+
+            if (da >= 0)
+                clipped[clippedCount++] = a;
+            if ((da >= 0) != (db >= 0))
+            {
+                float         t = da / (da - db);
+                ShadedVertex& v = clipped[clippedCount++];
+                for (int k = 0; k < 4; k++)
+                    v.Clip[k] = a.Clip[k] + (b.Clip[k] - a.Clip[k]) * t;
+                for (int k = 0; k < VaryingCount; k++)
+                    v.Varyings[k] = a.Varyings[k] + (b.Varyings[k] - a.Varyings[k]) * t;
+            }
+        }
+
+        ShadedVertex* swap = polygon;
+        polygon = clipped;
+        clipped = swap;
+        count   = clippedCount;
+    }
+
+    for (int i = 2; i < count; i++)
+        binTriangle(polygon[0], polygon[i - 1], polygon[i], state);
+}
+
+void RenderDevice::binTriangle(const ShadedVertex& v0, const ShadedVertex& v1,
+                               const ShadedVertex& v2, UInt32 state)
+{
+    const ShadedVertex* v[3] = { &v0, &v1, &v2 };
+    float x[3], y[3], z[3], invW[3];
+
+    for (int i = 0; i < 3; i++)
+    {
+        if (v[i]->Clip[3] <= 0)
+            return;
+        invW[i] = 1.0f / v[i]->Clip[3];
+        x[i]    = RasterVP.x + (v[i]->Clip[0] * invW[i] + 1.0f) * 0.5f * RasterVP.w;
+        y[i]    = RasterVP.y + (1.0f - v[i]->Clip[1] * invW[i]) * 0.5f * RasterVP.h;
+        z[i]    = v[i]->Clip[2] * invW[i];
+    }
+
+    // Edge i is opposite vertex i, so it is that vertex's barycentric weight.
+    float a[3], b[3], c[3];
+    for (int i = 0; i < 3; i++)
+    {
+        int j = (i + 1) % 3, k = (i + 2) % 3;
+        a[i] = y[j] - y[k];
+        b[i] = x[k] - x[j];
+        c[i] = float(double(x[j]) * y[k] - double(x[k]) * y[j]);
+    }
+    float area = a[0] * x[0] + b[0] * y[0] + c[0];
+    if (fabsf(area) < 1e-6f)
+        return;
+    // Back faces are culled, as the D3D device's rasterizer state does.
+    if (area < 0)
+        return;
+
+    int scissorX0, scissorY0, scissorX1, scissorY1;
+    getScissor(&scissorX0, &scissorY0, &scissorX1, &scissorY1);
+
+    float minX = x[0], maxX = x[0], minY = y[0], maxY = y[0];
+    for (int i = 1; i < 3; i++)
+    {
+        if (x[i] < minX) minX = x[i];
+        if (x[i] > maxX) maxX = x[i];
+        if (y[i] < minY) minY = y[i];
+        if (y[i] > maxY) maxY = y[i];
+    }
+    // Pixel centers are at +0.5, so pixel px is covered only if minX <= px + 0.5.
+    int x0 = (minX > scissorX0) ? int(floorf(minX)) : scissorX0;
+    int y0 = (minY > scissorY0) ? int(floorf(minY)) : scissorY0;
+    int x1 = (maxX < scissorX1) ? int(floorf(maxX)) : scissorX1;
+    int y1 = (maxY < scissorY1) ? int(floorf(maxY)) : scissorY1;
+    if (x1 < x0 || y1 < y0)
+        return;
+
+    RasterTriangle& tri = newTriangle();
+    float invArea = 1.0f / area;
+    for (int i = 0; i < 3; i++)
+    {
+        // Evaluated at integer pixel coordinates, for the center at +0.5.
+        tri.EdgeA[i]   = a[i];
+        tri.EdgeB[i]   = b[i];
+        tri.EdgeC[i]   = c[i] + 0.5f * (a[i] + b[i]);
+        // With y down and the inside positive: left edges have A > 0, top edges are
+        // horizontal with the inside below.
+        tri.TopLeft[i] = (a[i] > 0) || (a[i] == 0 && b[i] > 0);
+        tri.InvW[i]    = invW[i];
+        for (int k = 0; k < VaryingCount; k++)
+            tri.Varyings[i][k] = v[i]->Varyings[k] * invW[i];
+    }
+    tri.InvArea = invArea;
+    tri.ZA      = (a[0] * z[0] + a[1] * z[1] + a[2] * z[2]) * invArea;
+    tri.ZB      = (b[0] * z[0] + b[1] * z[1] + b[2] * z[2]) * invArea;
+    tri.ZC      = (tri.EdgeC[0] * z[0] + tri.EdgeC[1] * z[1] + tri.EdgeC[2] * z[2]) * invArea;
+    for (int k = 0; k < 2; k++)
+    {
+        tri.UVGradX[k] = (a[0] * tri.Varyings[0][k] + a[1] * tri.Varyings[1][k] + a[2] * tri.Varyings[2][k]) * invArea;
+        tri.UVGradY[k] = (b[0] * tri.Varyings[0][k] + b[1] * tri.Varyings[1][k] + b[2] * tri.Varyings[2][k]) * invArea;
+    }
+    tri.InvWGradX = (a[0] * invW[0] + a[1] * invW[1] + a[2] * invW[2]) * invArea;
+    tri.InvWGradY = (b[0] * invW[0] + b[1] * invW[1] + b[2] * invW[2]) * invArea;
+    tri.MinX    = x0;
+    tri.MinY    = y0;
+    tri.MaxX    = x1;
+    tri.MaxY    = y1;
+    tri.State   = state;
+
+    FrameStats.Rasterized++;
+    binToTiles(UInt32(TriangleCount - 1));
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** Rasterization
+
+void RenderDevice::Flush()
+{
+    if (!TriangleCount)
+        return;
+
+    TraceScope trace("Soft Flush");
+    UInt64 startTicks = Timer::GetTicks();
+
+    if (WorkerCount)
+    {
+        Mutex::Locker lock(&JobLock);
+        NextTile    = 0;
+        WorkersBusy = WorkerCount;
+        JobGeneration++;
+        JobChanged.NotifyAll();
+    }
+    else
+        NextTile = 0;
+
+    runTiles();
+
+    if (WorkerCount)
+    {
+        Mutex::Locker lock(&JobLock);
+        while (WorkersBusy)
+            JobChanged.Wait(&JobLock);
+    }
+
+    for (UPInt i = 0; i < StateCount; i++)
+        States[i].pTexture.Clear();
+    StateCount      = 0;
+    LightingCount   = 0;
+    CurrentLighting = -1;
+    LastDrawState   = ~UPInt(0);
+    TriangleCount   = 0;
+    for (int i = 0; i < TilesX * TilesY; i++)
+        Bins[i].Count = 0;
+
+    FrameStats.Flushes++;
+    FrameStats.FlushMks += Timer::GetTicks() - startTicks;
+}
+
+int RenderDevice::workerThreadFn(Thread*, void* devicePtr)
+{
+    RenderDevice* device     = (RenderDevice*)devicePtr;
+    unsigned      generation = 0;
+    unsigned      worker;
+
+    {
+        Mutex::Locker lock(&device->JobLock);
+        worker = device->WorkersStarted++;
+    }
+
+    static const char* names[MaxRasterThreads] =
+        { "Raster Worker 0", "Raster Worker 1", "Raster Worker 2", "Raster Worker 3",
+          "Raster Worker 4", "Raster Worker 5", "Raster Worker 6", "Raster Worker 7" };
+    Trace::SetThreadName(names[worker]);
+
+    for (;;)
+    {
+        {
+            Mutex::Locker lock(&device->JobLock);
+            while (device->JobGeneration == generation && !device->Exiting)
+                device->JobChanged.Wait(&device->JobLock);
+            if (device->Exiting)
+                return 0;
+            generation = device->JobGeneration;
+        }
+
+        device->runTiles();
+
+        Mutex::Locker lock(&device->JobLock);
+        if (--device->WorkersBusy == 0)
+            device->JobChanged.NotifyAll();
+    }
+}
+
+void RenderDevice::runTiles()
+{
+    int tileCount = TilesX * TilesY;
+    for (;;)
+    {
+        int tile = NextTile.ExchangeAdd_Sync(1);
+        if (tile >= tileCount)
+            return;
+        if (Bins[tile].Count)
+            rasterTile(unsigned(tile));
+    }
+}
+
+void RenderDevice::rasterTile(unsigned tile)
+{
+    const TileBin& bin = Bins[tile];
+    int tileX0 = int(tile % TilesX) * TileSize;
+    int tileY0 = int(tile / TilesX) * TileSize;
+    int tileX1 = tileX0 + TileSize - 1;
+    int tileY1 = tileY0 + TileSize - 1;
+
+    for (UPInt i = 0; i < bin.Count; i++)
+    {
+        const RasterTriangle& tri = Triangles[bin.Entries[i]];
+        int x0 = (tri.MinX > tileX0) ? tri.MinX : tileX0;
+        int y0 = (tri.MinY > tileY0) ? tri.MinY : tileY0;
+        int x1 = (tri.MaxX < tileX1) ? tri.MaxX : tileX1;
+        int y1 = (tri.MaxY < tileY1) ? tri.MaxY : tileY1;
+
+        const DrawState& state = States[tri.State];
+        if (state.PixelShader == PixelShader_Clear)
+        {
+            for (int y = y0; y <= y1; y++)
+            {
+                UInt32* color = pTarget->GetPixels() + y * pTarget->GetPitch();
+                float*  depth = pTargetDepth->GetDepth() + y * pTargetDepth->GetPitch();
+                for (int x = x0; x <= x1; x++)
+                {
+                    color[x] = state.ClearColor;
+                    depth[x] = state.ClearDepth;
+                }
+            }
+        }
+        else
+            rasterTriangle(tri, x0, y0, x1, y1);
+    }
+}
+
+void RenderDevice::rasterTriangle(const RasterTriangle& tri, int x0, int y0, int x1, int y1)
+{
+    const DrawState& state = States[tri.State];
+
+    bool depthTest  = state.DepthEnable && state.DepthFunc != Compare_Always;
+    bool depthWrite = state.DepthEnable && state.DepthWrite;
+
+    // With the same w at every vertex (screen-space meshes, 2D), interpolation is
+    // affine and needs no divide per pixel.
+    bool  affine  = (tri.InvW[0] == tri.InvW[1] && tri.InvW[1] == tri.InvW[2]);
+    float affineW = 1.0f / tri.InvW[0];
+
+    // Whole groups of four from an aligned x; the pitch is a multiple of four, so the
+    // lanes outside [x0, x1] are still inside the row and only need masking out.
+    int groupX0 = x0 & ~3;
+
+#if defined(SOFT_RASTER_SSE2)
+    const __m128 zero    = _mm_setzero_ps();
+    const __m128 laneX   = _mm_set_ps(3.0f, 2.0f, 1.0f, 0);
+    const __m128 xFirst  = _mm_set1_ps(float(x0) - 0.5f);
+    const __m128 xLast   = _mm_set1_ps(float(x1) + 0.5f);
+    __m128 edgeStep[3], topLeft[3];
+    for (int i = 0; i < 3; i++)
+    {
+        edgeStep[i] = _mm_set1_ps(tri.EdgeA[i] * 4.0f);
+        topLeft[i]  = _mm_castsi128_ps(_mm_set1_epi32(tri.TopLeft[i] ? -1 : 0));
+    }
+    const __m128 zStep = _mm_set1_ps(tri.ZA * 4.0f);
+#endif
+
+    for (int y = y0; y <= y1; y++)
+    {
+        UInt32* colorRow = pTarget->GetPixels() + y * pTarget->GetPitch();
+        float*  depthRow = pTargetDepth->GetDepth() + y * pTargetDepth->GetPitch();
+
+#if defined(SOFT_RASTER_SSE2)
+        __m128 xs = _mm_add_ps(_mm_set1_ps(float(groupX0)), laneX);
+        __m128 e[3];
+        for (int i = 0; i < 3; i++)
+            e[i] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.EdgeA[i]), xs),
+                              _mm_set1_ps(tri.EdgeB[i] * y + tri.EdgeC[i]));
+        __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.ZA), xs), _mm_set1_ps(tri.ZB * y + tri.ZC));
+#endif
+
+        for (int x = groupX0; x <= x1; x += 4)
+        {
+            float            edge[3][4];
+            float            depth[4];
+            int              mask;
+
+#if defined(SOFT_RASTER_SSE2)
+            // Inside all three edges, the top-left rule deciding exact hits, and
+            // within [x0, x1].
+            __m128 inside = _mm_and_ps(_mm_cmpge_ps(xs, xFirst), _mm_cmple_ps(xs, xLast));
+            for (int i = 0; i < 3; i++)
+            {
+                __m128 in = _mm_or_ps(_mm_cmpgt_ps(e[i], zero),
+                                      _mm_and_ps(_mm_cmpeq_ps(e[i], zero), topLeft[i]));
+                inside = _mm_and_ps(inside, in);
+            }
+
+            if (_mm_movemask_ps(inside))
+            {
+                __m128 stored = _mm_load_ps(depthRow + x);
+                if (depthTest)
+                {
+                    __m128 pass = (state.DepthFunc == Compare_Greater) ? _mm_cmpgt_ps(z, stored)
+                                                                        : _mm_cmplt_ps(z, stored);
+                    inside = _mm_and_ps(inside, pass);
+                }
+                mask = _mm_movemask_ps(inside);
+                if (mask && depthWrite)
+                    _mm_store_ps(depthRow + x, _mm_or_ps(_mm_and_ps(inside, z), _mm_andnot_ps(inside, stored)));
+            }
+            else
+                mask = 0;
+
+            if (mask)
+            {
+                for (int i = 0; i < 3; i++)
+                    _mm_storeu_ps(edge[i], e[i]);
+                _mm_storeu_ps(depth, z);
+            }
+
+            xs = _mm_add_ps(xs, _mm_set1_ps(4.0f));
+            for (int i = 0; i < 3; i++)
+                e[i] = _mm_add_ps(e[i], edgeStep[i]);
+            z = _mm_add_ps(z, zStep);
+#else
+            mask = 0;
+            for (int lane = 0; lane < 4; lane++)
+            {
+                int   px = x + lane;
+                bool  in = (px >= x0 && px <= x1);
+                for (int i = 0; i < 3; i++)
+                {
+                    edge[i][lane] = tri.EdgeA[i] * px + tri.EdgeB[i] * y + tri.EdgeC[i];
+                    in = in && (edge[i][lane] > 0 || (edge[i][lane] == 0 && tri.TopLeft[i]));
+                }
+                depth[lane] = tri.ZA * px + tri.ZB * y + tri.ZC;
+                if (in && depthTest)
+                    in = (state.DepthFunc == Compare_Greater) ? (depth[lane] > depthRow[px])
+                                                              : (depth[lane] < depthRow[px]);
+                if (in)
+                {
+                    mask |= 1 << lane;
+                    if (depthWrite)
+                        depthRow[px] = depth[lane];
+                }
+            }
+#endif
+
+            // *** Shading, one covered pixel at a time.
+            for (int lane = 0; mask; lane++, mask >>= 1)
+            {
+                if (!(mask & 1))
+                    continue;
+
+                float b0 = edge[0][lane] * tri.InvArea;
+                float b1 = edge[1][lane] * tri.InvArea;
+                float b2 = edge[2][lane] * tri.InvArea;
+                float w  = affine ? affineW : 1.0f / (b0 * tri.InvW[0] + b1 * tri.InvW[1] + b2 * tri.InvW[2]);
+
+                float varyings[VaryingCount];
+                for (int k = 0; k < state.Varyings; k++)
+                    varyings[k] = (b0 * tri.Varyings[0][k] + b1 * tri.Varyings[1][k] +
+                                   b2 * tri.Varyings[2][k]) * w;
+
+                // Texture footprint: the larger screen-axis step of (u, v), from the
+                // quotient rule on the interpolated u/w, v/w and 1/w.
+                float footprint = 0;
+                if (state.Mipmapped)
+                {
+                    float dudx = (tri.UVGradX[0] - varyings[0] * tri.InvWGradX) * w;
+                    float dvdx = (tri.UVGradX[1] - varyings[1] * tri.InvWGradX) * w;
+                    float dudy = (tri.UVGradY[0] - varyings[0] * tri.InvWGradY) * w;
+                    float dvdy = (tri.UVGradY[1] - varyings[1] * tri.InvWGradY) * w;
+                    float fx   = dudx * dudx + dvdx * dvdx;
+                    float fy   = dudy * dudy + dvdy * dvdy;
+                    footprint  = sqrtf((fx > fy) ? fx : fy);
+                }
+
+                float color[4];
+                shadePixel(state, varyings, footprint, color);
+
+                UInt32& pixel = colorRow[x + lane];
+                if (color[3] < 1.0f)
+                {
+                    float dest[4];
+                    unpackColor(pixel, dest);
+                    float a = clamp01(color[3]);
+                    for (int i = 0; i < 4; i++)
+                        color[i] = color[i] * a + dest[i] * (1.0f - a);
+                }
+                pixel = packColor(color);
+            }
+        }
+    }
+}
+
+void RenderDevice::shadePixel(const DrawState& state, const float* varyings, float footprint,
+                              float color[4]) const
+{
+    const float* uv          = varyings;
+    const float* vertexColor = varyings + 2;
+
+    switch (state.PixelShader)
+    {
+    case FShader_Solid:
+        memcpy(color, state.SolidColor, sizeof(float) * 4);
+        return;
+
+    case FShader_Gouraud:
+        memcpy(color, vertexColor, sizeof(float) * 4);
+        return;
+
+    case FShader_Texture:
+        if (state.pTexture)
+            state.pTexture->Sample(uv[0], uv[1], footprint, color);
+        else
+            color[0] = color[1] = color[2] = color[3] = 1.0f;
+        for (int i = 0; i < 4; i++)
+            color[i] *= vertexColor[i];
+        return;
+
+    case FShader_LitGouraud:
+    case FShader_LitTexture:
+    {
+        // Ambient plus each point light, falling off with distance, as DoLight.
+        const float* pos    = varyings + 6;
+        const float* normal = varyings + 9;
+        float nLength = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        float n[3]    = { 0, 0, 0 };
+        if (nLength > 0)
+            for (int i = 0; i < 3; i++)
+                n[i] = normal[i] / nLength;
+
+        const LightingState* light = (state.Lighting >= 0) ? &Lightings[state.Lighting] : NULL;
+        for (int i = 0; i < 3; i++)
+            color[i] = light ? light->Ambient[i] * vertexColor[i] : 0;
+        color[3] = vertexColor[3];
+
+        for (int l = 0; light && l < light->Count; l++)
+        {
+            float d[3] = { light->Pos[l][0] - pos[0], light->Pos[l][1] - pos[1], light->Pos[l][2] - pos[2] };
+            float distSq = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+            if (distSq <= 0)
+                continue;
+            float dist = sqrtf(distSq);
+            float nDotL = (n[0] * d[0] + n[1] * d[1] + n[2] * d[2]) / dist;
+            for (int i = 0; i < 3; i++)
+                color[i] += clamp01(light->Color[l][i] * vertexColor[i] * nDotL / dist);
+        }
+
+        if (state.PixelShader == FShader_LitTexture && state.pTexture)
+        {
+            float texel[4];
+            state.pTexture->Sample(uv[0], uv[1], footprint, texel);
+            for (int i = 0; i < 4; i++)
+                color[i] *= texel[i];
+        }
+        return;
+    }
+
+    case FShader_PostProcess:
+    case FShader_PostProcessWithChromAb:
+    {
+        // Radial HmdWarp of the scene texture around the lens center; outside the
+        // eye's half of the screen is black.
+        const float* lensCenter   = state.Distortion + 0;
+        const float* screenCenter = state.Distortion + 2;
+        const float* scale        = state.Distortion + 4;
+        const float* scaleIn      = state.Distortion + 6;
+        const float* k            = state.Distortion + 8;
+        const float* chromAb      = state.Distortion + 12;
+
+        float thetaX  = (uv[0] - lensCenter[0]) * scaleIn[0];
+        float thetaY  = (uv[1] - lensCenter[1]) * scaleIn[1];
+        float rSq     = thetaX * thetaX + thetaY * thetaY;
+        float warp    = k[0] + rSq * (k[1] + rSq * (k[2] + rSq * k[3]));
+        float warpedX = thetaX * warp;
+        float warpedY = thetaY * warp;
+
+        color[0] = color[1] = color[2] = 0;
+        color[3] = 1.0f;
+
+        // Blue spreads furthest, so it decides what is inside.
+        float blueScale = (state.PixelShader == FShader_PostProcessWithChromAb) ? chromAb[2] + chromAb[3] * rSq : 1.0f;
+        float tcX = lensCenter[0] + scale[0] * warpedX * blueScale;
+        float tcY = lensCenter[1] + scale[1] * warpedY * blueScale;
+        if (tcX < screenCenter[0] - 0.25f || tcX > screenCenter[0] + 0.25f ||
+            tcY < screenCenter[1] - 0.5f  || tcY > screenCenter[1] + 0.5f || !state.pTexture)
+            return;
+
+        if (state.PixelShader == FShader_PostProcess)
+        {
+            state.pTexture->Sample(tcX, tcY, 0, color);
+            return;
+        }
+
+        float blue[4], center[4], red[4];
+        float redScale = chromAb[0] + chromAb[1] * rSq;
+        state.pTexture->Sample(tcX, tcY, 0, blue);
+        state.pTexture->Sample(lensCenter[0] + scale[0] * warpedX, lensCenter[1] + scale[1] * warpedY, 0, center);
+        state.pTexture->Sample(lensCenter[0] + scale[0] * warpedX * redScale,
+                               lensCenter[1] + scale[1] * warpedY * redScale, 0, red);
+        color[0] = red[0];
+        color[1] = center[1];
+        color[2] = blue[2];
+        color[3] = center[3];
+        return;
+    }
+
+    case PixelShader_DistortionMesh:
+    case PixelShader_DistortionMeshWithChromAb:
+    {
+        // The mesh has done the warp; what is left is the bounds test and the taps.
+        const float* screenCenter = state.Distortion + 2;
+        const float* green        = varyings;
+        const float* red          = varyings + 2;
+        const float* blue         = varyings + 4;
+        bool         chromAb      = (state.PixelShader == PixelShader_DistortionMeshWithChromAb);
+        const float* bounds       = chromAb ? blue : green;
+
+        color[0] = color[1] = color[2] = 0;
+        color[3] = 1.0f;
+        if (bounds[0] < screenCenter[0] - 0.25f || bounds[0] > screenCenter[0] + 0.25f ||
+            bounds[1] < screenCenter[1] - 0.5f  || bounds[1] > screenCenter[1] + 0.5f || !state.pTexture)
+            return;
+
+        if (!chromAb)
+        {
+            state.pTexture->Sample(green[0], green[1], 0, color);
+            return;
+        }
+
+        float r[4], g[4], b[4];
+        state.pTexture->Sample(blue[0], blue[1], 0, b);
+        state.pTexture->Sample(green[0], green[1], 0, g);
+        state.pTexture->Sample(red[0], red[1], 0, r);
+        color[0] = r[0];
+        color[1] = g[1];
+        color[2] = b[2];
+        color[3] = g[3];
+        return;
+    }
+
+    default:
+        color[0] = color[1] = color[2] = color[3] = 1.0f;
+        return;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** Present
+
+void RenderDevice::Present()
+{
+    Flush();
+
+#if defined(OVR_OS_WIN32)
+    if (hWnd)
+    {
+        // Rows are Pitch pixels apart, so the DIB is that wide and the blit takes
+        // the first WindowWidth columns of it.
+        BITMAPINFO bmi;
+        memset(&bmi, 0, sizeof(bmi));
+        bmi.bmiHeader.biSize        = sizeof(bmi.bmiHeader);
+        bmi.bmiHeader.biWidth       = pFrame->GetPitch();
+        bmi.bmiHeader.biHeight      = -WindowHeight;
+        bmi.bmiHeader.biPlanes      = 1;
+        bmi.bmiHeader.biBitCount    = 32;
+        bmi.bmiHeader.biCompression = BI_RGB;
+
+        HDC dc = GetDC((HWND)hWnd);
+        StretchDIBits(dc, 0, 0, WindowWidth, WindowHeight, 0, 0, WindowWidth, WindowHeight,
+                      pFrame->GetPixels(), &bmi, DIB_RGB_COLORS, SRCCOPY);
+        ReleaseDC((HWND)hWnd, dc);
+    }
+#endif
+}
+
+void RenderDevice::ForceFlushGPU()
+{
+    Flush();
+}
+
+}}} // OVR::RenderTiny::Soft
@@ -0,0 +1,428 @@
+/************************************************************************************
+
+Filename    :   RenderTiny_Soft_Device.h
+Content     :   Multithreaded tile-based software RenderDevice
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+#ifndef INC_RenderTiny_Soft_Device_h
+#define INC_RenderTiny_Soft_Device_h
+
+#include "RenderTiny_Device.h"
+#include "RenderTiny_RenderQueue.h"
+#include "Util_DistortionMesh.h"
+#include "../../LibOVR/Src/Kernel/OVR_Threads.h"
+
+namespace OVR { namespace RenderTiny { namespace Soft {
+
+//-------------------------------------------------------------------------------------
+// ***** Soft RenderDevice Description
+
+// A RenderDevice that rasterizes on the CPU, so Scene.Render and the distortion
+// post-process run unchanged where there is no GPU or D3D driver (headless Linux
+// servers), and the CPU cost of draw submission can be profiled on its own.
+//
+// Draws are deferred. Render() shades vertices (RenderInstances() once per
+// instance), clips against the near plane and a guard band, and bins each triangle
+// into the 64x64 pixel tiles its bounds overlap; Clear() is binned the same way.
+// Nothing is rasterized until the bins must be resolved: on a render target change
+// (BeginScene/FinishScene), Present() or ForceFlushGPU().
+// Then every tile is rasterized independently, its bin in submission order, by a
+// pool of worker threads plus the calling thread. Coverage and depth are
+// evaluated four pixels at a time with SSE2 where available.
+//
+// The builtin shaders are reimplemented in C++: Solid, Gouraud, Texture,
+// LitGouraud, LitTexture and both distortion shaders, with the same uniforms the
+// D3D device takes. Textures are bilinear or nearest, from the mip level each
+// pixel's texture footprint selects. Back faces are culled as the D3D device culls
+// them; there is no multisampling, and translucent pixels blend with source alpha.
+// Color targets are 32-bit 0xAARRGGBB, depth is float.
+
+enum
+{
+    TileSize        = 64,
+    MaxRasterThreads = 8
+};
+
+class RenderDevice;
+
+
+//-------------------------------------------------------------------------------------
+// ***** Buffer
+
+class Buffer : public RenderTiny::Buffer
+{
+public:
+    Buffer() : pData(0), Size(0), Use(0) { }
+    ~Buffer();
+
+    virtual size_t  GetSize()   { return Size; }
+    virtual void*   Map(size_t start, size_t size, int flags = 0);
+    virtual bool    Unmap(void* m);
+    virtual bool    Data(int use, const void* buffer, size_t size);
+
+    const UByte*    GetData() const { return pData; }
+
+private:
+    UByte*          pData;
+    size_t          Size;
+    int             Use;
+};
+
+
+//-------------------------------------------------------------------------------------
+// ***** Texture
+
+// Color textures hold 0xAARRGGBB pixels, depth textures floats; rows are Pitch
+// elements apart, rounded up to four so the rasterizer can always touch whole
+// groups of four pixels. Textures created with Texture_GenMipmaps and data get a
+// box-filtered mip chain.
+
+class Texture : public RenderTiny::Texture
+{
+public:
+    Texture(RenderDevice* ren, int format, int width, int height);
+    ~Texture();
+
+    virtual int     GetWidth() const            { return Width; }
+    virtual int     GetHeight() const           { return Height; }
+    virtual void    SetSampleMode(int sm)       { SampleMode = sm; }
+    virtual void    Set(int slot, ShaderStage stage = Shader_Fragment) const;
+
+    bool            IsDepth() const             { return (Format & Texture_TypeMask) == Texture_Depth; }
+    int             GetPitch() const            { return Pitch; }
+    UInt32*         GetPixels() const           { return pPixels; }
+    float*          GetDepth() const            { return pDepth; }
+
+    // Copies RGBA8 rows of Width pixels in, and rebuilds the mip chain.
+    void            SetPixels(const void* rgba);
+
+    // Filtered color at u, v (0..1 across the texture, top row at v = 0), each
+    // channel 0..1. 'footprint' is how far u, v move per pixel, which picks the mip
+    // level; 0 samples the top level.
+    void            Sample(float u, float v, float footprint, float rgba[4]) const;
+    bool            HasMipmaps() const          { return Mips.GetSize() != 0; }
+
+private:
+    struct MipLevel
+    {
+        UInt32*     pPixels;
+        int         Width, Height, Pitch;
+    };
+
+    void            sampleLevel(const MipLevel& level, float u, float v, float rgba[4]) const;
+
+    RenderDevice*   Ren;
+    int             Format;
+    int             Width, Height, Pitch;
+    int             SampleMode;
+    UInt32*         pPixels;
+    float*          pDepth;
+    // Levels below the top one, each half the size of the one before.
+    Array<MipLevel> Mips;
+};
+
+
+//-------------------------------------------------------------------------------------
+// ***** Shader
+
+// A builtin shader: its VShader_/FShader_ id and the uniforms set on it.
+
+class Shader : public RenderTiny::Shader
+{
+public:
+    Shader(RenderDevice* ren, ShaderStage stage, int builtin)
+        : RenderTiny::Shader(stage), Ren(ren), Builtin(builtin) { }
+
+    virtual void    Set(PrimitiveType prim) const;
+
+    int             GetBuiltin() const { return Builtin; }
+    // Copies the first n floats of uniform 'name'; false if it was never set.
+    bool            GetUniform(const char* name, float* v, int n) const;
+
+protected:
+    virtual bool    SetUniform(const char* name, int n, const float* v);
+
+private:
+    struct Uniform
+    {
+        String      Name;
+        float       V[16];
+    };
+
+    RenderDevice*   Ren;
+    int             Builtin;
+    Array<Uniform>  Uniforms;
+};
+
+
+//-------------------------------------------------------------------------------------
+// ***** RenderDevice
+
+class RenderDevice : public RenderTiny::RenderDevice, public InstanceRenderer
+{
+public:
+    // Submission and resolve counters since the last ResetStats().
+    struct Stats
+    {
+        UInt32      Draws;
+        UInt32      States;         // Draws that rebound state; the rest reused the last.
+        UInt32      Triangles;      // Submitted.
+        UInt32      Rasterized;     // After clipping; a clipped triangle may become several.
+        UInt32      BinEntries;     // Triangle-tile pairs, including clears.
+        UInt32      Flushes;
+        UInt64      FlushMks;       // Wall time spent resolving bins.
+
+        Stats() { memset(this, 0, sizeof(*this)); }
+    };
+
+    RenderDevice(const RendererParams& p, void* oswnd, int width, int height);
+    ~RenderDevice();
+
+    // Renders into a window-sized frame and, on Windows, presents it to 'oswnd' (an
+    // HWND) with GDI.
+    static RenderDevice* CreateDevice(const RendererParams& rp, void* oswnd);
+    // Renders into a width x height frame that is only read back with GetFrame().
+    static RenderDevice* CreateOffscreenDevice(const RendererParams& rp, int width, int height);
+
+    virtual void        Shutdown();
+
+    virtual void        SetRealViewport(const Viewport& vp);
+    virtual void        Clear(float r = 0, float g = 0, float b = 0, float a = 1, float depth = 1);
+    virtual void        Present();
+    virtual void        ForceFlushGPU();
+
+    virtual Buffer*     CreateBuffer();
+    virtual Texture*    CreateTexture(int format, int width, int height, const void* data, int mipcount = 1);
+    virtual Shader*     LoadBuiltinShader(ShaderStage stage, int shader);
+    virtual Fill*       CreateSimpleFill();
+
+    virtual void        SetRenderTarget(RenderTiny::Texture* color,
+                                        RenderTiny::Texture* depth = NULL, RenderTiny::Texture* stencil = NULL);
+    virtual void        SetDepthMode(bool enable, bool write, CompareFunc func = Compare_Less);
+    virtual void        SetWorldUniforms(const Matrix4f& proj);
+    virtual void        SetLighting(const LightingParams* light);
+
+    virtual void        Render(const Matrix4f& matrix, Model* model);
+    virtual void        Render(const Fill* fill, RenderTiny::Buffer* vertices, RenderTiny::Buffer* indices,
+                               const Matrix4f& matrix, int offset, int count, PrimitiveType prim = Prim_Triangles);
+    // One draw: the fill is bound, the state captured and the indices checked
+    // once, then each instance's vertices shaded with its matrix and binned.
+    virtual void        RenderInstances(const Matrix4f* matrices, unsigned count, Model* model);
+
+    // *** Single-pass stereo
+
+    // Between these two, each Clear and draw applies to both eyes, the way instanced
+    // stereo does on a GPU: the state is captured and the vertices walked once per
+    // draw, and each vertex is transformed once per eye, the instance index picking
+    // that eye's projection, ViewAdjust and viewport. The scene is rendered once with
+    // the center View; ApplyStereoParams is not called in between.
+    void                BeginStereoScene(PostProcessType pp, const StereoEyeParams& left,
+                                         const StereoEyeParams& right);
+    // Distorts each eye into the frame, as FinishScene does after a single eye.
+    void                FinishStereoScene();
+
+    // *** Distortion mesh
+
+    // With a grid size, FinishScene draws the distortion post-process as a
+    // DistortionMesh of gridSize x gridSize cells per eye, interpolating the warped
+    // texture coordinates instead of evaluating the warp at every pixel; the mesh
+    // is rebuilt only when the eye's distortion parameters change. 0, the default,
+    // warps per pixel with the distortion shaders.
+    void                SetDistortionMeshGrid(int gridSize) { DistortionMeshGrid = gridSize; }
+    int                 GetDistortionMeshGrid() const       { return DistortionMeshGrid; }
+
+    virtual void        FinishScene();
+
+    // The frame as of the last Present(): 0xAARRGGBB, rows GetFramePitch() pixels apart.
+    const UInt32*       GetFrame() const            { return pFrame->GetPixels(); }
+    int                 GetFramePitch() const       { return pFrame->GetPitch(); }
+    int                 GetFrameWidth() const       { return WindowWidth; }
+    int                 GetFrameHeight() const      { return WindowHeight; }
+
+    // Rasterizes everything binned so far.
+    void                Flush();
+
+    const Stats&        GetStats() const            { return FrameStats; }
+    void                ResetStats()                { FrameStats = Stats(); }
+    unsigned            GetThreadCount() const      { return WorkerCount + 1; }
+
+private:
+    friend class Soft::Shader;
+    friend class Soft::Texture;
+
+    enum { VaryingCount = 12 }; // UV, color rgba, view position, view normal.
+
+    // DrawState::PixelShader values besides the FShader_ ids. Distortion mesh
+    // varyings are the green, red and blue texture coordinates.
+    enum
+    {
+        PixelShader_Clear                       = -1,
+        PixelShader_DistortionMesh              = -2,
+        PixelShader_DistortionMeshWithChromAb   = -3
+    };
+
+    struct ShadedVertex
+    {
+        float       Clip[4];
+        float       Varyings[VaryingCount];
+    };
+
+    // Everything a binned triangle needs from the state it was drawn with.
+    struct DrawState
+    {
+        int                 PixelShader;    // FShader_* or PixelShader_*.
+        int                 Varyings;       // How many leading varyings it reads.
+        bool                Mipmapped;      // Needs each pixel's texture footprint.
+        Ptr<Texture>        pTexture;
+        float               SolidColor[4];
+        // LensCenter, ScreenCenter, Scale, ScaleIn, HmdWarpParam, ChromAbParam.
+        float               Distortion[16];
+        int                 Lighting;       // Index into Lightings, or -1.
+        bool                DepthEnable, DepthWrite;
+        CompareFunc         DepthFunc;
+        UInt32              ClearColor;
+        float               ClearDepth;
+    };
+
+    struct RasterTriangle
+    {
+        // Edge functions A*x + B*y + C at pixel centers, positive inside.
+        float       EdgeA[3], EdgeB[3], EdgeC[3];
+        bool        TopLeft[3];
+        float       InvArea;
+        // Screen-linear depth plane.
+        float       ZA, ZB, ZC;
+        float       InvW[3];
+        // Per-vertex varyings, premultiplied by InvW for perspective correction.
+        float       Varyings[3][VaryingCount];
+        // Screen gradients of the premultiplied UV and of 1/w, for mip selection.
+        float       UVGradX[2], UVGradY[2];
+        float       InvWGradX, InvWGradY;
+        int         MinX, MinY, MaxX, MaxY;    // Inclusive pixel bounds, within the scissor.
+        UInt32      State;
+    };
+
+    struct LightingState
+    {
+        float       Ambient[3];
+        float       Pos[8][3];
+        float       Color[8][3];
+        int         Count;
+    };
+
+    // Indices into Triangles, in submission order. Entries only grow, so a flush
+    // does not free and reallocate them every frame.
+    struct TileBin
+    {
+        Array<UInt32>   Entries;
+        UPInt           Count;
+    };
+
+    void                setShader(const Shader* shader);
+    void                setTexture(int slot, const Texture* texture);
+
+    void                allocateBins();
+    // Called on every change a DrawState would capture.
+    void                invalidateState()   { StateVersion++; }
+    DrawState&          newState();
+    // Index of a DrawState for the bound state, reusing the last draw's if possible.
+    UInt32              drawState();
+    void                renderInstances(const Fill* fill, RenderTiny::Buffer* vertices, RenderTiny::Buffer* indices,
+                                        const Matrix4f* matrices, unsigned instanceCount,
+                                        int offset, int count, PrimitiveType prim);
+    RasterTriangle&     newTriangle();
+    void                getScissor(int* x0, int* y0, int* x1, int* y1) const;
+    void                binClear(float r, float g, float b, float a, float depth);
+    void                renderDistortionMesh(const DistortionMesh& mesh, bool chromAb);
+    void                binToTiles(UInt32 index);
+    void                binTriangle(const ShadedVertex& v0, const ShadedVertex& v1,
+                                    const ShadedVertex& v2, UInt32 state);
+    void                clipAndBin(const ShadedVertex& v0, const ShadedVertex& v1,
+                                   const ShadedVertex& v2, UInt32 state);
+    void                rasterTile(unsigned tile);
+    void                rasterTriangle(const RasterTriangle& tri, int x0, int y0, int x1, int y1);
+    void                shadePixel(const DrawState& state, const float* varyings, float footprint,
+                                   float color[4]) const;
+
+    static int          workerThreadFn(Thread* thread, void* device);
+    void                runTiles();
+
+    void*               hWnd;
+
+    Ptr<Texture>        pFrame;
+    Ptr<Texture>        pFrameDepth;
+    Ptr<Texture>        pSceneDepth;    // For render targets given without depth.
+    Texture*            pTarget;
+    Texture*            pTargetDepth;
+
+    // Current state.
+    Matrix4f            WorldProj;
+    const Shader*       pVertexShader;
+    const Shader*       pPixelShader;
+    const Texture*      pBoundTexture;
+    Viewport            RasterVP;
+    bool                DepthEnable, DepthWrite;
+    CompareFunc         DepthFunc;
+    LightingState       Light;
+    int                 CurrentLighting;    // Light's index in Lightings, or -1.
+    Ptr<Fill>           DefaultFill;
+    // Draws share the last draw's snapshot, States[LastDrawState], while
+    // StateVersion is still LastDrawVersion; binding what is already bound is not
+    // a change.
+    UInt32              StateVersion;
+    UPInt               LastDrawState;
+    UInt32              LastDrawVersion;
+
+    // Single-pass stereo: each eye's parameters, Projection * ViewAdjust, and
+    // scaled viewport.
+    bool                StereoActive;
+    PostProcessType     StereoPostProcess;
+    StereoEyeParams     StereoEyes[2];
+    Matrix4f            StereoProj[2];
+    Viewport            StereoVP[2];
+
+    // Per-eye distortion meshes, left then right, when DistortionMeshGrid is set.
+    int                 DistortionMeshGrid;
+    DistortionMesh      EyeMeshes[2];
+
+    // Work binned since the last flush. Like the bins, these arrays only grow and
+    // the counts say how much of them is in use.
+    Array<DrawState>        States;
+    Array<LightingState>    Lightings;
+    Array<RasterTriangle>   Triangles;
+    UPInt                   StateCount, LightingCount, TriangleCount;
+    Array<TileBin>          Bins;
+    int                     TilesX, TilesY;
+    Array<ShadedVertex>     Shaded;
+
+    // Raster worker pool. Workers wait for JobGeneration to change, then take tiles
+    // from NextTile until none are left.
+    Ptr<Thread>         Workers[MaxRasterThreads];
+    unsigned            WorkerCount;
+    unsigned            WorkersStarted;
+    Mutex               JobLock;
+    WaitCondition       JobChanged;
+    unsigned            JobGeneration;
+    unsigned            WorkersBusy;
+    bool                Exiting;
+    AtomicInt<int>      NextTile;
+
+    Stats               FrameStats;
+};
+
+}}} // OVR::RenderTiny::Soft
+
+#endif
@@ -0,0 +1,223 @@
+/************************************************************************************
+
+Filename    :   RenderTiny_StaticBatch.cpp
+Content     :   Merges a scene's static models into a few pre-transformed batches
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "RenderTiny_StaticBatch.h"
+#include "../../LibOVR/Src/Kernel/OVR_Alg.h"
+
+#include <string.h>
+
+namespace OVR { namespace RenderTiny {
+
+StaticBatch::StaticBatch()
+{
+}
+
+void StaticBatch::Build(Container* container, unsigned maxVertices)
+{
+    BatchStats = Stats();
+    maxVertices = Alg::Clamp(maxVertices, 3u, (unsigned)MaxVertices);
+
+    collect(container, Matrix4f(), maxVertices);
+    BatchStats.Models = (unsigned)Items.GetSize();
+
+    // One fill at a time, in the order the scene first uses them.
+    ItemOrder.Resize(Items.GetSize());
+    int first = 0;
+    for (UPInt g = 0; g < Fills.GetSize(); g++)
+    {
+        int count = 0;
+        for (UPInt i = 0; i < Items.GetSize(); i++)
+            if (Items[i].Group == (int)g)
+                ItemOrder[first + count++] = (int)i;
+        split(container, first, count, maxVertices);
+        first += count;
+    }
+
+    Items.Clear();
+    ItemOrder.Clear();
+    Fills.Clear();
+}
+
+// Takes the models that can be merged out of 'container' and its children,
+// leaving the rest, and drops the child containers that end up empty.
+void StaticBatch::collect(Container* container, const Matrix4f& parent, unsigned maxVertices)
+{
+    Array<Ptr<Node> > kept;
+    for (UPInt i = 0; i < container->Nodes.GetSize(); i++)
+    {
+        Node*    node  = container->Nodes[i];
+        Matrix4f world = parent * node->GetMatrix();
+
+        if (node->GetType() == Node::Node_Container)
+        {
+            Container* child = (Container*)node;
+            collect(child, world, maxVertices);
+            if (child->Nodes.GetSize())
+                kept.PushBack(node);
+            continue;
+        }
+        if (node->GetType() != Node::Node_Model)
+        {
+            kept.PushBack(node);
+            continue;
+        }
+
+        Model* model = (Model*)node;
+        UPInt  vertices = model->Vertices.GetSize();
+        if (model->GetPrimType() != Prim_Triangles || !model->Visible || vertices == 0 ||
+            model->Indices.GetSize() < 3 || vertices > maxVertices)
+        {
+            BatchStats.Kept++;
+            kept.PushBack(node);
+            continue;
+        }
+
+        Item item;
+        item.pModel = model;
+        item.World  = world;
+
+        Vector3f lo = model->Vertices[0].Pos, hi = lo;
+        for (UPInt v = 1; v < vertices; v++)
+        {
+            const Vector3f& p = model->Vertices[v].Pos;
+            lo = Vector3f(Alg::Min(lo.x, p.x), Alg::Min(lo.y, p.y), Alg::Min(lo.z, p.z));
+            hi = Vector3f(Alg::Max(hi.x, p.x), Alg::Max(hi.y, p.y), Alg::Max(hi.z, p.z));
+        }
+        item.Center = world.Transform((lo + hi) * 0.5f);
+
+        item.Group = -1;
+        for (UPInt g = 0; g < Fills.GetSize() && item.Group < 0; g++)
+            if (Fills[g] == model->Fill.GetPtr())
+                item.Group = (int)g;
+        if (item.Group < 0)
+        {
+            item.Group = (int)Fills.GetSize();
+            Fills.PushBack(model->Fill.GetPtr());
+        }
+        Items.PushBack(item);
+    }
+    container->Nodes = kept;
+}
+
+// Merges ItemOrder[first..first + count), halving it along the longest axis of
+// its models' centers until each half fits in maxVertices.
+void StaticBatch::split(Container* container, int first, int count, unsigned maxVertices)
+{
+    if (count == 0)
+        return;
+
+    UPInt    vertices = 0;
+    Vector3f lo = Items[ItemOrder[first]].Center, hi = lo;
+    for (int i = first; i < first + count; i++)
+    {
+        const Item& item = Items[ItemOrder[i]];
+        vertices += item.pModel->Vertices.GetSize();
+        lo = Vector3f(Alg::Min(lo.x, item.Center.x), Alg::Min(lo.y, item.Center.y), Alg::Min(lo.z, item.Center.z));
+        hi = Vector3f(Alg::Max(hi.x, item.Center.x), Alg::Max(hi.y, item.Center.y), Alg::Max(hi.z, item.Center.z));
+    }
+    if (count == 1 || vertices <= maxVertices)
+    {
+        merge(container, first, count);
+        return;
+    }
+
+    // As SceneBVH splits: the centers' box in half, or the list in half if that
+    // leaves a side empty.
+    Vector3f extent = hi - lo;
+    int      axis   = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : ((extent.y >= extent.z) ? 1 : 2);
+    float    half   = (axis == 0) ? (lo.x + hi.x) * 0.5f :
+                      (axis == 1) ? (lo.y + hi.y) * 0.5f : (lo.z + hi.z) * 0.5f;
+    int      middle = first;
+    for (int i = first; i < first + count; i++)
+    {
+        const Vector3f& c      = Items[ItemOrder[i]].Center;
+        float           center = (axis == 0) ? c.x : (axis == 1) ? c.y : c.z;
+        if (center < half)
+            Alg::Swap(ItemOrder[i], ItemOrder[middle++]);
+    }
+    if (middle == first || middle == first + count)
+        middle = first + count / 2;
+
+    split(container, first, middle - first, maxVertices);
+    split(container, middle, first + count - middle, maxVertices);
+}
+
+void StaticBatch::merge(Container* container, int first, int count)
+{
+    Ptr<Model> batch = *new Model(Prim_Triangles);
+    batch->Fill = Items[ItemOrder[first]].pModel->Fill;
+
+    UPInt vertices = 0, indices = 0;
+    for (int i = first; i < first + count; i++)
+    {
+        vertices += Items[ItemOrder[i]].pModel->Vertices.GetSize();
+        indices  += Items[ItemOrder[i]].pModel->Indices.GetSize();
+    }
+    batch->Vertices.Reserve(vertices);
+    batch->Indices.Reserve(indices);
+
+    for (int i = first; i < first + count; i++)
+    {
+        const Item&     item  = Items[ItemOrder[i]];
+        const Model*    model = item.pModel;
+        const Matrix4f& m     = item.World;
+
+        // Normals go through the inverse transpose of the upper 3x3, which is its
+        // cofactor matrix over the determinant; only the determinant's sign
+        // matters, as normals keep their length. Triangles keep their winding, so
+        // a mirrored model faces the way it did when drawn with its transform.
+        Vector3f c0(m.M[0][0], m.M[1][0], m.M[2][0]);
+        Vector3f c1(m.M[0][1], m.M[1][1], m.M[2][1]);
+        Vector3f c2(m.M[0][2], m.M[1][2], m.M[2][2]);
+        Vector3f n0 = c1.Cross(c2), n1 = c2.Cross(c0), n2 = c0.Cross(c1);
+        if (c0.Dot(n0) < 0.0f)
+        {
+            n0 = -n0;
+            n1 = -n1;
+            n2 = -n2;
+        }
+
+        UPInt base = batch->Vertices.GetSize();
+        for (UPInt v = 0; v < model->Vertices.GetSize(); v++)
+        {
+            Vertex   vertex = model->Vertices[v];
+            Vector3f normal = n0 * vertex.Norm.x + n1 * vertex.Norm.y + n2 * vertex.Norm.z;
+            float    length = normal.Length();
+            vertex.Pos = m.Transform(vertex.Pos);
+            if (length > 0.0f)
+                vertex.Norm = normal * (vertex.Norm.Length() / length);
+            batch->Vertices.PushBack(vertex);
+        }
+
+        const Array<UInt16>& source = model->Indices;
+        for (UPInt t = 0; t + 2 < source.GetSize(); t += 3)
+        {
+            batch->AddTriangle(UInt16(base + source[t]), UInt16(base + source[t + 1]),
+                               UInt16(base + source[t + 2]));
+        }
+    }
+
+    container->Add(batch);
+    BatchStats.Batches++;
+    BatchStats.Vertices  += (unsigned)batch->Vertices.GetSize();
+    BatchStats.Triangles += (unsigned)batch->Indices.GetSize() / 3;
+}
+
+}} // OVR::RenderTiny
@@ -0,0 +1,94 @@
+/************************************************************************************
+
+Filename    :   RenderTiny_StaticBatch.h
+Content     :   Merges a scene's static models into a few pre-transformed batches
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+#ifndef INC_RenderTiny_StaticBatch_h
+#define INC_RenderTiny_StaticBatch_h
+
+#include "RenderTiny_Device.h"
+
+namespace OVR { namespace RenderTiny {
+
+//-------------------------------------------------------------------------------------
+// ***** StaticBatch
+
+// Trades a scene's many small static models for a few large ones, once, at scene
+// build time. Build() takes every model under a container, transforms its vertices
+// by the model's transform (normals by its inverse transpose), and appends them to
+// a batch of the models sharing its fill, so each fill costs one draw and one state
+// bind instead of one per model. The batches replace the models in the container;
+// nested containers are flattened into it.
+//
+// A batch holds at most maxVertices vertices (Model indices are 16 bits). Fills
+// with more are split in half along the longest axis of their models' centers until
+// every part fits, so batches stay spatially compact; a smaller maxVertices gives
+// more, smaller batches that frustum culling can still reject.
+//
+// Only triangle lists with vertex and index data are merged, and only visible ones;
+// everything else is left in place. Nothing merged can move or be hidden on its
+// own afterwards, so build from the parts of the scene that never change.
+
+class StaticBatch
+{
+public:
+    enum { MaxVertices = 0x10000 };
+
+    struct Stats
+    {
+        // Models merged into batches, and batches made of them.
+        unsigned    Models;
+        unsigned    Batches;
+        // Models left as they were.
+        unsigned    Kept;
+        unsigned    Vertices;
+        unsigned    Triangles;
+
+        Stats() { memset(this, 0, sizeof(*this)); }
+    };
+
+    StaticBatch();
+
+    void        Build(Container* container, unsigned maxVertices = MaxVertices);
+
+    // For the last Build().
+    const Stats& GetStats() const           { return BatchStats; }
+
+private:
+    struct Item
+    {
+        Ptr<Model>  pModel;
+        Matrix4f    World;
+        Vector3f    Center;
+        // Index into Fills.
+        int         Group;
+    };
+
+    void        collect(Container* container, const Matrix4f& parent, unsigned maxVertices);
+    void        split(Container* container, int first, int count, unsigned maxVertices);
+    void        merge(Container* container, int first, int count);
+
+    // Only used during Build().
+    Array<Item>     Items;
+    Array<int>      ItemOrder;
+    Array<Fill*>    Fills;
+    Stats           BatchStats;
+};
+
+}} // OVR::RenderTiny
+
+#endif
@@ -0,0 +1,57 @@
+/************************************************************************************
+
+Filename    :   ThreeSpace_Device.cpp
+Content     :   Live YEI 3-Space device as a ThreeSpaceSource
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "ThreeSpace_Device.h"
+#include "../../LibOVR/Src/Kernel/OVR_Threads.h"
+#include "../../LibOVR/Src/Kernel/OVR_Timer.h"
+
+//-------------------------------------------------------------------------------------
+// ***** ThreeSpaceDeviceSource
+
+ThreeSpaceDeviceSource::ThreeSpaceDeviceSource(TSS_Device_Id device)
+    : Device(device), LastTimestamp(0), HavePacket(false)
+{
+}
+
+ThreeSpaceSource::ReadResult ThreeSpaceDeviceSource::ReadSample(ThreeSpaceSample* sample,
+                                                                unsigned timeoutMs)
+{
+    // Read straight into the packed layout; no per-slot API calls.
+    ThreeSpaceStreamLayout::Packet packet;
+    int error = tss_getLatestStreamData(Device, (char*)packet.Data, ThreeSpaceStreamLayout::PacketSize,
+                                        timeoutMs, &sample->SensorTimestamp);
+    if (error != 0)
+        return Read_Error;
+
+    // The API hands back the latest packet even if we have already seen it;
+    // only report packets the sensor has actually produced since last time, and
+    // wait a little for the next rather than asking again straight away.
+    if (HavePacket && sample->SensorTimestamp == LastTimestamp)
+    {
+        Thread::MSleep(1);
+        return Read_NoSample;
+    }
+
+    sample->SetStreamData<ThreeSpaceStreamLayout>(packet);
+    sample->HostTicks = Timer::GetTicks();
+    LastTimestamp     = sample->SensorTimestamp;
+    HavePacket        = true;
+    return Read_Sample;
+}
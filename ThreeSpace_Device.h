@@ -0,0 +1,48 @@
+/************************************************************************************
+
+Filename    :   ThreeSpace_Device.h
+Content     :   Live YEI 3-Space device as a ThreeSpaceSource
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+#ifndef INC_ThreeSpace_Device_h
+#define INC_ThreeSpace_Device_h
+
+#include "ThreeSpace_Sample.h"
+
+#include "ThreeSpaceAPI/yei_threespace_api.h"
+
+//-------------------------------------------------------------------------------------
+// ***** ThreeSpaceDeviceSource
+
+// Reads stream packets from a device that is already configured and streaming
+// ThreeSpaceStreamLayout's slots, through the ThreeSpace API.
+
+class ThreeSpaceDeviceSource : public ThreeSpaceSource
+{
+public:
+    ThreeSpaceDeviceSource(TSS_Device_Id device);
+
+    virtual ReadResult ReadSample(ThreeSpaceSample* sample, unsigned timeoutMs);
+
+    TSS_Device_Id   GetDevice() const { return Device; }
+
+private:
+    TSS_Device_Id   Device;
+    unsigned int    LastTimestamp;
+    bool            HavePacket;
+};
+
+#endif
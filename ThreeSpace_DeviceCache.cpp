@@ -0,0 +1,155 @@
+/************************************************************************************
+
+Filename    :   ThreeSpace_DeviceCache.cpp
+Content     :   On-disk cache of 3-Space sensor ports and configuration
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "ThreeSpace_DeviceCache.h"
+#include "../../LibOVR/Src/Kernel/OVR_Log.h"
+
+#include <stdio.h>
+
+#if defined(OVR_OS_WIN32)
+#include <windows.h>
+#endif
+
+//-------------------------------------------------------------------------------------
+// ***** ThreeSpaceDeviceCache
+
+bool ThreeSpaceDeviceCache::Load(const char* path)
+{
+    Mutex::Locker lock(&CacheLock);
+    Configs.Clear();
+
+    FILE* file = fopen(path, "r");
+    if (!file)
+        return false;
+
+    char line[256];
+    while (fgets(line, sizeof(line), file))
+    {
+        if (line[0] == '#')
+            continue;
+
+        char     port[128];
+        unsigned serial, axis, interval, slots[TSS_StreamSlotCount];
+        if (sscanf(line, "%x %127s %x %x,%x,%x,%x,%x,%x,%x,%x %u", &serial, port, &axis,
+                   &slots[0], &slots[1], &slots[2], &slots[3],
+                   &slots[4], &slots[5], &slots[6], &slots[7], &interval) != 12)
+            continue;
+
+        ThreeSpaceDeviceConfig config;
+        config.SerialNumber   = serial;
+        config.Port           = port;
+        config.AxisDirections = UByte(axis);
+        config.IntervalMks    = interval;
+        for (unsigned i = 0; i < TSS_StreamSlotCount; i++)
+            config.Slots[i] = UByte(slots[i]);
+        Configs.PushBack(config);
+    }
+
+    fclose(file);
+    return true;
+}
+
+bool ThreeSpaceDeviceCache::Save(const char* path) const
+{
+    Mutex::Locker lock(&CacheLock);
+
+    String tempPath(path);
+    tempPath += ".tmp";
+
+    FILE* file = fopen(tempPath.ToCStr(), "w");
+    if (!file)
+    {
+        LogText("TSS: Can't write device cache %s\n", tempPath.ToCStr());
+        return false;
+    }
+
+    fputs("# ThreeSpace device cache\n"
+          "# serial port axis slots interval-mks\n", file);
+    for (UPInt i = 0; i < Configs.GetSize(); i++)
+    {
+        const ThreeSpaceDeviceConfig& c = Configs[i];
+        fprintf(file, "%08x %s %02x %02x,%02x,%02x,%02x,%02x,%02x,%02x,%02x %u\n",
+                c.SerialNumber, c.Port.ToCStr(), c.AxisDirections,
+                c.Slots[0], c.Slots[1], c.Slots[2], c.Slots[3],
+                c.Slots[4], c.Slots[5], c.Slots[6], c.Slots[7], c.IntervalMks);
+    }
+
+    bool ok = (fclose(file) == 0);
+
+#if defined(OVR_OS_WIN32)
+    ok = ok && MoveFileExA(tempPath.ToCStr(), path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    ok = ok && rename(tempPath.ToCStr(), path) == 0;
+#endif
+    if (!ok)
+    {
+        LogText("TSS: Can't write device cache %s\n", path);
+        remove(tempPath.ToCStr());
+    }
+    return ok;
+}
+
+bool ThreeSpaceDeviceCache::Find(UInt32 serialNumber, ThreeSpaceDeviceConfig* config) const
+{
+    Mutex::Locker lock(&CacheLock);
+    for (UPInt i = 0; i < Configs.GetSize(); i++)
+    {
+        if (Configs[i].SerialNumber == serialNumber)
+        {
+            *config = Configs[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreeSpaceDeviceCache::Set(const ThreeSpaceDeviceConfig& config)
+{
+    Mutex::Locker lock(&CacheLock);
+
+    UPInt i = 0;
+    while (i < Configs.GetSize())
+    {
+        if (Configs[i].SerialNumber == config.SerialNumber || Configs[i].Port == config.Port)
+            Configs.RemoveAt(i);
+        else
+            i++;
+    }
+    Configs.PushBack(config);
+}
+
+void ThreeSpaceDeviceCache::Remove(UInt32 serialNumber)
+{
+    Mutex::Locker lock(&CacheLock);
+    for (UPInt i = 0; i < Configs.GetSize(); i++)
+    {
+        if (Configs[i].SerialNumber == serialNumber)
+        {
+            Configs.RemoveAt(i);
+            return;
+        }
+    }
+}
+
+void ThreeSpaceDeviceCache::GetConfigs(Array<ThreeSpaceDeviceConfig>* configs) const
+{
+    Mutex::Locker lock(&CacheLock);
+    *configs = Configs;
+}
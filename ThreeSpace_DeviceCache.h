@@ -0,0 +1,99 @@
+/************************************************************************************
+
+Filename    :   ThreeSpace_DeviceCache.h
+Content     :   On-disk cache of 3-Space sensor ports and configuration
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+#ifndef INC_ThreeSpace_DeviceCache_h
+#define INC_ThreeSpace_DeviceCache_h
+
+#include "../../LibOVR/Src/Kernel/OVR_Types.h"
+#include "../../LibOVR/Src/Kernel/OVR_Array.h"
+#include "../../LibOVR/Src/Kernel/OVR_String.h"
+#include "../../LibOVR/Src/Kernel/OVR_Threads.h"
+#include "ThreeSpace_Protocol.h"
+
+using namespace OVR;
+
+//-------------------------------------------------------------------------------------
+// ***** ThreeSpaceDeviceConfig
+
+// What a sensor was last set up with, and where it was found.
+struct ThreeSpaceDeviceConfig
+{
+    UInt32  SerialNumber;
+    String  Port;
+    UByte   AxisDirections;
+    UByte   Slots[TSS_StreamSlotCount];
+    UInt32  IntervalMks;
+
+    ThreeSpaceDeviceConfig() : SerialNumber(0), AxisDirections(0), IntervalMks(0)
+    {
+        memset(Slots, 0xFF, sizeof(Slots));
+    }
+
+    // True if both describe the same sensor settings, wherever the sensor is.
+    bool SameSettings(const ThreeSpaceDeviceConfig& other) const
+    {
+        return AxisDirections == other.AxisDirections && IntervalMks == other.IntervalMks &&
+               memcmp(Slots, other.Slots, sizeof(Slots)) == 0;
+    }
+};
+
+
+//-------------------------------------------------------------------------------------
+// ***** ThreeSpaceDeviceCache
+
+// Remembers, per sensor serial, the port the sensor was found on and the settings
+// it was given, so the next start can open the known ports directly instead of
+// scanning, and verify a sensor's settings instead of sending them again. The
+// settings survive on the sensor for as long as it stays powered, which is the
+// usual case when the app restarts after a crash.
+//
+// The file is text, one sensor per line:
+//
+//   # serial port axis slots interval-mks
+//   1234abc0 COM3 21 00,26,27,2d,ff,ff,ff,ff 0
+//
+// Save() writes a temporary file and renames it over the old one, so a crash
+// while saving leaves the previous cache intact. Find and Set may be called from
+// several setup threads at once.
+
+class ThreeSpaceDeviceCache
+{
+public:
+    // Replaces the contents with 'path'. A missing or unreadable file leaves the
+    // cache empty (a cold start); malformed lines are skipped.
+    bool    Load(const char* path);
+    bool    Save(const char* path) const;
+
+    bool    Find(UInt32 serialNumber, ThreeSpaceDeviceConfig* config) const;
+    // Adds or replaces the entry for config.SerialNumber. Any other sensor cached on
+    // the same port has moved, and is forgotten.
+    void    Set(const ThreeSpaceDeviceConfig& config);
+    // Forgets a sensor that could not be started where it was cached, so later
+    // starts do not keep expecting it.
+    void    Remove(UInt32 serialNumber);
+
+    // A copy of every entry, for opening the cached ports.
+    void    GetConfigs(Array<ThreeSpaceDeviceConfig>* configs) const;
+
+private:
+    mutable Mutex                   CacheLock;
+    Array<ThreeSpaceDeviceConfig>   Configs;
+};
+
+#endif
@@ -0,0 +1,136 @@
+/************************************************************************************
+
+Filename    :   ThreeSpace_Predictor.cpp
+Content     :   Orientation prediction for the 3-Space sensor from timestamped samples
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "ThreeSpace_Predictor.h"
+#include "../../LibOVR/Src/Kernel/OVR_Timer.h"
+
+// Gaps longer than this are treated as dropouts: the velocity estimate is restarted
+// and prediction never extrapolates further than this.
+static const float MaxSampleGap      = 0.1f;
+static const float MaxPredictionTime = 0.1f;
+
+// Rotation vector (axis * angle) of a unit quaternion, taking the short way round.
+static Vector3f quatToRotationVector(const Quatf& q)
+{
+    Vector3f v(q.x, q.y, q.z);
+    float    w = q.w;
+    if (w < 0)
+    {
+        v = -v;
+        w = -w;
+    }
+
+    float sinHalf = v.Length();
+    if (sinHalf < 1e-7f)
+        return v * 2.0f;    // Small angle: angle ~= 2 * sin(angle/2).
+    return v * (2.0f * atan2(sinHalf, w) / sinHalf);
+}
+
+static Quatf rotationVectorToQuat(const Vector3f& r)
+{
+    float angle = r.Length();
+    if (angle < 1e-7f)
+        return Quatf(r.x * 0.5f, r.y * 0.5f, r.z * 0.5f, 1.0f).Normalized();
+
+    float s = sin(angle * 0.5f) / angle;
+    return Quatf(r.x * s, r.y * s, r.z * s, cos(angle * 0.5f));
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** ThreeSpacePredictor
+
+ThreeSpacePredictor::ThreeSpacePredictor()
+    : SensorTimestamp(0), HostTicks(0), HaveSample(false),
+      AngularVelocity(0), HaveVelocity(false),
+      EnablePrediction(true), PredictionInterval(0.03f), VelocityFilterTime(0.01f)
+{
+}
+
+void ThreeSpacePredictor::Reset()
+{
+    HaveSample      = false;
+    HaveVelocity    = false;
+    AngularVelocity = Vector3f(0);
+}
+
+void ThreeSpacePredictor::AddSample(const ThreeSpaceSample& sample)
+{
+    const float* q = sample.Packet.quat;
+    Quatf orient   = Quatf(q[0], q[1], q[2], q[3]);
+
+    // Unsigned difference handles the sensor's 32-bit timestamp wrapping.
+    float dt = HaveSample ? (sample.SensorTimestamp - SensorTimestamp) * (1.0f / Timer::MksPerSecond) : 0.0f;
+    bool  continuous = HaveSample && dt > 0.0f && dt <= MaxSampleGap;
+
+    Vector3f omega;
+    bool     haveOmega = false;
+
+    if (sample.Channels & TSSChannel_GyroRate)
+    {
+        // Measured directly, so no differencing lag, and valid right after a dropout.
+        omega     = sample.GyroRate;
+        haveOmega = true;
+    }
+    else if (continuous)
+    {
+        // Body-frame rotation from the previous sample to this one.
+        omega     = quatToRotationVector(Orientation.Inverted() * orient) * (1.0f / dt);
+        haveOmega = true;
+    }
+
+    if (!haveOmega)
+    {
+        HaveVelocity    = false;
+        AngularVelocity = Vector3f(0);
+    }
+    else if (HaveVelocity && continuous)
+    {
+        float alpha = dt / (VelocityFilterTime + dt);
+        AngularVelocity += (omega - AngularVelocity) * alpha;
+    }
+    else
+    {
+        AngularVelocity = omega;
+        HaveVelocity    = true;
+    }
+
+    Orientation     = orient;
+    SensorTimestamp = sample.SensorTimestamp;
+    HostTicks       = sample.HostTicks;
+    HaveSample      = true;
+}
+
+Quatf ThreeSpacePredictor::GetPredictedOrientation(UInt64 hostTicks) const
+{
+    if (!EnablePrediction || !HaveVelocity)
+        return Orientation;
+
+    // Age of the newest sample plus the time until its photons are shown.
+    float sampleAge = (hostTicks > HostTicks) ?
+                      (float)(hostTicks - HostTicks) * (1.0f / Timer::MksPerSecond) : 0.0f;
+    float dt        = sampleAge + PredictionInterval;
+    if (dt > MaxPredictionTime)
+        dt = MaxPredictionTime;
+    if (dt <= 0.0f)
+        return Orientation;
+
+    return (Orientation * rotationVectorToQuat(AngularVelocity * dt)).Normalized();
+}
@@ -0,0 +1,86 @@
+/************************************************************************************
+
+Filename    :   ThreeSpace_Predictor.h
+Content     :   Orientation prediction for the 3-Space sensor from timestamped samples
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+#ifndef INC_ThreeSpace_Predictor_h
+#define INC_ThreeSpace_Predictor_h
+
+#include "../../LibOVR/Src/Kernel/OVR_Math.h"
+#include "ThreeSpace_Sample.h"
+
+//-------------------------------------------------------------------------------------
+// ***** ThreeSpacePredictor
+
+// Latency compensation for the 3-Space sensor, the counterpart of
+// SensorFusion::SetPredictionEnabled on the Rift path.
+//
+// Angular velocity is taken from the gyro channel when the source streams it, and
+// otherwise estimated from consecutive samples using their sensor timestamps
+// (TSS_TIMESTAMP_SENSOR, microseconds). It is low-pass filtered and used to
+// extrapolate the newest orientation to the expected photon time:
+//
+//   photon time = now + PredictionInterval
+//
+// so the extrapolation covers both the age of the newest sample and the time until
+// the frame being built reaches the display. All orientations are in the sensor's
+// own frame, as streamed.
+
+class ThreeSpacePredictor
+{
+public:
+    ThreeSpacePredictor();
+
+    // Feed every sample, oldest first.
+    void        AddSample(const ThreeSpaceSample& sample);
+    void        Reset();
+
+    bool        HasSample() const       { return HaveSample; }
+
+    // Newest orientation extrapolated to hostTicks (Timer::GetTicks()) + PredictionInterval.
+    // Returns the newest orientation unchanged when prediction is disabled.
+    Quatf       GetPredictedOrientation(UInt64 hostTicks) const;
+    Quatf       GetOrientation() const  { return Orientation; }
+
+    // Filtered angular velocity in the sensor's body frame, radians/second.
+    Vector3f    GetAngularVelocity() const { return AngularVelocity; }
+
+    // Time from the frame's sensor read to its photons leaving the display, in seconds.
+    void        SetPredictionInterval(float seconds) { PredictionInterval = seconds; }
+    float       GetPredictionInterval() const        { return PredictionInterval; }
+
+    void        SetPredictionEnabled(bool enable)    { EnablePrediction = enable; }
+    bool        IsPredictionEnabled() const          { return EnablePrediction; }
+
+    // Time constant of the angular velocity low-pass filter, in seconds.
+    void        SetVelocityFilterTime(float seconds) { VelocityFilterTime = seconds; }
+
+private:
+    Quatf       Orientation;
+    UInt32      SensorTimestamp;
+    UInt64      HostTicks;
+    bool        HaveSample;
+
+    Vector3f    AngularVelocity;
+    bool        HaveVelocity;
+
+    bool        EnablePrediction;
+    float       PredictionInterval;
+    float       VelocityFilterTime;
+};
+
+#endif
@@ -0,0 +1,176 @@
+/************************************************************************************
+
+Filename    :   ThreeSpace_Protocol.h
+Content     :   Subset of the YEI 3-Space binary serial protocol
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+#ifndef INC_ThreeSpace_Protocol_h
+#define INC_ThreeSpace_Protocol_h
+
+#include "../../LibOVR/Src/Kernel/OVR_Types.h"
+
+#include <string.h>
+
+using namespace OVR;
+
+//-------------------------------------------------------------------------------------
+// ***** Protocol Description
+
+// What the ThreeSpace API does underneath tss_setStreamingSlots, tss_startStreaming
+// and tss_getLatestStreamData, for talking to the sensor (or ThreeSpaceSimulator)
+// directly over a serial port where the API is not available.
+//
+// A command is   StartByte, Command, Data..., Checksum
+// where Checksum is the sum of Command and Data bytes, modulo 256. With
+// TSSStart_WithHeader the reply (and, for StartStreaming, every streamed packet)
+// is prefixed by the response header configured with SetResponseHeader.
+// All multi-byte values are big-endian.
+
+enum TSSStartByte
+{
+    TSSStart_Command    = 0xF7,
+    TSSStart_WithHeader = 0xF9
+};
+
+enum TSSCommand
+{
+    TSSCmd_GetTaredOrientationAsQuaternion = 0x00, // Reply: float x, y, z, w.
+    TSSCmd_GetCorrectedGyroRate            = 0x26, // Reply: float x, y, z, radians/s.
+    TSSCmd_GetCorrectedAccelerometerVector = 0x27, // Reply: float x, y, z, g.
+    TSSCmd_GetCorrectedCompassVector       = 0x28, // Reply: float x, y, z, gauss.
+    TSSCmd_GetConfidenceFactor             = 0x2D, // Reply: float 0..1.
+    TSSCmd_SetStreamingSlots               = 0x50, // Data:  8 command bytes, 0xFF unused.
+    TSSCmd_GetStreamingSlots               = 0x51, // Reply: 8 command bytes.
+    TSSCmd_SetStreamingTiming              = 0x52, // Data:  UInt32 interval, duration, delay (mks).
+    TSSCmd_GetStreamingTiming              = 0x53, // Reply: UInt32 interval, duration, delay (mks).
+    TSSCmd_StartStreaming                  = 0x55,
+    TSSCmd_StopStreaming                   = 0x56,
+    TSSCmd_TareWithCurrentOrientation      = 0x60,
+    TSSCmd_SetAxisDirections               = 0x74, // Data:  1 byte.
+    TSSCmd_GetAxisDirections               = 0x8F, // Reply: 1 byte.
+    TSSCmd_SetResponseHeader               = 0xDD, // Data:  UInt32 TSSHeaderBits.
+    TSSCmd_GetSerialNumber                 = 0xED  // Reply: UInt32.
+};
+
+// Response header fields, in the order they appear when enabled.
+enum TSSHeaderBits
+{
+    TSSHeader_Success    = 0x01, // 1 byte, 0 on success.
+    TSSHeader_Timestamp  = 0x02, // 4 bytes, sensor microseconds.
+    TSSHeader_Echo       = 0x04, // 1 byte, the command.
+    TSSHeader_Checksum   = 0x08, // 1 byte, sum of the data bytes.
+    TSSHeader_LogicalId  = 0x10, // 1 byte.
+    TSSHeader_Serial     = 0x20, // 4 bytes.
+    TSSHeader_DataLength = 0x40  // 1 byte.
+};
+
+enum
+{
+    TSS_StreamSlotCount    = 8,
+    TSS_InfiniteDuration   = 0xFFFFFFFF,
+    // The header ThreeSpaceSerialSource uses: enough to frame, validate and
+    // timestamp every packet.
+    TSS_StreamHeaderBits   = TSSHeader_Success | TSSHeader_Timestamp |
+                             TSSHeader_Checksum | TSSHeader_DataLength,
+    TSS_StreamHeaderSize   = 1 + 4 + 1 + 1,
+    TSS_QuaternionDataSize = 16,
+    TSS_Vector3DataSize    = 12,
+    TSS_FloatDataSize      = 4
+};
+
+// Number of data bytes a command carries.
+inline int TSSCommandDataSize(UByte command)
+{
+    switch (command)
+    {
+    case TSSCmd_SetStreamingSlots:  return TSS_StreamSlotCount;
+    case TSSCmd_SetStreamingTiming: return 12;
+    case TSSCmd_SetAxisDirections:  return 1;
+    case TSSCmd_SetResponseHeader:  return 4;
+    default:                        return 0;
+    }
+}
+
+// Number of data bytes a streamable command contributes to a stream packet;
+// 0 for commands that can not be streamed (and for 0xFF, an unused slot).
+inline int TSSStreamDataSize(UByte command)
+{
+    switch (command)
+    {
+    case TSSCmd_GetTaredOrientationAsQuaternion: return TSS_QuaternionDataSize;
+    case TSSCmd_GetCorrectedGyroRate:
+    case TSSCmd_GetCorrectedAccelerometerVector:
+    case TSSCmd_GetCorrectedCompassVector:       return TSS_Vector3DataSize;
+    case TSSCmd_GetConfidenceFactor:             return TSS_FloatDataSize;
+    default:                                     return 0;
+    }
+}
+
+inline UByte TSSChecksum(const UByte* data, UPInt size)
+{
+    UByte sum = 0;
+    for (UPInt i = 0; i < size; i++)
+        sum = UByte(sum + data[i]);
+    return sum;
+}
+
+// Big-endian field access.
+inline void TSSPutUInt32(UByte* p, UInt32 v)
+{
+    p[0] = UByte(v >> 24); p[1] = UByte(v >> 16); p[2] = UByte(v >> 8); p[3] = UByte(v);
+}
+inline UInt32 TSSGetUInt32(const UByte* p)
+{
+    return (UInt32(p[0]) << 24) | (UInt32(p[1]) << 16) | (UInt32(p[2]) << 8) | UInt32(p[3]);
+}
+inline void TSSPutFloat(UByte* p, float v)
+{
+    UInt32 bits;
+    memcpy(&bits, &v, sizeof(bits));
+    TSSPutUInt32(p, bits);
+}
+inline float TSSGetFloat(const UByte* p)
+{
+    UInt32 bits = TSSGetUInt32(p);
+    float  v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+// Every streamable value is made of 32-bit floats; converts stream data as it
+// arrives on the wire to the host order tss_getLatestStreamData returns.
+inline void TSSSwapStreamData(UByte* data, UPInt size)
+{
+    for (UPInt i = 0; i + 4 <= size; i += 4)
+    {
+        UInt32 v = TSSGetUInt32(data + i);
+        memcpy(data + i, &v, 4);
+    }
+}
+
+// Builds a command packet into 'out', which needs 3 + data bytes. Returns its size.
+inline UPInt TSSBuildCommand(UByte* out, TSSStartByte start, UByte command,
+                             const UByte* data = 0, UPInt dataSize = 0)
+{
+    out[0] = UByte(start);
+    out[1] = command;
+    if (dataSize)
+        memcpy(out + 2, data, dataSize);
+    out[2 + dataSize] = TSSChecksum(out + 1, dataSize + 1);
+    return 3 + dataSize;
+}
+
+#endif
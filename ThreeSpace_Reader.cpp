@@ -0,0 +1,84 @@
+/************************************************************************************
+
+Filename    :   ThreeSpace_Reader.cpp
+Content     :   Background reader thread for the YEI 3-Space sensor stream
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "ThreeSpace_Reader.h"
+#include "Util_Trace.h"
+#include "Util_AsyncLog.h"
+#include "../../LibOVR/Src/Kernel/OVR_Alg.h"
+#include "../../LibOVR/Src/Kernel/OVR_Log.h"
+#include "../../LibOVR/Src/Kernel/OVR_Timer.h"
+
+//-------------------------------------------------------------------------------------
+// ***** ThreeSpaceReader
+
+ThreeSpaceReader::ThreeSpaceReader(ThreeSpaceSource* source, ThreeSpaceRecorder* recorder)
+    : pSource(source), pRecorder(recorder), ErrorCount(0)
+{
+}
+
+void ThreeSpaceReader::Stop()
+{
+    SetExitFlag(true);
+    while (!IsFinished())
+        Thread::MSleep(1);
+}
+
+int ThreeSpaceReader::Run()
+{
+    ThreeSpaceSample sample;
+    unsigned         backoffMs = 0;
+
+    Trace::SetThreadName("ThreeSpace Reader");
+
+    while (!GetExitFlag())
+    {
+        UInt64 readStart = Trace::IsEnabled() ? Timer::GetTicks() : 0;
+        ThreeSpaceSource::ReadResult result = pSource->ReadSample(&sample, ReadTimeoutMs);
+
+        if (result == ThreeSpaceSource::Read_Sample)
+        {
+            // Only reads that produced a sample; polling for one is not interesting.
+            if (readStart)
+                Trace::Complete("TSS ReadSample", readStart, Timer::GetTicks());
+
+            Samples.Push(sample);
+            if (pRecorder)
+                pRecorder->Record(sample);
+            backoffMs = 0;
+        }
+        else if (result == ThreeSpaceSource::Read_Error)
+        {
+            ErrorCount.ExchangeAdd_NoSync(1);
+            AsyncLogText("TSS: getLatestStreamData error\n");
+
+            backoffMs = backoffMs ? Alg::Min(backoffMs * 2, (unsigned)MaxErrorBackoffMs) : 1;
+            Thread::MSleep(backoffMs);
+        }
+        else if (result == ThreeSpaceSource::Read_EndOfStream)
+        {
+            AsyncLogText("TSS: End of stream after %u samples\n", Samples.GetWriteCount());
+            break;
+        }
+    }
+
+    if (pRecorder)
+        pRecorder->Flush();
+    return 0;
+}
@@ -0,0 +1,75 @@
+/************************************************************************************
+
+Filename    :   ThreeSpace_Reader.h
+Content     :   Background reader thread for the YEI 3-Space sensor stream
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+#ifndef INC_ThreeSpace_Reader_h
+#define INC_ThreeSpace_Reader_h
+
+#include "../../LibOVR/Src/Kernel/OVR_Threads.h"
+#include "Util_SampleRing.h"
+#include "ThreeSpace_Sample.h"
+#include "ThreeSpace_Recording.h"
+
+
+//-------------------------------------------------------------------------------------
+// ***** ThreeSpaceReader
+
+// Reads a ThreeSpaceSource on its own thread, so that slow serial reads never stall
+// the render thread. Every new sample is published into a SampleRing; the render
+// thread only ever does a wait-free GetLatest().
+//
+// If a recorder is given, every sample is also appended to it from the reader thread.
+// The thread exits on its own once the source reports end of stream.
+
+class ThreeSpaceReader : public Thread
+{
+public:
+    ThreeSpaceReader(ThreeSpaceSource* source, ThreeSpaceRecorder* recorder = 0);
+
+    // Signals the reader thread to exit and waits until it has.
+    void            Stop();
+
+    // Copies the newest sample; returns false if nothing has been read yet.
+    bool            GetLatest(ThreeSpaceSample* sample) const { return Samples.PeekLatest(sample); }
+    // Returns samples oldest-first, for consumers that need every sample.
+    // Like GetLatest, must only be called from the one consumer thread.
+    bool            PopSample(ThreeSpaceSample* sample)       { return Samples.Pop(sample); }
+
+    UInt32          GetSampleCount() const { return Samples.GetWriteCount(); }
+    UInt32          GetErrorCount() const  { return ErrorCount.Load_Acquire(); }
+
+protected:
+    virtual int     Run();
+
+private:
+    enum
+    {
+        // Upper bound on how long a single read may block, so Stop() stays responsive.
+        ReadTimeoutMs       = 100,
+        // Failed reads usually fail fast (an unplugged sensor), so the reader sleeps
+        // after each, doubling from 1 ms up to this while they keep failing.
+        MaxErrorBackoffMs   = 8
+    };
+
+    Ptr<ThreeSpaceSource>               pSource;
+    Ptr<ThreeSpaceRecorder>             pRecorder;
+    SampleRing<ThreeSpaceSample, 64>    Samples;
+    AtomicInt<UInt32>                   ErrorCount;
+};
+
+#endif
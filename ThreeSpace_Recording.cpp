@@ -0,0 +1,319 @@
+/************************************************************************************
+
+Filename    :   ThreeSpace_Recording.cpp
+Content     :   Binary recording and replay of 3-Space stream samples
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "ThreeSpace_Recording.h"
+#include "../../LibOVR/Src/Kernel/OVR_Threads.h"
+#include "../../LibOVR/Src/Kernel/OVR_Timer.h"
+#include "../../LibOVR/Src/Kernel/OVR_Log.h"
+
+static const char RecordingMagic[4] = { 'T', 'S', 'S', 'R' };
+
+static bool isValidHeader(const ThreeSpaceRecordingHeader& header)
+{
+    return memcmp(header.Magic, RecordingMagic, sizeof(RecordingMagic)) == 0 &&
+           header.Version >= 1 && header.Version <= ThreeSpaceRecording_Version &&
+           header.RecordSize == sizeof(ThreeSpaceRecord) &&
+           header.HostTicksPerSecond != 0;
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** ThreeSpaceRecorder
+
+ThreeSpaceRecorder::ThreeSpaceRecorder()
+    : pFile(0), RecordCount(0)
+{
+}
+
+ThreeSpaceRecorder::~ThreeSpaceRecorder()
+{
+    Close();
+}
+
+bool ThreeSpaceRecorder::Open(const char* path)
+{
+    Close();
+
+    // Check what is already there before appending to it.
+    long existingSize = 0;
+    if (FILE* existing = fopen(path, "r+b"))
+    {
+        ThreeSpaceRecordingHeader header;
+        fseek(existing, 0, SEEK_END);
+        existingSize = ftell(existing);
+        fseek(existing, 0, SEEK_SET);
+
+        bool valid = (existingSize == 0) ||
+                     (fread(&header, sizeof(header), 1, existing) == 1 && isValidHeader(header) &&
+                      (existingSize - (long)sizeof(header)) % sizeof(ThreeSpaceRecord) == 0);
+
+        // A version 1 file is upgraded in place before it gets its first marker.
+        if (valid && existingSize && header.Version < ThreeSpaceRecording_Version)
+        {
+            header.Version = ThreeSpaceRecording_Version;
+            fseek(existing, 0, SEEK_SET);
+            valid = (fwrite(&header, sizeof(header), 1, existing) == 1);
+        }
+        fclose(existing);
+
+        if (!valid)
+        {
+            LogText("TSS: %s is not a compatible recording; not appending to it\n", path);
+            return false;
+        }
+    }
+
+    pFile = fopen(path, "ab");
+    if (!pFile)
+    {
+        LogText("TSS: Failed to open recording %s\n", path);
+        return false;
+    }
+    setvbuf(pFile, 0, _IOFBF, 64 * 1024);
+
+    if (existingSize == 0)
+    {
+        ThreeSpaceRecordingHeader header;
+        memcpy(header.Magic, RecordingMagic, sizeof(RecordingMagic));
+        header.Version            = ThreeSpaceRecording_Version;
+        header.RecordSize         = sizeof(ThreeSpaceRecord);
+        header.HostTicksPerSecond = Timer::MksPerSecond;
+        fwrite(&header, sizeof(header), 1, pFile);
+    }
+    else if (existingSize > (long)sizeof(ThreeSpaceRecordingHeader))
+    {
+        ThreeSpaceRecord marker;
+        memset(&marker, 0, sizeof(marker));
+        marker.HostTicks = ThreeSpaceRecord_SessionMarker;
+        fwrite(&marker, sizeof(marker), 1, pFile);
+    }
+
+    RecordCount = 0;
+    return true;
+}
+
+void ThreeSpaceRecorder::Close()
+{
+    if (pFile)
+    {
+        fclose(pFile);
+        pFile = 0;
+    }
+}
+
+void ThreeSpaceRecorder::Record(const ThreeSpaceSample& sample)
+{
+    if (!pFile)
+        return;
+
+    ThreeSpaceRecord record;
+    record.Packet          = sample.Packet;
+    record.SensorTimestamp = sample.SensorTimestamp;
+    record.HostTicks       = sample.HostTicks;
+
+    if (fwrite(&record, sizeof(record), 1, pFile) == 1)
+        RecordCount++;
+}
+
+void ThreeSpaceRecorder::Flush()
+{
+    if (pFile)
+        fflush(pFile);
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** ThreeSpaceReplaySource
+
+ThreeSpaceReplaySource::ThreeSpaceReplaySource()
+    : pRecords(0), RecordCount(0), HostTicksPerSecond(Timer::MksPerSecond),
+      SpanTicks(0), LoopGapTicks(0),
+      Pacing(Replay_RealTime), Loop(false),
+      NextRecord(0), StartTicks(0), Started(false)
+{
+}
+
+bool ThreeSpaceReplaySource::Open(const char* path)
+{
+    pRecords    = 0;
+    RecordCount = 0;
+    NextRecord  = 0;
+    Started     = false;
+
+    if (!File.Open(path))
+    {
+        LogText("TSS: Failed to open recording %s\n", path);
+        return false;
+    }
+
+    const ThreeSpaceRecordingHeader* header = (const ThreeSpaceRecordingHeader*)File.GetData();
+    if (File.GetSize() < sizeof(ThreeSpaceRecordingHeader) || !isValidHeader(*header))
+    {
+        LogText("TSS: %s is not a compatible recording\n", path);
+        File.Close();
+        return false;
+    }
+
+    // A torn final record (from a crash while recording) is ignored.
+    pRecords           = (const ThreeSpaceRecord*)(File.GetData() + sizeof(ThreeSpaceRecordingHeader));
+    RecordCount        = (File.GetSize() - sizeof(ThreeSpaceRecordingHeader)) / sizeof(ThreeSpaceRecord);
+    HostTicksPerSecond = header->HostTicksPerSecond;
+    UPInt samples = findSessions();
+
+    LogText("TSS: Replaying %u samples in %u sessions from %s\n", (unsigned)samples,
+            (unsigned)Sessions.GetSize(), path);
+    return true;
+}
+
+// Splits the records into sessions and lays them end to end on one timeline.
+// Returns the number of samples.
+UPInt ThreeSpaceReplaySource::findSessions()
+{
+    // Sample interval assumed for a session with only one sample.
+    const UInt64 defaultIntervalTicks = 1000;
+
+    Sessions.Clear();
+    SpanTicks    = 0;
+    LoopGapTicks = defaultIntervalTicks;
+
+    UPInt  samples = 0, sessionSamples = 0;
+    UInt64 lastHostTicks = 0;
+    bool   marker = false;
+    for (UPInt i = 0; i < RecordCount; i++)
+    {
+        const ThreeSpaceRecord& record = pRecords[i];
+        if (IsSessionMarker(record))
+        {
+            marker = true;
+            continue;
+        }
+
+        if (samples == 0 || marker || record.HostTicks < lastHostTicks)
+        {
+            Session session;
+            session.First          = i;
+            session.FirstHostTicks = record.HostTicks;
+            session.StartTicks     = 0;
+            if (Sessions.GetSize())
+            {
+                // One of the previous session's average intervals after its end.
+                const Session& last = Sessions.Back();
+                UInt64 lastSpan     = toTimerTicks(lastHostTicks - last.FirstHostTicks);
+                session.StartTicks  = last.StartTicks + lastSpan +
+                                      ((sessionSamples > 1) ? lastSpan / (sessionSamples - 1)
+                                                            : defaultIntervalTicks);
+            }
+            Sessions.PushBack(session);
+            sessionSamples = 0;
+            marker         = false;
+        }
+
+        lastHostTicks = record.HostTicks;
+        sessionSamples++;
+        samples++;
+    }
+
+    if (samples)
+    {
+        const Session& last = Sessions.Back();
+        SpanTicks = last.StartTicks + toTimerTicks(lastHostTicks - last.FirstHostTicks);
+        if (samples > 1)
+            LoopGapTicks = SpanTicks / (samples - 1);
+    }
+    return samples;
+}
+
+UInt64 ThreeSpaceReplaySource::toTimerTicks(UInt64 hostTicks) const
+{
+    if (HostTicksPerSecond == Timer::MksPerSecond)
+        return hostTicks;
+    return (UInt64)((double)hostTicks * Timer::MksPerSecond / (double)HostTicksPerSecond);
+}
+
+UInt64 ThreeSpaceReplaySource::recordTicks(UPInt i) const
+{
+    // The last session starting at or before i.
+    UPInt lo = 0, hi = Sessions.GetSize();
+    while (hi - lo > 1)
+    {
+        UPInt mid = (lo + hi) / 2;
+        if (Sessions[mid].First <= i)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    const Session& session = Sessions[lo];
+    return session.StartTicks + toTimerTicks(pRecords[i].HostTicks - session.FirstHostTicks);
+}
+
+UPInt ThreeSpaceReplaySource::skipMarkers(UPInt i) const
+{
+    while (i < RecordCount && IsSessionMarker(pRecords[i]))
+        i++;
+    return i;
+}
+
+ThreeSpaceSource::ReadResult ThreeSpaceReplaySource::ReadSample(ThreeSpaceSample* sample,
+                                                                unsigned timeoutMs)
+{
+    if (Sessions.GetSize() == 0)
+        return Read_EndOfStream;
+
+    if (!Started)
+    {
+        StartTicks = Timer::GetTicks();
+        Started    = true;
+    }
+
+    NextRecord = skipMarkers(NextRecord);
+    if (NextRecord == RecordCount)
+    {
+        if (!Loop)
+            return Read_EndOfStream;
+
+        // Continue the timeline one average sample interval after the last record.
+        StartTicks += SpanTicks + LoopGapTicks;
+        NextRecord  = skipMarkers(0);
+    }
+
+    UInt64 dueTicks = StartTicks + recordTicks(NextRecord);
+
+    if (Pacing == Replay_RealTime)
+    {
+        UInt64 now = Timer::GetTicks();
+        if (now < dueTicks)
+        {
+            UInt64 waitMs = (dueTicks - now) / 1000;
+            if (waitMs > timeoutMs)
+            {
+                Thread::MSleep(timeoutMs);
+                return Read_NoSample;
+            }
+            Thread::MSleep((unsigned)waitMs);
+        }
+    }
+
+    const ThreeSpaceRecord& record = pRecords[NextRecord++];
+    sample->Packet          = record.Packet;
+    sample->SensorTimestamp = record.SensorTimestamp;
+    sample->HostTicks       = dueTicks;
+    sample->Channels        = 0;
+    return Read_Sample;
+}
@@ -0,0 +1,169 @@
+/************************************************************************************
+
+Filename    :   ThreeSpace_Recording.h
+Content     :   Binary recording and replay of 3-Space stream samples
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+#ifndef INC_ThreeSpace_Recording_h
+#define INC_ThreeSpace_Recording_h
+
+#include <stdio.h>
+
+#include "ThreeSpace_Sample.h"
+#include "Util_MappedFile.h"
+#include "../../LibOVR/Src/Kernel/OVR_Array.h"
+
+//-------------------------------------------------------------------------------------
+// ***** Recording file format
+
+// A recording is a fixed header followed by fixed-size records, one per sample,
+// in the order they were read. All fields are little-endian. Files are only ever
+// appended to, so a recording interrupted by a crash loses at most its last record.
+//
+// Each ThreeSpaceRecorder::Open() onto an existing recording starts a new session
+// with a marker record (HostTicks == ThreeSpaceRecord_SessionMarker). Host times
+// only mean something within a session: the next one may be hours later or after
+// a reboot, when they start again near zero. Version 1 files have no markers.
+
+#pragma pack(push,1)
+struct ThreeSpaceRecordingHeader
+{
+    char                Magic[4];           // "TSSR"
+    UInt16              Version;
+    UInt16              RecordSize;         // sizeof(ThreeSpaceRecord) when written.
+    UInt64              HostTicksPerSecond; // Unit of ThreeSpaceRecord::HostTicks.
+};
+
+struct ThreeSpaceRecord
+{
+    tss_stream_packet   Packet;
+    UInt32              SensorTimestamp;
+    UInt64              HostTicks;          // Host QPC-based Timer time, see HostTicksPerSecond.
+};
+#pragma pack(pop)
+
+enum { ThreeSpaceRecording_Version = 2 };
+
+static const UInt64 ThreeSpaceRecord_SessionMarker = ~UInt64(0);
+
+inline bool IsSessionMarker(const ThreeSpaceRecord& record)
+{
+    return record.HostTicks == ThreeSpaceRecord_SessionMarker;
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** ThreeSpaceRecorder
+
+// Appends samples to a recording file. Record() is called from the reader thread
+// and only touches the stdio buffer; data reaches the disk on Flush() or Close().
+
+class ThreeSpaceRecorder : public RefCountBase<ThreeSpaceRecorder>
+{
+public:
+    ThreeSpaceRecorder();
+    ~ThreeSpaceRecorder();
+
+    // Opens 'path' for appending, writing a header if the file is new and a session
+    // marker if it is not. Fails if the file exists but is not a compatible recording.
+    bool        Open(const char* path);
+    void        Close();
+
+    void        Record(const ThreeSpaceSample& sample);
+    void        Flush();
+
+    UInt32      GetRecordCount() const { return RecordCount; }
+
+private:
+    FILE*       pFile;
+    UInt32      RecordCount;
+};
+
+
+//-------------------------------------------------------------------------------------
+// ***** ThreeSpaceReplaySource
+
+// Plays a recording back through the memory mapped file, so it can stand in for the
+// live device anywhere a ThreeSpaceSource is accepted.
+//
+// Replayed samples keep their recorded sensor timestamps. Host times are rebased to
+// the moment playback started, preserving the recorded spacing between samples; in
+// Replay_RealTime mode samples are also released at that pace. Sessions play one
+// after another, each starting one of the previous session's average sample
+// intervals after its last sample, whatever the gap between them when recorded.
+// A session starts after a marker, or where host time goes backwards (a reboot
+// between sessions of a version 1 file).
+
+class ThreeSpaceReplaySource : public ThreeSpaceSource
+{
+public:
+    enum PacingMode
+    {
+        Replay_RealTime,        // Release samples at their recorded host times.
+        Replay_AsFastAsPossible // Release samples as fast as they are read.
+    };
+
+    ThreeSpaceReplaySource();
+
+    bool                    Open(const char* path);
+
+    void                    SetPacing(PacingMode pacing) { Pacing = pacing; }
+    void                    SetLoop(bool loop)           { Loop = loop; }
+
+    virtual ReadResult      ReadSample(ThreeSpaceSample* sample, unsigned timeoutMs);
+
+    // Random access to the mapped records, for offline processing. Includes the
+    // session markers; see IsSessionMarker().
+    UPInt                   GetRecordCount() const { return RecordCount; }
+    const ThreeSpaceRecord* GetRecords() const     { return pRecords; }
+    UInt64                  GetHostTicksPerSecond() const { return HostTicksPerSecond; }
+
+    UPInt                   GetSessionCount() const { return Sessions.GetSize(); }
+
+private:
+    struct Session
+    {
+        UPInt   First;          // First sample record.
+        UInt64  FirstHostTicks; // Its recorded HostTicks.
+        UInt64  StartTicks;     // Its time on the replay timeline.
+    };
+
+    UPInt                   findSessions();
+    UInt64                  toTimerTicks(UInt64 hostTicks) const;
+    // Time of sample record i on the replay timeline, in Timer::GetTicks() units,
+    // relative to the first sample.
+    UInt64                  recordTicks(UPInt i) const;
+    // The next sample record at or after i, or RecordCount.
+    UPInt                   skipMarkers(UPInt i) const;
+
+    MappedFile              File;
+    const ThreeSpaceRecord* pRecords;
+    UPInt                   RecordCount;
+    UInt64                  HostTicksPerSecond;
+    Array<Session>          Sessions;
+    // Replay timeline time of the last sample, and from it to the first sample of
+    // the next loop.
+    UInt64                  SpanTicks;
+    UInt64                  LoopGapTicks;
+
+    PacingMode              Pacing;
+    bool                    Loop;
+    UPInt                   NextRecord;
+    UInt64                  StartTicks;     // Host time playback of the current loop began.
+    bool                    Started;
+};
+
+#endif
@@ -0,0 +1,108 @@
+/************************************************************************************
+
+Filename    :   ThreeSpace_Sample.h
+Content     :   3-Space stream sample type and the source interface that produces it
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+#ifndef INC_ThreeSpace_Sample_h
+#define INC_ThreeSpace_Sample_h
+
+#include "../../LibOVR/Src/Kernel/OVR_Types.h"
+#include "../../LibOVR/Src/Kernel/OVR_RefCount.h"
+#include "ThreeSpace_StreamLayout.h"
+
+using namespace OVR;
+
+//When getting stream data use a packed structure
+#pragma pack(push,1)
+typedef struct {
+    float quat[4];
+} tss_stream_packet;
+#pragma pack(pop)
+
+// The slots OnStartup streams from the live sensor: orientation plus the raw
+// channels prediction can use, all in one packet per sensor update.
+typedef TSSStreamLayout<TSSSlot_TaredQuaternion, TSSSlot_CorrectedGyroRate,
+                        TSSSlot_CorrectedAccelerometer, TSSSlot_ConfidenceFactor> ThreeSpaceStreamLayout;
+
+// Channels of a ThreeSpaceSample beyond the orientation.
+enum ThreeSpaceChannel
+{
+    TSSChannel_GyroRate      = 0x01,
+    TSSChannel_Acceleration  = 0x02,
+    TSSChannel_Confidence    = 0x04
+};
+
+// One stream packet as published by the reader thread.
+struct ThreeSpaceSample
+{
+    tss_stream_packet   Packet;
+    unsigned int        SensorTimestamp; // tss_timestamp; microseconds, sensor clock.
+    UInt64              HostTicks;       // Timer::GetTicks() when the packet was read.
+
+    // Only what the source streams is valid; recordings only hold the orientation.
+    UInt32              Channels;        // ThreeSpaceChannel bits.
+    Vector3f            GyroRate;
+    Vector3f            Acceleration;
+    float               Confidence;
+
+    ThreeSpaceSample() : SensorTimestamp(0), HostTicks(0), Channels(0), Confidence(0) { }
+
+    // Fills Packet and the channels 'packet' carries from stream data.
+    template<class Layout>
+    void SetStreamData(const typename Layout::Packet& packet)
+    {
+        Quatf q = packet.template Get<TSSSlot_TaredQuaternion>();
+        Packet.quat[0] = q.x;
+        Packet.quat[1] = q.y;
+        Packet.quat[2] = q.z;
+        Packet.quat[3] = q.w;
+
+        Channels = 0;
+        if (packet.template TryGet<TSSSlot_CorrectedGyroRate>(&GyroRate))
+            Channels |= TSSChannel_GyroRate;
+        if (packet.template TryGet<TSSSlot_CorrectedAccelerometer>(&Acceleration))
+            Channels |= TSSChannel_Acceleration;
+        if (packet.template TryGet<TSSSlot_ConfidenceFactor>(&Confidence))
+            Channels |= TSSChannel_Confidence;
+    }
+};
+
+
+//-------------------------------------------------------------------------------------
+// ***** ThreeSpaceSource
+
+// Anything that can produce stream samples for a ThreeSpaceReader: the live device,
+// a recorded session, etc. ReadSample is only ever called from the reader thread.
+
+class ThreeSpaceSource : public RefCountBase<ThreeSpaceSource>
+{
+public:
+    enum ReadResult
+    {
+        Read_Sample,        // 'sample' holds a packet not returned before.
+        Read_NoSample,      // Nothing new within the timeout.
+        Read_Error,         // The source reported an error; try again shortly.
+        Read_EndOfStream    // The source is exhausted; stop reading.
+    };
+
+    virtual ~ThreeSpaceSource() { }
+
+    // Waits at most timeoutMs for a new sample.
+    virtual ReadResult ReadSample(ThreeSpaceSample* sample, unsigned timeoutMs) = 0;
+};
+
+#endif
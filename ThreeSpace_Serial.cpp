@@ -0,0 +1,266 @@
+/************************************************************************************
+
+Filename    :   ThreeSpace_Serial.cpp
+Content     :   YEI 3-Space sensor over a POSIX serial port as a ThreeSpaceSource
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "ThreeSpace_Serial.h"
+#include "../../LibOVR/Src/Kernel/OVR_Timer.h"
+#include "../../LibOVR/Src/Kernel/OVR_Log.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <errno.h>
+
+//-------------------------------------------------------------------------------------
+// ***** ThreeSpaceSerialSource
+
+ThreeSpaceSerialSource::ThreeSpaceSerialSource()
+    : pCache(0), Fd(-1), BufferStart(0), BufferEnd(0), SerialNumber(0), ResyncCount(0),
+      Streaming(false)
+{
+}
+
+ThreeSpaceSerialSource::~ThreeSpaceSerialSource()
+{
+    Close();
+}
+
+bool ThreeSpaceSerialSource::Open(const char* path, UInt32 intervalMks, bool tare)
+{
+    Close();
+
+    Fd = open(path, O_RDWR | O_NOCTTY);
+    if (Fd < 0)
+    {
+        LogText("TSS: Can't open %s\n", path);
+        return false;
+    }
+
+    // Raw 8N1; the baud rate only matters for real USB-serial adapters.
+    termios tio;
+    if (tcgetattr(Fd, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        cfsetispeed(&tio, B115200);
+        cfsetospeed(&tio, B115200);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tcsetattr(Fd, TCSANOW, &tio);
+    }
+
+    // The sensor may still be streaming from a previous session; stop it and
+    // throw away whatever it sent.
+    sendCommand(TSSStart_Command, TSSCmd_StopStreaming);
+    usleep(20000);
+    tcflush(Fd, TCIFLUSH);
+    BufferStart = BufferEnd = 0;
+
+    UByte header[4];
+    TSSPutUInt32(header, TSS_StreamHeaderBits);
+    sendCommand(TSSStart_Command, TSSCmd_SetResponseHeader, header, sizeof(header));
+
+    // Serial number doubles as a check that the sensor answers at all, and picks
+    // the cache entry.
+    UByte  reply[MaxFrameDataSize];
+    UInt32 timestamp;
+    sendCommand(TSSStart_WithHeader, TSSCmd_GetSerialNumber);
+    if (readFrame(reply, &timestamp, CommandTimeoutMs) != 4)
+    {
+        LogText("TSS: No response from sensor on %s\n", path);
+        Close();
+        return false;
+    }
+    SerialNumber = TSSGetUInt32(reply);
+
+    // Axis directions are left as the sensor has them.
+    ThreeSpaceDeviceConfig config;
+    config.SerialNumber = SerialNumber;
+    config.Port         = path;
+    config.IntervalMks  = intervalMks;
+    ThreeSpaceStreamLayout::GetSlots(config.Slots);
+
+    UByte timing[12];
+    TSSPutUInt32(timing + 0, intervalMks);
+    TSSPutUInt32(timing + 4, TSS_InfiniteDuration);
+    TSSPutUInt32(timing + 8, 0);
+
+    // If this sensor was given these settings last time, it most likely still
+    // has them: check, and only send what differs.
+    ThreeSpaceDeviceConfig cached;
+    bool warm     = pCache && pCache->Find(SerialNumber, &cached) && cached.SameSettings(config);
+    bool slotsSet = false, timingSet = false;
+    if (warm)
+    {
+        sendCommand(TSSStart_WithHeader, TSSCmd_GetStreamingSlots);
+        slotsSet  = readFrame(reply, &timestamp, CommandTimeoutMs) == TSS_StreamSlotCount &&
+                    memcmp(reply, config.Slots, TSS_StreamSlotCount) == 0;
+        sendCommand(TSSStart_WithHeader, TSSCmd_GetStreamingTiming);
+        timingSet = readFrame(reply, &timestamp, CommandTimeoutMs) == (int)sizeof(timing) &&
+                    memcmp(reply, timing, sizeof(timing)) == 0;
+    }
+
+    if (!slotsSet)
+        sendCommand(TSSStart_Command, TSSCmd_SetStreamingSlots, config.Slots, sizeof(config.Slots));
+    if (!timingSet)
+        sendCommand(TSSStart_Command, TSSCmd_SetStreamingTiming, timing, sizeof(timing));
+    if (tare)
+        sendCommand(TSSStart_Command, TSSCmd_TareWithCurrentOrientation);
+
+    // Starting with a header makes every streamed packet carry one.
+    sendCommand(TSSStart_WithHeader, TSSCmd_StartStreaming);
+    if (readFrame(reply, &timestamp, CommandTimeoutMs) != 0)
+    {
+        LogText("TSS: Start streaming failed on %s\n", path);
+        Close();
+        return false;
+    }
+    Streaming = true;
+
+    if (pCache)
+        pCache->Set(config);
+
+    LogText("TSS: Streaming from %s, serial %x (%s)\n", path, SerialNumber,
+            !warm ? "configured" : (slotsSet && timingSet) ? "cached configuration verified"
+                                                          : "cached configuration was stale");
+    return true;
+}
+
+void ThreeSpaceSerialSource::Close()
+{
+    if (Fd < 0)
+        return;
+
+    if (Streaming)
+        sendCommand(TSSStart_Command, TSSCmd_StopStreaming);
+    Streaming = false;
+
+    close(Fd);
+    Fd = -1;
+    BufferStart = BufferEnd = 0;
+}
+
+bool ThreeSpaceSerialSource::sendCommand(TSSStartByte start, UByte command,
+                                         const UByte* data, UPInt dataSize)
+{
+    UByte  packet[3 + 16];
+    UPInt  size = TSSBuildCommand(packet, start, command, data, dataSize);
+    return write(Fd, packet, size) == (ssize_t)size;
+}
+
+int ThreeSpaceSerialSource::fill(unsigned timeoutMs)
+{
+    // Compact, then read as much as fits.
+    if (BufferStart)
+    {
+        memmove(Buffer, Buffer + BufferStart, BufferEnd - BufferStart);
+        BufferEnd  -= BufferStart;
+        BufferStart = 0;
+    }
+
+    pollfd pfd;
+    pfd.fd      = Fd;
+    pfd.events  = POLLIN;
+    pfd.revents = 0;
+
+    int ready = poll(&pfd, 1, (int)timeoutMs);
+    if (ready == 0 || (ready < 0 && errno == EINTR))
+        return 0;
+    if (ready < 0 || ((pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) && !(pfd.revents & POLLIN)))
+        return -1;
+
+    ssize_t n = read(Fd, Buffer + BufferEnd, BufferSize - BufferEnd);
+    if (n < 0)
+        return (errno == EAGAIN || errno == EINTR) ? 0 : -1;
+    if (n == 0)
+        return -1;
+
+    BufferEnd += n;
+    return (int)n;
+}
+
+int ThreeSpaceSerialSource::readFrame(UByte* data, UInt32* timestamp, unsigned timeoutMs)
+{
+    UInt64 deadline = Timer::GetTicks() + UInt64(timeoutMs) * 1000;
+
+    for (;;)
+    {
+        // Header: success, timestamp, checksum, data length.
+        while (BufferEnd - BufferStart >= TSS_StreamHeaderSize)
+        {
+            const UByte* p      = Buffer + BufferStart;
+            UByte        length = p[6];
+
+            if (p[0] != 0 || length > MaxFrameDataSize)
+            {
+                BufferStart++;
+                ResyncCount++;
+                continue;
+            }
+            if (BufferEnd - BufferStart < UPInt(TSS_StreamHeaderSize + length))
+                break;
+
+            const UByte* payload = p + TSS_StreamHeaderSize;
+            if (TSSChecksum(payload, length) != p[5])
+            {
+                BufferStart++;
+                ResyncCount++;
+                continue;
+            }
+
+            *timestamp = TSSGetUInt32(p + 1);
+            memcpy(data, payload, length);
+            BufferStart += TSS_StreamHeaderSize + length;
+            return length;
+        }
+
+        UInt64 now = Timer::GetTicks();
+        if (now >= deadline)
+            return -1;
+
+        int got = fill(unsigned((deadline - now + 999) / 1000));
+        if (got < 0)
+            return -2;
+    }
+}
+
+ThreeSpaceSource::ReadResult ThreeSpaceSerialSource::ReadSample(ThreeSpaceSample* sample,
+                                                                unsigned timeoutMs)
+{
+    if (Fd < 0)
+        return Read_EndOfStream;
+
+    ThreeSpaceStreamLayout::Packet packet;
+    UByte  data[MaxFrameDataSize];
+    UInt32 timestamp;
+    int    length = readFrame(data, &timestamp, timeoutMs);
+
+    if (length == -1)
+        return Read_NoSample;
+    // The reader backs off after errors, so a port error is not retried at once.
+    if (length != ThreeSpaceStreamLayout::PacketSize)
+        return Read_Error;
+
+    memcpy(packet.Data, data, ThreeSpaceStreamLayout::PacketSize);
+    TSSSwapStreamData(packet.Data, ThreeSpaceStreamLayout::PacketSize);
+
+    sample->SetStreamData<ThreeSpaceStreamLayout>(packet);
+    sample->SensorTimestamp = timestamp;
+    sample->HostTicks       = Timer::GetTicks();
+    return Read_Sample;
+}
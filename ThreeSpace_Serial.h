@@ -0,0 +1,84 @@
+/************************************************************************************
+
+Filename    :   ThreeSpace_Serial.h
+Content     :   YEI 3-Space sensor over a POSIX serial port as a ThreeSpaceSource
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+#ifndef INC_ThreeSpace_Serial_h
+#define INC_ThreeSpace_Serial_h
+
+#include "ThreeSpace_Sample.h"
+#include "ThreeSpace_Protocol.h"
+#include "ThreeSpace_DeviceCache.h"
+
+//-------------------------------------------------------------------------------------
+// ***** ThreeSpaceSerialSource
+
+// Streams ThreeSpaceStreamLayout's slots from a sensor on a serial port, speaking
+// the binary protocol directly. This is the Linux counterpart of ThreeSpaceDeviceSource
+// (which needs the Windows-only ThreeSpace API), and also talks to a
+// ThreeSpaceSimulator through its pty.
+//
+// Open() performs the same setup OnStartup does through the API: streaming slots,
+// streaming timing, tare and start streaming. Packets are framed by their
+// response header and validated by checksum; on a bad frame the reader drops a
+// byte and resynchronizes.
+//
+// With a device cache, a sensor that was given the same settings before is only
+// asked for its streaming slots and timing, and sent just the ones that changed.
+
+class ThreeSpaceSerialSource : public ThreeSpaceSource
+{
+public:
+    ThreeSpaceSerialSource();
+    ~ThreeSpaceSerialSource();
+
+    // Optional; must outlive Open(), which looks the sensor up in it and records it.
+    void                SetDeviceCache(ThreeSpaceDeviceCache* cache) { pCache = cache; }
+
+    // Opens 'path' and starts streaming every intervalMks (0 = every filter update).
+    bool                Open(const char* path, UInt32 intervalMks = 0, bool tare = true);
+    // Stops streaming and closes the port.
+    void                Close();
+
+    virtual ReadResult  ReadSample(ThreeSpaceSample* sample, unsigned timeoutMs);
+
+    UInt32              GetSerialNumber() const     { return SerialNumber; }
+    // Bytes discarded while resynchronizing to the packet stream.
+    UInt32              GetResyncCount() const      { return ResyncCount; }
+
+private:
+    enum { CommandTimeoutMs = 500, BufferSize = 1024, MaxFrameDataSize = 128 };
+
+    bool                sendCommand(TSSStartByte start, UByte command,
+                                    const UByte* data = 0, UPInt dataSize = 0);
+    // Reads the next well-formed header+data frame into data (MaxFrameDataSize bytes);
+    // returns its data length, -1 on timeout and -2 on a port error.
+    int                 readFrame(UByte* data, UInt32* timestamp, unsigned timeoutMs);
+    // Reads whatever is available into Buffer, waiting up to timeoutMs.
+    // Returns bytes read, 0 on timeout, -1 on error.
+    int                 fill(unsigned timeoutMs);
+
+    ThreeSpaceDeviceCache* pCache;
+    int                 Fd;
+    UByte               Buffer[BufferSize];
+    UPInt               BufferStart, BufferEnd;
+    UInt32              SerialNumber;
+    UInt32              ResyncCount;
+    bool                Streaming;
+};
+
+#endif
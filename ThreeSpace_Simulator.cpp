@@ -0,0 +1,417 @@
+/************************************************************************************
+
+Filename    :   ThreeSpace_Simulator.cpp
+Content     :   Simulated YEI 3-Space sensor behind a pseudo-terminal
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "ThreeSpace_Simulator.h"
+#include "Util_Trace.h"
+#include "../../LibOVR/Src/Kernel/OVR_Math.h"
+#include "../../LibOVR/Src/Kernel/OVR_Timer.h"
+#include "../../LibOVR/Src/Kernel/OVR_Log.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <time.h>
+#include <math.h>
+
+//-------------------------------------------------------------------------------------
+// ***** ThreeSpaceSimulator
+
+ThreeSpaceSimulator::ThreeSpaceSimulator(const Settings& settings)
+    : Config(settings), MasterFd(-1), SlaveFd(-1), InputSize(0),
+      HeaderBits(0), AxisDirections(0), IntervalMks(0), DurationMks(TSS_InfiniteDuration), DelayMks(0),
+      Streaming(false), StreamHeader(false), StreamStart(0), NextPacketTicks(0), SendTicks(0),
+      TareTicks(0), DropoutLeft(0), RandomState(settings.Seed ? settings.Seed : 1)
+{
+    PortName[0] = 0;
+    memset(Slots, 0xFF, sizeof(Slots));
+
+    if (Config.RateHz < 1)
+        Config.RateHz = 1;
+}
+
+ThreeSpaceSimulator::~ThreeSpaceSimulator()
+{
+    if (SlaveFd >= 0)
+        close(SlaveFd);
+    if (MasterFd >= 0)
+        close(MasterFd);
+}
+
+bool ThreeSpaceSimulator::Open()
+{
+    MasterFd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (MasterFd < 0 || grantpt(MasterFd) != 0 || unlockpt(MasterFd) != 0)
+    {
+        LogText("TSS Simulator: Can't create pty\n");
+        return false;
+    }
+
+    const char* name = ptsname(MasterFd);
+    if (!name)
+        return false;
+    strncpy(PortName, name, sizeof(PortName) - 1);
+    PortName[sizeof(PortName) - 1] = 0;
+
+    // Holding the slave open keeps the master readable between clients, and lets
+    // us put the line discipline in raw mode before anyone writes a command;
+    // otherwise the pty would echo and translate bytes of binary packets.
+    SlaveFd = open(PortName, O_RDWR | O_NOCTTY);
+    if (SlaveFd < 0)
+        return false;
+
+    termios tio;
+    if (tcgetattr(SlaveFd, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        tcsetattr(SlaveFd, TCSANOW, &tio);
+    }
+
+    // A reader that stops reading must not stall the simulated sensor;
+    // like the real one, it just loses packets.
+    fcntl(MasterFd, F_SETFL, fcntl(MasterFd, F_GETFL) | O_NONBLOCK);
+    return true;
+}
+
+void ThreeSpaceSimulator::Stop()
+{
+    SetExitFlag(true);
+    while (!IsFinished())
+        Thread::MSleep(1);
+}
+
+UInt32 ThreeSpaceSimulator::nextRandom()
+{
+    RandomState ^= RandomState << 13;
+    RandomState ^= RandomState >> 17;
+    RandomState ^= RandomState << 5;
+    return RandomState;
+}
+
+// Slow look-around: yaw swings +/-60 degrees every 4 s, pitch +/-20 degrees every
+// 2.5 s. In room coordinates, untared.
+static Quatf simulatedMotion(UInt64 ticks)
+{
+    double t     = double(ticks) / Timer::MksPerSecond;
+    float  yaw   = float(Math<double>::Pi / 3.0 * sin(2.0 * Math<double>::Pi * t / 4.0));
+    float  pitch = float(Math<double>::Pi / 9.0 * sin(2.0 * Math<double>::Pi * t / 2.5));
+    return Quatf(Vector3f(0, 1, 0), yaw) * Quatf(Vector3f(1, 0, 0), pitch);
+}
+
+// The sensor reports (z, x, y) of room axes; see RoomCamera::ApplyThreeSpaceOrientation.
+static void putSensorVector(UByte* p, const Vector3f& v)
+{
+    TSSPutFloat(p + 0, v.z);
+    TSSPutFloat(p + 4, v.x);
+    TSSPutFloat(p + 8, v.y);
+}
+
+UPInt ThreeSpaceSimulator::getSlotData(UByte command, UInt64 now, UByte* data) const
+{
+    Quatf motion = simulatedMotion(now);
+
+    switch (command)
+    {
+    case TSSCmd_GetTaredOrientationAsQuaternion:
+        {
+            Quatf q = simulatedMotion(TareTicks).Inverted() * motion;
+            putSensorVector(data, Vector3f(q.x, q.y, q.z));
+            TSSPutFloat(data + 12, q.w);
+        }
+        break;
+
+    case TSSCmd_GetCorrectedGyroRate:
+        {
+            // Body-frame rate from the rotation over the next millisecond.
+            Quatf delta = motion.Inverted() * simulatedMotion(now + 1000);
+            putSensorVector(data, Vector3f(delta.x, delta.y, delta.z) * 2000.0f);
+        }
+        break;
+
+    case TSSCmd_GetCorrectedAccelerometerVector:
+        // At rest apart from turning the head: 1 g straight up.
+        putSensorVector(data, motion.Inverted().Rotate(Vector3f(0, 1, 0)));
+        break;
+
+    case TSSCmd_GetCorrectedCompassVector:
+        putSensorVector(data, motion.Inverted().Rotate(Vector3f(0, -0.3f, -0.4f)));
+        break;
+
+    case TSSCmd_GetConfidenceFactor:
+        TSSPutFloat(data, 1.0f);
+        break;
+
+    default:
+        return 0;
+    }
+    return TSSStreamDataSize(command);
+}
+
+bool ThreeSpaceSimulator::sendReply(bool withHeader, bool success, UByte command,
+                                    const UByte* data, UPInt dataSize, UInt64 now)
+{
+    UByte packet[16 + TSS_StreamSlotCount * TSS_QuaternionDataSize];
+    UPInt size = 0;
+
+    if (withHeader)
+    {
+        if (HeaderBits & TSSHeader_Success)
+            packet[size++] = success ? 0 : 1;
+        if (HeaderBits & TSSHeader_Timestamp)
+        {
+            TSSPutUInt32(packet + size, UInt32(now));
+            size += 4;
+        }
+        if (HeaderBits & TSSHeader_Echo)
+            packet[size++] = command;
+        if (HeaderBits & TSSHeader_Checksum)
+            packet[size++] = TSSChecksum(data, dataSize);
+        if (HeaderBits & TSSHeader_LogicalId)
+            packet[size++] = 0;
+        if (HeaderBits & TSSHeader_Serial)
+        {
+            TSSPutUInt32(packet + size, Config.SerialNumber);
+            size += 4;
+        }
+        if (HeaderBits & TSSHeader_DataLength)
+            packet[size++] = UByte(dataSize);
+    }
+
+    memcpy(packet + size, data, dataSize);
+    size += dataSize;
+
+    return write(MasterFd, packet, size) == (ssize_t)size;
+}
+
+void ThreeSpaceSimulator::executeCommand(UByte start, UByte command, const UByte* data)
+{
+    UInt64 now       = Timer::GetTicks();
+    bool   header    = (start == TSSStart_WithHeader);
+    bool   success   = true;
+    UByte  reply[16];
+    UPInt  replySize = 0;
+
+    switch (command)
+    {
+    case TSSCmd_GetTaredOrientationAsQuaternion:
+    case TSSCmd_GetCorrectedGyroRate:
+    case TSSCmd_GetCorrectedAccelerometerVector:
+    case TSSCmd_GetCorrectedCompassVector:
+    case TSSCmd_GetConfidenceFactor:
+        replySize = getSlotData(command, now, reply);
+        break;
+
+    case TSSCmd_SetStreamingSlots:
+        memcpy(Slots, data, TSS_StreamSlotCount);
+        break;
+
+    case TSSCmd_GetStreamingSlots:
+        memcpy(reply, Slots, TSS_StreamSlotCount);
+        replySize = TSS_StreamSlotCount;
+        break;
+
+    case TSSCmd_SetStreamingTiming:
+        IntervalMks = TSSGetUInt32(data + 0);
+        DurationMks = TSSGetUInt32(data + 4);
+        DelayMks    = TSSGetUInt32(data + 8);
+        break;
+
+    case TSSCmd_GetStreamingTiming:
+        TSSPutUInt32(reply + 0, IntervalMks);
+        TSSPutUInt32(reply + 4, DurationMks);
+        TSSPutUInt32(reply + 8, DelayMks);
+        replySize = 12;
+        break;
+
+    case TSSCmd_StartStreaming:
+        // A header on the start command applies to every streamed packet.
+        Streaming       = true;
+        StreamHeader    = header;
+        StreamStart     = now;
+        NextPacketTicks = now + DelayMks;
+        SendTicks       = NextPacketTicks;
+        DropoutLeft     = 0;
+        break;
+
+    case TSSCmd_StopStreaming:
+        Streaming = false;
+        break;
+
+    case TSSCmd_TareWithCurrentOrientation:
+        TareTicks = now;
+        break;
+
+    case TSSCmd_SetAxisDirections:
+        // Stored for GetAxisDirections only; samples are always in the default axes.
+        AxisDirections = data[0];
+        break;
+
+    case TSSCmd_GetAxisDirections:
+        reply[0]  = AxisDirections;
+        replySize = 1;
+        break;
+
+    case TSSCmd_SetResponseHeader:
+        HeaderBits = TSSGetUInt32(data);
+        break;
+
+    case TSSCmd_GetSerialNumber:
+        TSSPutUInt32(reply, Config.SerialNumber);
+        replySize = 4;
+        break;
+
+    default:
+        success = false;
+        CommandErrors.ExchangeAdd_NoSync(1);
+        break;
+    }
+
+    // Without a header the sensor only answers commands that return data.
+    if (header || replySize)
+        sendReply(header, success, command, reply, replySize, now);
+}
+
+void ThreeSpaceSimulator::handleCommands()
+{
+    ssize_t n = read(MasterFd, Input + InputSize, BufferSize - InputSize);
+    if (n > 0)
+        InputSize += n;
+
+    UPInt pos = 0;
+    while (pos < InputSize)
+    {
+        UByte start = Input[pos];
+        if (start != TSSStart_Command && start != TSSStart_WithHeader)
+        {
+            pos++;
+            CommandErrors.ExchangeAdd_NoSync(1);
+            continue;
+        }
+        if (InputSize - pos < 2)
+            break;
+
+        UByte command  = Input[pos + 1];
+        UPInt dataSize = TSSCommandDataSize(command);
+        if (InputSize - pos < 3 + dataSize)
+            break;
+
+        if (TSSChecksum(Input + pos + 1, dataSize + 1) != Input[pos + 2 + dataSize])
+        {
+            // The real sensor ignores a packet with a bad checksum.
+            pos++;
+            CommandErrors.ExchangeAdd_NoSync(1);
+            continue;
+        }
+
+        executeCommand(start, command, Input + pos + 2);
+        pos += 3 + dataSize;
+    }
+
+    memmove(Input, Input + pos, InputSize - pos);
+    InputSize -= pos;
+}
+
+void ThreeSpaceSimulator::sendStreamPacket(UInt64 now)
+{
+    if (DropoutLeft == 0 && Config.DropoutProbability > 0.0f &&
+        float(nextRandom() & 0xFFFFFF) < Config.DropoutProbability * float(0x1000000))
+    {
+        DropoutLeft = Config.DropoutLength;
+    }
+    if (DropoutLeft)
+    {
+        DropoutLeft--;
+        DroppedCount.ExchangeAdd_NoSync(1);
+        return;
+    }
+
+    UByte data[TSS_StreamSlotCount * TSS_QuaternionDataSize];
+    UPInt size = 0;
+    for (int i = 0; i < (int)TSS_StreamSlotCount; i++)
+        size += getSlotData(Slots[i], now, data + size);
+
+    // A full pty means the host is not keeping up; the packet is lost.
+    if (sendReply(StreamHeader, true, TSSCmd_StartStreaming, data, size, now))
+        SentCount.ExchangeAdd_NoSync(1);
+    else
+        DroppedCount.ExchangeAdd_NoSync(1);
+}
+
+int ThreeSpaceSimulator::Run()
+{
+    Trace::SetThreadName("ThreeSpace Simulator");
+
+    UInt64 periodMks = 1000000 / Config.RateHz;
+
+    while (!GetExitFlag())
+    {
+        handleCommands();
+
+        UInt64 now = Timer::GetTicks();
+        if (Streaming)
+        {
+            UInt64 interval = (IntervalMks > periodMks) ? IntervalMks : periodMks;
+
+            if (DurationMks != TSS_InfiniteDuration && now - StreamStart > UInt64(DelayMks) + DurationMks)
+                Streaming = false;
+            else
+            {
+                if (now >= SendTicks)
+                {
+                    sendStreamPacket(now);
+
+                    // Keep the nominal schedule; if we were starved for long,
+                    // restart it rather than sending a burst to catch up.
+                    NextPacketTicks += interval;
+                    if (now > NextPacketTicks + 100000)
+                        NextPacketTicks = now + interval;
+
+                    SendTicks = NextPacketTicks;
+                    if (Config.JitterMks)
+                    {
+                        SInt64 jitter = SInt64(nextRandom() % (2 * Config.JitterMks + 1)) - Config.JitterMks;
+                        SendTicks = UInt64(SInt64(NextPacketTicks) + jitter);
+                    }
+                    continue;
+                }
+
+                // poll() only has millisecond resolution; sleep out the rest.
+                UInt64 wait = SendTicks - now;
+                if (wait >= 2000)
+                {
+                    pollfd pfd = { MasterFd, POLLIN, 0 };
+                    poll(&pfd, 1, int(wait / 1000) - 1);
+                }
+                else
+                {
+                    timespec ts = { 0, long(wait * 1000) };
+                    nanosleep(&ts, 0);
+                }
+                continue;
+            }
+        }
+
+        pollfd pfd = { MasterFd, POLLIN, 0 };
+        poll(&pfd, 1, 10);
+    }
+    return 0;
+}
@@ -0,0 +1,120 @@
+/************************************************************************************
+
+Filename    :   ThreeSpace_Simulator.h
+Content     :   Simulated YEI 3-Space sensor behind a pseudo-terminal
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+#ifndef INC_ThreeSpace_Simulator_h
+#define INC_ThreeSpace_Simulator_h
+
+#include "../../LibOVR/Src/Kernel/OVR_Threads.h"
+#include "ThreeSpace_Protocol.h"
+
+//-------------------------------------------------------------------------------------
+// ***** ThreeSpaceSimulator
+
+// Stands in for a sensor so the serial ingest path can be exercised and benchmarked
+// without hardware. Open() creates a pty; anything that opens GetPortName() sees a
+// sensor that answers the commands in ThreeSpace_Protocol.h and, once started,
+// streams its slots (orientation, gyro, accelerometer, compass, confidence) for a
+// slow synthetic head motion.
+//
+// The packet rate, timing jitter and dropouts are configurable, so the reader can be
+// pushed to the 1 kHz the sensor firmware supports and fed the gaps a flaky USB
+// link produces. Stream timestamps are Timer::GetTicks() truncated to 32 bits, the
+// same clock the reader stamps HostTicks with, so HostTicks - SensorTimestamp is
+// the ingest latency.
+
+class ThreeSpaceSimulator : public Thread
+{
+public:
+    struct Settings
+    {
+        // Filter update rate; also the streaming rate when the host asks for interval 0.
+        unsigned    RateHz;
+        // Every packet is sent up to this many microseconds early or late.
+        unsigned    JitterMks;
+        // Chance that a packet starts a dropout, and how many packets each one loses.
+        float       DropoutProbability;
+        unsigned    DropoutLength;
+        UInt32      SerialNumber;
+        UInt32      Seed;
+
+        Settings()
+            : RateHz(1000), JitterMks(0), DropoutProbability(0.0f), DropoutLength(1),
+              SerialNumber(0x1234ABCD), Seed(1)
+        { }
+    };
+
+    ThreeSpaceSimulator(const Settings& settings);
+    ~ThreeSpaceSimulator();
+
+    // Creates the pty. The port is valid until the simulator is destroyed.
+    bool            Open();
+    const char*     GetPortName() const     { return PortName; }
+
+    // Signals the thread to exit and waits until it has.
+    void            Stop();
+
+    UInt32          GetSentCount() const            { return SentCount.Load_Acquire(); }
+    UInt32          GetDroppedCount() const         { return DroppedCount.Load_Acquire(); }
+    UInt32          GetCommandErrorCount() const    { return CommandErrors.Load_Acquire(); }
+
+protected:
+    virtual int     Run();
+
+private:
+    enum { BufferSize = 256 };
+
+    void            handleCommands();
+    void            executeCommand(UByte start, UByte command, const UByte* data);
+    void            sendStreamPacket(UInt64 now);
+    // Writes the configured response header (if withHeader) followed by data.
+    bool            sendReply(bool withHeader, bool success, UByte command,
+                              const UByte* data, UPInt dataSize, UInt64 now);
+    // Writes a streamable command's data as of 'now'; returns its size.
+    UPInt           getSlotData(UByte command, UInt64 now, UByte* data) const;
+    UInt32          nextRandom();
+
+    Settings            Config;
+    int                 MasterFd;
+    int                 SlaveFd;
+    char                PortName[64];
+
+    // Protocol state; simulator thread only.
+    UByte               Input[BufferSize];
+    UPInt               InputSize;
+    UInt32              HeaderBits;
+    UByte               Slots[TSS_StreamSlotCount];
+    UByte               AxisDirections;
+    UInt32              IntervalMks;
+    UInt32              DurationMks;
+    UInt32              DelayMks;
+    bool                Streaming;
+    bool                StreamHeader;
+    UInt64              StreamStart;
+    UInt64              NextPacketTicks; // Nominal schedule.
+    UInt64              SendTicks;       // NextPacketTicks plus this packet's jitter.
+    UInt64              TareTicks;
+    unsigned            DropoutLeft;
+    UInt32              RandomState;
+
+    AtomicInt<UInt32>   SentCount;
+    AtomicInt<UInt32>   DroppedCount;
+    AtomicInt<UInt32>   CommandErrors;
+};
+
+#endif
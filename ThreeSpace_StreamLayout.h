@@ -0,0 +1,189 @@
+/************************************************************************************
+
+Filename    :   ThreeSpace_StreamLayout.h
+Content     :   Compile-time description of a multi-slot 3-Space stream packet
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+#ifndef INC_ThreeSpace_StreamLayout_h
+#define INC_ThreeSpace_StreamLayout_h
+
+#include "../../LibOVR/Src/Kernel/OVR_Math.h"
+#include "ThreeSpace_Protocol.h"
+
+//-------------------------------------------------------------------------------------
+// ***** Stream slots
+
+// One type per streamable command: its command byte, the size of its data in a
+// stream packet and how to decode that data. Data is host byte order, as
+// tss_getLatestStreamData returns it (see TSSSwapStreamData for the raw wire).
+
+struct TSSSlot_Null
+{
+    enum { Command = 0xFF, Size = 0 };
+};
+
+// Sensor x, y, z, w; see RoomCamera::ApplyThreeSpaceOrientation for the axes.
+struct TSSSlot_TaredQuaternion
+{
+    enum { Command = TSSCmd_GetTaredOrientationAsQuaternion, Size = TSS_QuaternionDataSize };
+    typedef Quatf ValueType;
+    static ValueType Decode(const float* f) { return Quatf(f[0], f[1], f[2], f[3]); }
+};
+
+// Radians/second, sensor frame.
+struct TSSSlot_CorrectedGyroRate
+{
+    enum { Command = TSSCmd_GetCorrectedGyroRate, Size = TSS_Vector3DataSize };
+    typedef Vector3f ValueType;
+    static ValueType Decode(const float* f) { return Vector3f(f[0], f[1], f[2]); }
+};
+
+// g, sensor frame.
+struct TSSSlot_CorrectedAccelerometer
+{
+    enum { Command = TSSCmd_GetCorrectedAccelerometerVector, Size = TSS_Vector3DataSize };
+    typedef Vector3f ValueType;
+    static ValueType Decode(const float* f) { return Vector3f(f[0], f[1], f[2]); }
+};
+
+// Gauss, sensor frame.
+struct TSSSlot_CorrectedCompass
+{
+    enum { Command = TSSCmd_GetCorrectedCompassVector, Size = TSS_Vector3DataSize };
+    typedef Vector3f ValueType;
+    static ValueType Decode(const float* f) { return Vector3f(f[0], f[1], f[2]); }
+};
+
+// 0..1; how much the filter currently trusts the orientation.
+struct TSSSlot_ConfidenceFactor
+{
+    enum { Command = TSSCmd_GetConfidenceFactor, Size = TSS_FloatDataSize };
+    typedef float ValueType;
+    static ValueType Decode(const float* f) { return f[0]; }
+};
+
+template<class A, class B> struct TSSSameSlot       { enum { Value = 0 }; };
+template<class A>          struct TSSSameSlot<A, A> { enum { Value = 1 }; };
+
+
+//-------------------------------------------------------------------------------------
+// ***** TSSStreamLayout
+
+// Everything about a stream configuration that follows from its slot list, worked
+// out by the compiler so the slot array sent to the sensor and the decoder of its
+// packets can never disagree:
+//
+//   typedef TSSStreamLayout<TSSSlot_TaredQuaternion, TSSSlot_CorrectedGyroRate> Layout;
+//
+//   TSS_Stream_Command slots[TSS_StreamSlotCount];
+//   Layout::GetSlots(slots);
+//   tss_setStreamingSlots(device, slots, NULL);
+//
+//   Layout::Packet packet;
+//   tss_getLatestStreamData(device, (char*)packet.Data, Layout::PacketSize, ...);
+//   Vector3f gyro = packet.Get<TSSSlot_CorrectedGyroRate>();
+//
+// Packet is the packed stream data itself; Get() decodes a slot in place at an
+// offset known at compile time, and asking for a slot the layout does not stream
+// is a compile error. TryGet() is for code generic over layouts.
+
+template<class S0,                class S1 = TSSSlot_Null, class S2 = TSSSlot_Null,
+         class S3 = TSSSlot_Null, class S4 = TSSSlot_Null, class S5 = TSSSlot_Null,
+         class S6 = TSSSlot_Null, class S7 = TSSSlot_Null>
+class TSSStreamLayout
+{
+public:
+    enum
+    {
+        SlotCount  = (S0::Size > 0) + (S1::Size > 0) + (S2::Size > 0) + (S3::Size > 0) +
+                     (S4::Size > 0) + (S5::Size > 0) + (S6::Size > 0) + (S7::Size > 0),
+        PacketSize = S0::Size + S1::Size + S2::Size + S3::Size +
+                     S4::Size + S5::Size + S6::Size + S7::Size
+    };
+
+    // Byte offset of Slot in a packet; Found is 0 if the layout does not stream it.
+    template<class Slot>
+    struct SlotOffset
+    {
+        enum
+        {
+            In0   = TSSSameSlot<Slot, S0>::Value, In1 = TSSSameSlot<Slot, S1>::Value,
+            In2   = TSSSameSlot<Slot, S2>::Value, In3 = TSSSameSlot<Slot, S3>::Value,
+            In4   = TSSSameSlot<Slot, S4>::Value, In5 = TSSSameSlot<Slot, S5>::Value,
+            In6   = TSSSameSlot<Slot, S6>::Value, In7 = TSSSameSlot<Slot, S7>::Value,
+            Found = In0 | In1 | In2 | In3 | In4 | In5 | In6 | In7,
+            Value = In0 ? 0 :
+                    In1 ? S0::Size :
+                    In2 ? S0::Size + S1::Size :
+                    In3 ? S0::Size + S1::Size + S2::Size :
+                    In4 ? S0::Size + S1::Size + S2::Size + S3::Size :
+                    In5 ? S0::Size + S1::Size + S2::Size + S3::Size + S4::Size :
+                    In6 ? S0::Size + S1::Size + S2::Size + S3::Size + S4::Size + S5::Size :
+                    In7 ? S0::Size + S1::Size + S2::Size + S3::Size + S4::Size + S5::Size +
+                          S6::Size : 0
+        };
+    };
+
+    // Fills the slot array for tss_setStreamingSlots (T = TSS_Stream_Command) or
+    // TSSCmd_SetStreamingSlots (T = UByte).
+    template<class T>
+    static void GetSlots(T slots[TSS_StreamSlotCount])
+    {
+        slots[0] = T(S0::Command); slots[1] = T(S1::Command);
+        slots[2] = T(S2::Command); slots[3] = T(S3::Command);
+        slots[4] = T(S4::Command); slots[5] = T(S5::Command);
+        slots[6] = T(S6::Command); slots[7] = T(S7::Command);
+    }
+
+    template<class Slot>
+    static bool HasSlot() { return SlotOffset<Slot>::Found != 0; }
+
+#pragma pack(push,1)
+    struct Packet
+    {
+        UByte   Data[PacketSize];
+
+        template<class Slot>
+        typename Slot::ValueType Get() const
+        {
+            typedef char SlotNotInLayout[SlotOffset<Slot>::Found ? 1 : -1];
+            (void)sizeof(SlotNotInLayout);
+            return decode<Slot>();
+        }
+
+        template<class Slot>
+        bool TryGet(typename Slot::ValueType* value) const
+        {
+            if (!SlotOffset<Slot>::Found)
+                return false;
+            *value = decode<Slot>();
+            return true;
+        }
+
+    private:
+        template<class Slot>
+        typename Slot::ValueType decode() const
+        {
+            // Slots are packed back to back with no alignment; copy out the floats.
+            float f[Slot::Size / 4 + 1];
+            memcpy(f, Data + SlotOffset<Slot>::Value, Slot::Size);
+            return Slot::Decode(f);
+        }
+    };
+#pragma pack(pop)
+};
+
+#endif
@@ -0,0 +1,441 @@
+/************************************************************************************
+
+Filename    :   Util_AsyncLog.cpp
+Content     :   Deferred, deduplicating LogText for hot paths
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "Util_AsyncLog.h"
+#include "Util_SampleRing.h"
+#include "../../LibOVR/Src/Kernel/OVR_Threads.h"
+#include "../../LibOVR/Src/Kernel/OVR_Timer.h"
+#include "../../LibOVR/Src/Kernel/OVR_String.h"
+#include "../../LibOVR/Src/Kernel/OVR_Array.h"
+#include "../../LibOVR/Src/Kernel/OVR_Log.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(_MSC_VER)
+#define OVR_ASYNCLOG_THREAD_LOCAL __declspec(thread)
+#define snprintf _snprintf
+#else
+#define OVR_ASYNCLOG_THREAD_LOCAL __thread
+#endif
+
+namespace OVR {
+
+//-------------------------------------------------------------------------------------
+// ***** Message formatting
+
+struct AsyncLogMessage
+{
+    const char* Format;
+    unsigned    ArgCount;
+    LogArg      Args[AsyncLog::MaxArgs];
+};
+
+// printf with the captured arguments. Every conversion is re-issued on its own,
+// with the length modifier replaced to match how the argument was captured, so a
+// format/argument mismatch can at worst print a wrong number, never crash.
+static void formatMessage(const AsyncLogMessage& msg, char* buffer, UPInt size)
+{
+    const char* f        = msg.Format;
+    UPInt       pos      = 0;
+    unsigned    argIndex = 0;
+
+    while (*f && pos + 1 < size)
+    {
+        if (*f != '%')
+        {
+            buffer[pos++] = *f++;
+            continue;
+        }
+        if (f[1] == '%')
+        {
+            buffer[pos++] = '%';
+            f += 2;
+            continue;
+        }
+
+        // Copy flags, width and precision; drop length modifiers.
+        char spec[32];
+        UPInt specLen = 0;
+        spec[specLen++] = *f++;
+        while (*f && strchr("-+ #0123456789.", *f) && specLen < sizeof(spec) - 4)
+            spec[specLen++] = *f++;
+        while (*f && strchr("hlLqjztI64", *f))
+            f++;
+        char conv = *f;
+        if (!conv)
+            break;
+        f++;
+
+        if (argIndex >= msg.ArgCount)
+        {
+            // Missing argument; print the conversion literally.
+            spec[specLen] = 0;
+            pos += snprintf(buffer + pos, size - pos, "%s%c", spec, conv);
+            if (pos >= size) pos = size - 1;
+            continue;
+        }
+
+        const LogArg& arg     = msg.Args[argIndex++];
+        int           written = 0;
+
+        switch (conv)
+        {
+        case 'd': case 'i':
+            spec[specLen++] = 'l'; spec[specLen++] = 'l'; spec[specLen++] = conv; spec[specLen] = 0;
+            written = snprintf(buffer + pos, size - pos, spec,
+                               (long long)(arg.Type == LogArg::Arg_Double ? (SInt64)arg.Value.D : arg.Value.I));
+            break;
+        case 'u': case 'x': case 'X': case 'o': case 'c':
+            if (conv != 'c')
+            {
+                spec[specLen++] = 'l'; spec[specLen++] = 'l';
+            }
+            spec[specLen++] = conv; spec[specLen] = 0;
+            if (conv == 'c')
+                written = snprintf(buffer + pos, size - pos, spec, (int)arg.Value.I);
+            else
+                written = snprintf(buffer + pos, size - pos, spec,
+                                   (unsigned long long)(arg.Type == LogArg::Arg_Double ? (UInt64)arg.Value.D : arg.Value.U));
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            spec[specLen++] = conv; spec[specLen] = 0;
+            written = snprintf(buffer + pos, size - pos, spec,
+                               arg.Type == LogArg::Arg_Double ? arg.Value.D :
+                               arg.Type == LogArg::Arg_Int    ? (double)arg.Value.I : (double)arg.Value.U);
+            break;
+        case 's':
+            spec[specLen++] = 's'; spec[specLen] = 0;
+            written = snprintf(buffer + pos, size - pos, spec,
+                               (arg.Type == LogArg::Arg_String && arg.Value.S) ? arg.Value.S : "(null)");
+            break;
+        case 'p':
+            written = snprintf(buffer + pos, size - pos, "%p", arg.Value.P);
+            break;
+        default:
+            break;
+        }
+
+        if (written > 0)
+            pos += written;
+        if (pos >= size)
+            pos = size - 1;
+    }
+
+    buffer[pos] = 0;
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** Per-thread queues
+
+struct AsyncLogThreadQueue
+{
+    SampleRing<AsyncLogMessage, AsyncLog::RingSize> Messages;
+    UInt32                                          ReportedDrops; // Log thread only.
+
+    AsyncLogThreadQueue() : ReportedDrops(0) { }
+};
+
+static AsyncLogThreadQueue      ThreadQueues[AsyncLog::MaxThreads];
+static AtomicInt<UInt32>        ThreadQueueCount;
+static AtomicInt<UInt32>        Running;
+
+// 0 - not claimed yet; -1 - no queue left; otherwise queue index + 1.
+static OVR_ASYNCLOG_THREAD_LOCAL int ThreadQueueSlot = 0;
+
+static AsyncLogThreadQueue* getThreadQueue()
+{
+    if (ThreadQueueSlot == 0)
+    {
+        UInt32 index    = ThreadQueueCount.ExchangeAdd_NoSync(1);
+        ThreadQueueSlot = (index < (UInt32)AsyncLog::MaxThreads) ? int(index + 1) : -1;
+    }
+    return (ThreadQueueSlot > 0) ? &ThreadQueues[ThreadQueueSlot - 1] : 0;
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** AsyncLogThread
+
+// Formats queued messages, collapses repeats and writes through LogText.
+
+class AsyncLogThread : public Thread
+{
+public:
+    AsyncLogThread(float repeatWindow)
+        : RepeatWindowTicks(UInt64(repeatWindow * Timer::MksPerSecond)),
+          DropWindowStart(0), Drops(0), DropWindow(false)
+    { }
+
+    // Logs everything queued so far.
+    void        Drain();
+    // Logs repeat summaries of windows that have ended; all of them if 'all'.
+    void        FlushRepeats(bool all);
+
+protected:
+    virtual int Run();
+
+private:
+    enum { DrainIntervalMs = 20 };
+
+    struct RepeatEntry
+    {
+        String  Text;
+        UInt64  WindowStart;
+        UInt32  Repeats;
+    };
+
+    void        logMessage(const char* text);
+    void        logSummary(const RepeatEntry& entry, UInt64 now);
+    void        logDrops(UInt32 drops);
+    void        flushDrops(bool all, UInt64 now);
+
+    UInt64              RepeatWindowTicks;
+    Array<RepeatEntry>  Recent;
+
+    // Dropped messages are rate limited like a repeated message: the first drop
+    // is reported at once, later ones are counted until the window ends.
+    UInt64              DropWindowStart;
+    UInt32              Drops;
+    bool                DropWindow;
+};
+
+void AsyncLogThread::logMessage(const char* text)
+{
+    UInt64 now = Timer::GetTicks();
+
+    for (UPInt i = 0; i < Recent.GetSize(); i++)
+    {
+        if (Recent[i].Text == text)
+        {
+            Recent[i].Repeats++;
+            return;
+        }
+    }
+
+    LogText("%s", text);
+
+    RepeatEntry entry;
+    entry.Text        = text;
+    entry.WindowStart = now;
+    entry.Repeats     = 0;
+    Recent.PushBack(entry);
+}
+
+void AsyncLogThread::logSummary(const RepeatEntry& entry, UInt64 now)
+{
+    // Messages normally end in a newline; the summary goes on the same line.
+    const char* text = entry.Text.ToCStr();
+    UPInt       len  = strlen(text);
+    while (len && (text[len - 1] == '\n' || text[len - 1] == '\r'))
+        len--;
+
+    LogText("%.*s (repeated %u times in last %u s)\n", (int)len, text, entry.Repeats,
+            unsigned((now - entry.WindowStart + Timer::MksPerSecond / 2) / Timer::MksPerSecond));
+}
+
+void AsyncLogThread::logDrops(UInt32 drops)
+{
+    if (DropWindow)
+    {
+        Drops += drops;
+        return;
+    }
+
+    LogText("AsyncLog: %u messages dropped\n", drops);
+    DropWindowStart = Timer::GetTicks();
+    Drops           = 0;
+    DropWindow      = true;
+}
+
+void AsyncLogThread::flushDrops(bool all, UInt64 now)
+{
+    if (!DropWindow || (!all && now - DropWindowStart < RepeatWindowTicks))
+        return;
+
+    if (Drops)
+        LogText("AsyncLog: %u messages dropped in last %u s\n", Drops,
+                unsigned((now - DropWindowStart + Timer::MksPerSecond / 2) / Timer::MksPerSecond));
+
+    // As with repeats, still dropping keeps the report muted for another window.
+    DropWindow      = (Drops != 0) && !all;
+    DropWindowStart = now;
+    Drops           = 0;
+}
+
+void AsyncLogThread::FlushRepeats(bool all)
+{
+    UInt64 now = Timer::GetTicks();
+    flushDrops(all, now);
+
+    for (UPInt i = 0; i < Recent.GetSize(); )
+    {
+        RepeatEntry& entry = Recent[i];
+        if (!all && now - entry.WindowStart < RepeatWindowTicks)
+        {
+            i++;
+            continue;
+        }
+
+        if (entry.Repeats)
+            logSummary(entry, now);
+
+        // A message that kept repeating stays muted for another window;
+        // a quiet one is forgotten, so it logs immediately next time.
+        if (entry.Repeats && !all)
+        {
+            entry.WindowStart = now;
+            entry.Repeats     = 0;
+            i++;
+        }
+        else
+            Recent.RemoveAt(i);
+    }
+}
+
+void AsyncLogThread::Drain()
+{
+    UInt32 queues = ThreadQueueCount.Load_Acquire();
+    if (queues > (UInt32)AsyncLog::MaxThreads)
+        queues = AsyncLog::MaxThreads;
+
+    char            text[512];
+    AsyncLogMessage msg;
+
+    for (UInt32 i = 0; i < queues; i++)
+    {
+        AsyncLogThreadQueue& queue = ThreadQueues[i];
+        while (queue.Messages.Pop(&msg))
+        {
+            formatMessage(msg, text, sizeof(text));
+            logMessage(text);
+        }
+
+        // The producer outran us by more than a ring; say so rather than hide it.
+        UInt32 drops = queue.Messages.GetDroppedCount();
+        if (drops != queue.ReportedDrops)
+        {
+            logDrops(drops - queue.ReportedDrops);
+            queue.ReportedDrops = drops;
+        }
+    }
+}
+
+int AsyncLogThread::Run()
+{
+    while (!GetExitFlag())
+    {
+        Thread::MSleep(DrainIntervalMs);
+        Drain();
+        FlushRepeats(false);
+    }
+    return 0;
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** AsyncLog
+
+static Ptr<AsyncLogThread> pLogThread;
+
+void AsyncLog::Start(float repeatWindow)
+{
+    if (pLogThread)
+        return;
+
+    pLogThread = *new AsyncLogThread(repeatWindow);
+    pLogThread->Start();
+    Running.Store_Release(1);
+}
+
+void AsyncLog::Stop()
+{
+    if (!pLogThread)
+        return;
+
+    Running.Store_Release(0);
+
+    pLogThread->SetExitFlag(true);
+    while (!pLogThread->IsFinished())
+        Thread::MSleep(1);
+
+    pLogThread->Drain();
+    pLogThread->FlushRepeats(true);
+    pLogThread.Clear();
+}
+
+bool AsyncLog::IsRunning()
+{
+    return Running.Load_Acquire() != 0;
+}
+
+static void queueMessage(const char* format, unsigned argCount, const LogArg* const* args)
+{
+    AsyncLogMessage msg;
+    msg.Format   = format;
+    msg.ArgCount = argCount;
+    for (unsigned i = 0; i < argCount; i++)
+        msg.Args[i] = *args[i];
+
+    AsyncLogThreadQueue* queue = AsyncLog::IsRunning() ? getThreadQueue() : 0;
+    if (queue)
+    {
+        queue->Messages.Push(msg);
+        return;
+    }
+
+    // Not started, or too many threads: log synchronously.
+    char text[512];
+    formatMessage(msg, text, sizeof(text));
+    LogText("%s", text);
+}
+
+void AsyncLogText(const char* format)
+{
+    queueMessage(format, 0, 0);
+}
+
+void AsyncLogText(const char* format, const LogArg& a0)
+{
+    const LogArg* args[] = { &a0 };
+    queueMessage(format, 1, args);
+}
+
+void AsyncLogText(const char* format, const LogArg& a0, const LogArg& a1)
+{
+    const LogArg* args[] = { &a0, &a1 };
+    queueMessage(format, 2, args);
+}
+
+void AsyncLogText(const char* format, const LogArg& a0, const LogArg& a1, const LogArg& a2)
+{
+    const LogArg* args[] = { &a0, &a1, &a2 };
+    queueMessage(format, 3, args);
+}
+
+void AsyncLogText(const char* format, const LogArg& a0, const LogArg& a1, const LogArg& a2,
+                  const LogArg& a3)
+{
+    const LogArg* args[] = { &a0, &a1, &a2, &a3 };
+    queueMessage(format, 4, args);
+}
+
+} // OVR
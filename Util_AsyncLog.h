@@ -0,0 +1,105 @@
+/************************************************************************************
+
+Filename    :   Util_AsyncLog.h
+Content     :   Deferred, deduplicating LogText for hot paths
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+#ifndef INC_Util_AsyncLog_h
+#define INC_Util_AsyncLog_h
+
+#include "../../LibOVR/Src/Kernel/OVR_Types.h"
+
+namespace OVR {
+
+//-------------------------------------------------------------------------------------
+// ***** LogArg
+
+// One captured AsyncLogText argument. Converts implicitly from the types a
+// printf-style format takes; the conversion in the format decides how it prints.
+// Strings are captured by pointer, so they must be literals or otherwise outlive
+// the message (use LogText for anything else).
+
+class LogArg
+{
+public:
+    enum ArgType { Arg_Int, Arg_UInt, Arg_Double, Arg_String, Arg_Pointer };
+
+    LogArg()                     : Type(Arg_Int)     { Value.U = 0; }
+    LogArg(int v)                : Type(Arg_Int)     { Value.I = v; }
+    LogArg(long v)               : Type(Arg_Int)     { Value.I = v; }
+    LogArg(long long v)          : Type(Arg_Int)     { Value.I = v; }
+    LogArg(unsigned v)           : Type(Arg_UInt)    { Value.U = v; }
+    LogArg(unsigned long v)      : Type(Arg_UInt)    { Value.U = v; }
+    LogArg(unsigned long long v) : Type(Arg_UInt)    { Value.U = v; }
+    LogArg(double v)             : Type(Arg_Double)  { Value.D = v; }
+    LogArg(const char* v)        : Type(Arg_String)  { Value.S = v; }
+    LogArg(const void* v)        : Type(Arg_Pointer) { Value.P = v; }
+
+    ArgType     Type;
+    union
+    {
+        SInt64      I;
+        UInt64      U;
+        double      D;
+        const char* S;
+        const void* P;
+    } Value;
+};
+
+
+//-------------------------------------------------------------------------------------
+// ***** AsyncLog
+
+// Logging backend for code that must not block: the reader thread and anything
+// OnIdle calls.
+//
+// AsyncLogText() only copies the format pointer and up to MaxArgs arguments into
+// the calling thread's lock-free SampleRing. A background thread formats the
+// messages and hands them to LogText.
+//
+// The background thread also rate limits: the first occurrence of a message is
+// logged at once, identical messages within the next RepeatWindow seconds are
+// only counted, and when the window ends one summary line
+// "<message> (repeated 5400 times in last 60 s)" is logged instead. Messages
+// dropped because a thread's ring overflowed are reported the same way.
+//
+// Before Start() (or after Stop()) AsyncLogText formats and logs synchronously,
+// so messages are never lost to ordering at startup.
+
+class AsyncLog
+{
+public:
+    enum { MaxArgs = 4, MaxThreads = 16, RingSize = 256 };
+
+    // Starts the formatting thread. repeatWindow is in seconds.
+    static void     Start(float repeatWindow = 60.0f);
+    // Logs everything still queued, flushes pending repeat summaries and stops.
+    static void     Stop();
+
+    static bool     IsRunning();
+};
+
+// Queues a message; format must be a string literal.
+void AsyncLogText(const char* format);
+void AsyncLogText(const char* format, const LogArg& a0);
+void AsyncLogText(const char* format, const LogArg& a0, const LogArg& a1);
+void AsyncLogText(const char* format, const LogArg& a0, const LogArg& a1, const LogArg& a2);
+void AsyncLogText(const char* format, const LogArg& a0, const LogArg& a1, const LogArg& a2,
+                  const LogArg& a3);
+
+} // OVR
+
+#endif
@@ -0,0 +1,196 @@
+/************************************************************************************
+
+Filename    :   Util_DistortionMesh.cpp
+Content     :   Precomputed lens distortion warp mesh
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "Util_DistortionMesh.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace OVR {
+
+//-------------------------------------------------------------------------------------
+// ***** DistortionMeshParams
+
+DistortionMeshParams DistortionMeshParams::FromConfig(const Util::Render::DistortionConfig& distortion,
+                                                      const Util::Render::Viewport& vp,
+                                                      int windowWidth, int windowHeight)
+{
+    DistortionMeshParams p;
+    float w  = float(vp.w) / float(windowWidth);
+    float h  = float(vp.h) / float(windowHeight);
+    float x  = float(vp.x) / float(windowWidth);
+    float y  = float(vp.y) / float(windowHeight);
+    float as = float(vp.w) / float(vp.h);
+
+    float scaleFactor = 1.0f / distortion.Scale;
+    p.LensCenter[0]   = x + (w + distortion.XCenterOffset * 0.5f) * 0.5f;
+    p.LensCenter[1]   = y + h * 0.5f;
+    p.ScreenCenter[0] = x + w * 0.5f;
+    p.ScreenCenter[1] = y + h * 0.5f;
+    p.Scale[0]        = (w / 2) * scaleFactor;
+    p.Scale[1]        = (h / 2) * scaleFactor * as;
+    p.ScaleIn[0]      = 2 / w;
+    p.ScaleIn[1]      = (2 / h) / as;
+    for (int i = 0; i < 4; i++)
+    {
+        p.HmdWarp[i] = distortion.K[i];
+        p.ChromAb[i] = distortion.ChromaticAberration[i];
+    }
+    p.X = x;
+    p.Y = y;
+    p.W = w;
+    p.H = h;
+    return p;
+}
+
+bool DistortionMeshParams::operator==(const DistortionMeshParams& other) const
+{
+    // Plain floats with no padding; an exact match is what "unchanged" means here.
+    return memcmp(this, &other, sizeof(*this)) == 0;
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** DistortionMesh
+
+DistortionMesh::DistortionMesh()
+    : GridSize(0), Version(0)
+{
+    memset(&Params, 0, sizeof(Params));
+}
+
+void DistortionMesh::Warp(const DistortionMeshParams& p, float x, float y,
+                          float texR[2], float texG[2], float texB[2])
+{
+    // HmdWarp, as the post-process pixel shaders evaluate it.
+    float thetaX = (x - p.LensCenter[0]) * p.ScaleIn[0];
+    float thetaY = (y - p.LensCenter[1]) * p.ScaleIn[1];
+    float rSq    = thetaX * thetaX + thetaY * thetaY;
+    float warp   = p.HmdWarp[0] + rSq * (p.HmdWarp[1] + rSq * (p.HmdWarp[2] + rSq * p.HmdWarp[3]));
+    float t1X    = thetaX * warp;
+    float t1Y    = thetaY * warp;
+    float red    = p.ChromAb[0] + p.ChromAb[1] * rSq;
+    float blue   = p.ChromAb[2] + p.ChromAb[3] * rSq;
+
+    texG[0] = p.LensCenter[0] + p.Scale[0] * t1X;
+    texG[1] = p.LensCenter[1] + p.Scale[1] * t1Y;
+    texR[0] = p.LensCenter[0] + p.Scale[0] * t1X * red;
+    texR[1] = p.LensCenter[1] + p.Scale[1] * t1Y * red;
+    texB[0] = p.LensCenter[0] + p.Scale[0] * t1X * blue;
+    texB[1] = p.LensCenter[1] + p.Scale[1] * t1Y * blue;
+}
+
+// True if all three coordinates are beyond the same edge of the lens bounds, so
+// anything interpolated between them is too.
+static bool outsideTogether(const DistortionMeshParams& p, const float* a, const float* b, const float* c)
+{
+    float minX = p.ScreenCenter[0] - 0.25f, maxX = p.ScreenCenter[0] + 0.25f;
+    float minY = p.ScreenCenter[1] - 0.5f,  maxY = p.ScreenCenter[1] + 0.5f;
+    return (a[0] < minX && b[0] < minX && c[0] < minX) ||
+           (a[0] > maxX && b[0] > maxX && c[0] > maxX) ||
+           (a[1] < minY && b[1] < minY && c[1] < minY) ||
+           (a[1] > maxY && b[1] > maxY && c[1] > maxY);
+}
+
+bool DistortionMesh::Update(const DistortionMeshParams& params, int gridSize)
+{
+    // Vertex indices are 16-bit.
+    if (gridSize < 1)
+        gridSize = 1;
+    if (gridSize > 255)
+        gridSize = 255;
+    if (Version && gridSize == GridSize && params == Params)
+        return false;
+
+    Params   = params;
+    GridSize = gridSize;
+    Version++;
+
+    int side = gridSize + 1;
+    Vertices.Resize(side * side);
+    for (int j = 0; j < side; j++)
+    {
+        float v = float(j) / gridSize;
+        for (int i = 0; i < side; i++)
+        {
+            float   u   = float(i) / gridSize;
+            Vertex& out = Vertices[j * side + i];
+            out.X = 2.0f * u - 1.0f;
+            out.Y = 1.0f - 2.0f * v;
+            Warp(params, params.X + u * params.W, params.Y + v * params.H, out.TexR, out.TexG, out.TexB);
+        }
+    }
+
+    // Two triangles per cell, split top-left to bottom-right and wound clockwise on
+    // screen, as the full-screen quad is. A triangle is dropped only if both the
+    // plain (green) and chromatic (blue) coordinates put all of it outside.
+    Indices.Clear();
+    Indices.Reserve(gridSize * gridSize * 6);
+    for (int j = 0; j < gridSize; j++)
+        for (int i = 0; i < gridSize; i++)
+        {
+            UInt16 tl = UInt16(j * side + i), tr = UInt16(tl + 1);
+            UInt16 bl = UInt16(tl + side),    br = UInt16(bl + 1);
+            UInt16 tris[2][3] = { { tl, tr, br }, { tl, br, bl } };
+            for (int t = 0; t < 2; t++)
+            {
+                const Vertex& a = Vertices[tris[t][0]];
+                const Vertex& b = Vertices[tris[t][1]];
+                const Vertex& c = Vertices[tris[t][2]];
+                if (outsideTogether(params, a.TexG, b.TexG, c.TexG) &&
+                    outsideTogether(params, a.TexB, b.TexB, c.TexB))
+                    continue;
+                Indices.PushBack(tris[t][0]);
+                Indices.PushBack(tris[t][1]);
+                Indices.PushBack(tris[t][2]);
+            }
+        }
+    return true;
+}
+
+void DistortionMesh::Sample(float u, float v, float texR[2], float texG[2], float texB[2]) const
+{
+    if (!GridSize)
+        return;
+
+    float gx = u * GridSize, gy = v * GridSize;
+    int   i  = int(floorf(gx)), j = int(floorf(gy));
+    i = (i < 0) ? 0 : ((i >= GridSize) ? GridSize - 1 : i);
+    j = (j < 0) ? 0 : ((j >= GridSize) ? GridSize - 1 : j);
+    float fx = gx - i, fy = gy - j;
+
+    // Barycentric weights in whichever of the cell's two triangles holds (fx, fy).
+    int           side = GridSize + 1;
+    const Vertex& tl   = Vertices[j * side + i];
+    const Vertex& br   = Vertices[(j + 1) * side + i + 1];
+    const Vertex& mid  = (fx >= fy) ? Vertices[j * side + i + 1] : Vertices[(j + 1) * side + i];
+    float wTL  = (fx >= fy) ? 1.0f - fx : 1.0f - fy;
+    float wBR  = (fx >= fy) ? fy : fx;
+    float wMid = 1.0f - wTL - wBR;
+
+    for (int k = 0; k < 2; k++)
+    {
+        texR[k] = tl.TexR[k] * wTL + mid.TexR[k] * wMid + br.TexR[k] * wBR;
+        texG[k] = tl.TexG[k] * wTL + mid.TexG[k] * wMid + br.TexG[k] * wBR;
+        texB[k] = tl.TexB[k] * wTL + mid.TexB[k] * wMid + br.TexB[k] * wBR;
+    }
+}
+
+} // OVR
@@ -0,0 +1,125 @@
+/************************************************************************************
+
+Filename    :   Util_DistortionMesh.h
+Content     :   Precomputed lens distortion warp mesh
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+#ifndef INC_Util_DistortionMesh_h
+#define INC_Util_DistortionMesh_h
+
+#include "../../LibOVR/Src/Kernel/OVR_Types.h"
+#include "../../LibOVR/Src/Kernel/OVR_Array.h"
+#include "Util/Util_Render_Stereo.h"
+
+namespace OVR {
+
+//-------------------------------------------------------------------------------------
+// ***** DistortionMeshParams
+
+// What the distortion post-process shaders are given for one eye, computed the way
+// RenderDevice::FinishScene computes their uniforms. Coordinates are normalized to
+// the window: 0..1 left to right and top to bottom, for both the screen and the
+// scene texture, which covers the window at the scene render scale.
+struct DistortionMeshParams
+{
+    float   LensCenter[2];
+    float   ScreenCenter[2];
+    float   Scale[2];
+    float   ScaleIn[2];
+    float   HmdWarp[4];
+    float   ChromAb[4];
+    // The eye's viewport.
+    float   X, Y, W, H;
+
+    // For an eye rendered into 'vp' of a windowWidth x windowHeight window.
+    static DistortionMeshParams FromConfig(const Util::Render::DistortionConfig& distortion,
+                                           const Util::Render::Viewport& vp,
+                                           int windowWidth, int windowHeight);
+
+    bool    operator==(const DistortionMeshParams& other) const;
+    bool    operator!=(const DistortionMeshParams& other) const { return !(*this == other); }
+};
+
+
+//-------------------------------------------------------------------------------------
+// ***** DistortionMesh
+
+// The distortion post-process as a mesh: a grid over one eye's viewport whose
+// vertices carry the scene texture coordinates the shader would compute there, one
+// pair per color channel for chromatic aberration. Drawing it with the coordinates
+// interpolated replaces evaluating the warp polynomial at every pixel with doing it
+// at every vertex. Against the per-pixel warp at 1280x800, a 32x32 grid averages
+// under a scene texel of error (about 5 at worst, near the lens edge where the warp
+// bends hardest); each doubling of the grid cuts that by four.
+//
+// Update() rebuilds only when the parameters or grid size change (IPD, stereo mode,
+// viewport or HMD), so a steady frame costs one comparison. Building is plain CPU
+// code with no render device, so it can be benchmarked and checked against Warp()
+// anywhere; -bench-distortion in the headless driver does both.
+
+class DistortionMesh
+{
+public:
+    enum { DefaultGridSize = 32 };
+
+    struct Vertex
+    {
+        // Position in the eye's viewport, -1..1, y up.
+        float   X, Y;
+        // Scene texture coordinates, window-normalized, per channel.
+        float   TexR[2], TexG[2], TexB[2];
+    };
+
+    DistortionMesh();
+
+    // Rebuilds the mesh with gridSize x gridSize cells if 'params' or the grid size
+    // differ from the last build. Returns true if it rebuilt.
+    bool                    Update(const DistortionMeshParams& params, int gridSize = DefaultGridSize);
+
+    const Array<Vertex>&    GetVertices() const     { return Vertices; }
+    // Triangle list. Cells entirely outside the lens, where the shaders output
+    // black, are left out.
+    const Array<UInt16>&    GetIndices() const      { return Indices; }
+    const DistortionMeshParams& GetParams() const   { return Params; }
+    int                     GetGridSize() const     { return GridSize; }
+    // Bumped by every rebuild.
+    unsigned                GetVersion() const      { return Version; }
+
+    // Texture coordinates the mesh gives at (u, v) in the viewport, 0..1 top to
+    // bottom, interpolated across the triangle the way a rasterizer would.
+    void                    Sample(float u, float v, float texR[2], float texG[2], float texB[2]) const;
+
+    // The per-pixel shader's warp at window-normalized (x, y), for reference.
+    static void             Warp(const DistortionMeshParams& params, float x, float y,
+                                 float texR[2], float texG[2], float texB[2]);
+    // Whether the shaders sample 'tex' (their blue coordinates) or output black.
+    static bool             IsInside(const DistortionMeshParams& params, const float tex[2])
+    {
+        return tex[0] >= params.ScreenCenter[0] - 0.25f && tex[0] <= params.ScreenCenter[0] + 0.25f &&
+               tex[1] >= params.ScreenCenter[1] - 0.5f  && tex[1] <= params.ScreenCenter[1] + 0.5f;
+    }
+
+private:
+    DistortionMeshParams    Params;
+    int                     GridSize;
+    unsigned                Version;
+    Array<Vertex>           Vertices;
+    Array<UInt16>           Indices;
+};
+
+} // OVR
+
+#endif
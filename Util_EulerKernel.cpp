@@ -0,0 +1,414 @@
+/************************************************************************************
+
+Filename    :   Util_EulerKernel.cpp
+Content     :   Batch quaternion to yaw/pitch/roll conversion (scalar, SSE2, AVX2)
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "Util_EulerKernel.h"
+
+#include <math.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define EULER_KERNEL_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define EULER_KERNEL_AVX2_TARGET
+#else
+#define EULER_KERNEL_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace OVR {
+
+// Polynomial coefficients shared by every path.
+static const float PI_F          = 3.14159265358979f;
+static const float HalfPi        = 1.57079632679490f;
+
+// atan(a) ~= a * P(a^2) on [0,1].
+static const float AtanC0        =  0.99997726f;
+static const float AtanC1        = -0.33262347f;
+static const float AtanC2        =  0.19354346f;
+static const float AtanC3        = -0.11643287f;
+static const float AtanC4        =  0.05265332f;
+static const float AtanC5        = -0.01172120f;
+
+// asin(x) ~= Pi/2 - sqrt(1-x) * P(x) on [0,1].
+static const float AsinC0        =  1.5707963050f;
+static const float AsinC1        = -0.2145988016f;
+static const float AsinC2        =  0.0889789874f;
+static const float AsinC3        = -0.0501743046f;
+static const float AsinC4        =  0.0308918810f;
+static const float AsinC5        = -0.0170881256f;
+static const float AsinC6        =  0.0066700901f;
+static const float AsinC7        = -0.0012624911f;
+
+
+//-------------------------------------------------------------------------------------
+// ***** Scalar path
+
+static inline float atan2Poly(float y, float x)
+{
+    float ax = fabsf(x), ay = fabsf(y);
+    float mx = (ax > ay) ? ax : ay;
+    float mn = (ax > ay) ? ay : ax;
+    float a  = (mx > 0.0f) ? mn / mx : 0.0f;
+    float a2 = a * a;
+    float r  = a * (AtanC0 + a2 * (AtanC1 + a2 * (AtanC2 + a2 * (AtanC3 + a2 * (AtanC4 + a2 * AtanC5)))));
+
+    if (ay > ax)
+        r = HalfPi - r;
+    if (x < 0.0f)
+        r = PI_F - r;
+    if (y < 0.0f)
+        r = -r;
+    return r;
+}
+
+static inline float asinPoly(float x)
+{
+    float ax = fabsf(x);
+    float p  = AsinC0 + ax * (AsinC1 + ax * (AsinC2 + ax * (AsinC3 + ax * (AsinC4 +
+               ax * (AsinC5 + ax * (AsinC6 + ax * AsinC7))))));
+    float r  = HalfPi - sqrtf(1.0f - ax) * p;
+    return (x < 0.0f) ? -r : r;
+}
+
+void QuatToEuler(const float quat[4], float* yaw, float* pitch, float* roll)
+{
+    float x = quat[0], y = quat[1], z = quat[2], w = quat[3];
+    float s = 2.0f * (w * y - x * z);
+
+    //it is invalid to pass values outside of the range -1,1 to asin()
+    if (s < 1.0f)
+    {
+        if (-1.0f < s)
+        {
+            *yaw   = atan2Poly(2.0f*(x*y+w*z), 1.0f-2.0f*(y*y+z*z));
+            *pitch = asinPoly(s);
+            *roll  = atan2Poly(2.0f*(y*z+w*x), 1.0f-2.0f*(x*x+y*y));
+        }
+        else
+        {
+            *yaw   = 0;
+            *pitch = -PI_F / 2;
+            *roll  = -atan2Poly(2.0f*(x*y-w*z), 1.0f-2.0f*(x*x+z*z));
+        }
+    }
+    else
+    {
+        *yaw   = 0;
+        *pitch = PI_F / 2;
+        *roll  = atan2Poly(2.0f*(x*y-w*z), 1.0f-2.0f*(x*x+z*z));
+    }
+}
+
+static void quatToEulerScalar(const UByte* src, UPInt strideBytes, UPInt count,
+                              float* yaw, float* pitch, float* roll)
+{
+    for (UPInt i = 0; i < count; i++, src += strideBytes)
+        QuatToEuler((const float*)src, yaw + i, pitch + i, roll + i);
+}
+
+
+#if defined(EULER_KERNEL_X86)
+
+//-------------------------------------------------------------------------------------
+// ***** SSE2 path
+
+static inline __m128 atan2SSE(__m128 y, __m128 x)
+{
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 zero     = _mm_setzero_ps();
+
+    __m128 ax = _mm_andnot_ps(signMask, x);
+    __m128 ay = _mm_andnot_ps(signMask, y);
+    __m128 mx = _mm_max_ps(ax, ay);
+    __m128 mn = _mm_min_ps(ax, ay);
+    __m128 a  = _mm_and_ps(_mm_div_ps(mn, mx), _mm_cmpgt_ps(mx, zero));
+    __m128 a2 = _mm_mul_ps(a, a);
+
+    __m128 p = _mm_set1_ps(AtanC5);
+    p = _mm_add_ps(_mm_mul_ps(p, a2), _mm_set1_ps(AtanC4));
+    p = _mm_add_ps(_mm_mul_ps(p, a2), _mm_set1_ps(AtanC3));
+    p = _mm_add_ps(_mm_mul_ps(p, a2), _mm_set1_ps(AtanC2));
+    p = _mm_add_ps(_mm_mul_ps(p, a2), _mm_set1_ps(AtanC1));
+    p = _mm_add_ps(_mm_mul_ps(p, a2), _mm_set1_ps(AtanC0));
+    __m128 r = _mm_mul_ps(a, p);
+
+    __m128 m = _mm_cmpgt_ps(ay, ax);
+    r = _mm_or_ps(_mm_and_ps(m, _mm_sub_ps(_mm_set1_ps(HalfPi), r)), _mm_andnot_ps(m, r));
+    m = _mm_cmplt_ps(x, zero);
+    r = _mm_or_ps(_mm_and_ps(m, _mm_sub_ps(_mm_set1_ps(PI_F), r)), _mm_andnot_ps(m, r));
+    m = _mm_cmplt_ps(y, zero);
+    return _mm_xor_ps(r, _mm_and_ps(m, signMask));
+}
+
+static inline __m128 asinSSE(__m128 x)
+{
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 one      = _mm_set1_ps(1.0f);
+
+    // Lanes outside [-1,1] are replaced by the caller; clamp so they stay finite.
+    __m128 ax = _mm_min_ps(_mm_andnot_ps(signMask, x), one);
+
+    __m128 p = _mm_set1_ps(AsinC7);
+    p = _mm_add_ps(_mm_mul_ps(p, ax), _mm_set1_ps(AsinC6));
+    p = _mm_add_ps(_mm_mul_ps(p, ax), _mm_set1_ps(AsinC5));
+    p = _mm_add_ps(_mm_mul_ps(p, ax), _mm_set1_ps(AsinC4));
+    p = _mm_add_ps(_mm_mul_ps(p, ax), _mm_set1_ps(AsinC3));
+    p = _mm_add_ps(_mm_mul_ps(p, ax), _mm_set1_ps(AsinC2));
+    p = _mm_add_ps(_mm_mul_ps(p, ax), _mm_set1_ps(AsinC1));
+    p = _mm_add_ps(_mm_mul_ps(p, ax), _mm_set1_ps(AsinC0));
+
+    __m128 r = _mm_sub_ps(_mm_set1_ps(HalfPi), _mm_mul_ps(_mm_sqrt_ps(_mm_sub_ps(one, ax)), p));
+    __m128 m = _mm_cmplt_ps(x, _mm_setzero_ps());
+    return _mm_xor_ps(r, _mm_and_ps(m, signMask));
+}
+
+static inline __m128 selectSSE(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static void quatToEulerSSE2(const UByte* src, UPInt strideBytes, UPInt count,
+                            float* yaw, float* pitch, float* roll)
+{
+    const __m128 one    = _mm_set1_ps(1.0f);
+    const __m128 two    = _mm_set1_ps(2.0f);
+    const __m128 minus1 = _mm_set1_ps(-1.0f);
+    const __m128 zero   = _mm_setzero_ps();
+    const __m128 signs  = _mm_set1_ps(-0.0f);
+
+    UPInt i = 0;
+    for (; i + 4 <= count; i += 4, src += 4 * strideBytes)
+    {
+        // Load four quaternions and transpose to x, y, z, w vectors.
+        __m128 x = _mm_loadu_ps((const float*)(src));
+        __m128 y = _mm_loadu_ps((const float*)(src + strideBytes));
+        __m128 z = _mm_loadu_ps((const float*)(src + 2 * strideBytes));
+        __m128 w = _mm_loadu_ps((const float*)(src + 3 * strideBytes));
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+
+        __m128 s  = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(w, y), _mm_mul_ps(x, z)));
+        __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+        __m128 xy = _mm_mul_ps(x, y), wz = _mm_mul_ps(w, z);
+
+        __m128 yawN   = atan2SSE(_mm_mul_ps(two, _mm_add_ps(xy, wz)),
+                                 _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))));
+        __m128 pitchN = asinSSE(s);
+        __m128 rollN  = atan2SSE(_mm_mul_ps(two, _mm_add_ps(_mm_mul_ps(y, z), _mm_mul_ps(w, x))),
+                                 _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))));
+        __m128 rollG  = atan2SSE(_mm_mul_ps(two, _mm_sub_ps(xy, wz)),
+                                 _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))));
+
+        // Same branch structure as the scalar code: !(s < 1) wins over !(-1 < s).
+        __m128 hi = _mm_cmpnlt_ps(s, one);
+        __m128 lo = _mm_andnot_ps(hi, _mm_cmpnlt_ps(minus1, s));
+        __m128 gimbal = _mm_or_ps(hi, lo);
+
+        __m128 pitchG = _mm_xor_ps(_mm_set1_ps(PI_F / 2), _mm_and_ps(lo, signs));
+        __m128 rollGS = _mm_xor_ps(rollG, _mm_and_ps(lo, signs));
+
+        _mm_storeu_ps(yaw + i,   selectSSE(gimbal, zero, yawN));
+        _mm_storeu_ps(pitch + i, selectSSE(gimbal, pitchG, pitchN));
+        _mm_storeu_ps(roll + i,  selectSSE(gimbal, rollGS, rollN));
+    }
+
+    quatToEulerScalar(src, strideBytes, count - i, yaw + i, pitch + i, roll + i);
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** AVX2 path
+
+EULER_KERNEL_AVX2_TARGET
+static inline __m256 atan2AVX(__m256 y, __m256 x)
+{
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    const __m256 zero     = _mm256_setzero_ps();
+
+    __m256 ax = _mm256_andnot_ps(signMask, x);
+    __m256 ay = _mm256_andnot_ps(signMask, y);
+    __m256 mx = _mm256_max_ps(ax, ay);
+    __m256 mn = _mm256_min_ps(ax, ay);
+    __m256 a  = _mm256_and_ps(_mm256_div_ps(mn, mx), _mm256_cmp_ps(mx, zero, _CMP_GT_OQ));
+    __m256 a2 = _mm256_mul_ps(a, a);
+
+    __m256 p = _mm256_set1_ps(AtanC5);
+    p = _mm256_add_ps(_mm256_mul_ps(p, a2), _mm256_set1_ps(AtanC4));
+    p = _mm256_add_ps(_mm256_mul_ps(p, a2), _mm256_set1_ps(AtanC3));
+    p = _mm256_add_ps(_mm256_mul_ps(p, a2), _mm256_set1_ps(AtanC2));
+    p = _mm256_add_ps(_mm256_mul_ps(p, a2), _mm256_set1_ps(AtanC1));
+    p = _mm256_add_ps(_mm256_mul_ps(p, a2), _mm256_set1_ps(AtanC0));
+    __m256 r = _mm256_mul_ps(a, p);
+
+    r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(HalfPi), r), _mm256_cmp_ps(ay, ax, _CMP_GT_OQ));
+    r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(PI_F), r), _mm256_cmp_ps(x, zero, _CMP_LT_OQ));
+    return _mm256_xor_ps(r, _mm256_and_ps(_mm256_cmp_ps(y, zero, _CMP_LT_OQ), signMask));
+}
+
+EULER_KERNEL_AVX2_TARGET
+static inline __m256 asinAVX(__m256 x)
+{
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    const __m256 one      = _mm256_set1_ps(1.0f);
+
+    __m256 ax = _mm256_min_ps(_mm256_andnot_ps(signMask, x), one);
+
+    __m256 p = _mm256_set1_ps(AsinC7);
+    p = _mm256_add_ps(_mm256_mul_ps(p, ax), _mm256_set1_ps(AsinC6));
+    p = _mm256_add_ps(_mm256_mul_ps(p, ax), _mm256_set1_ps(AsinC5));
+    p = _mm256_add_ps(_mm256_mul_ps(p, ax), _mm256_set1_ps(AsinC4));
+    p = _mm256_add_ps(_mm256_mul_ps(p, ax), _mm256_set1_ps(AsinC3));
+    p = _mm256_add_ps(_mm256_mul_ps(p, ax), _mm256_set1_ps(AsinC2));
+    p = _mm256_add_ps(_mm256_mul_ps(p, ax), _mm256_set1_ps(AsinC1));
+    p = _mm256_add_ps(_mm256_mul_ps(p, ax), _mm256_set1_ps(AsinC0));
+
+    __m256 r = _mm256_sub_ps(_mm256_set1_ps(HalfPi), _mm256_mul_ps(_mm256_sqrt_ps(_mm256_sub_ps(one, ax)), p));
+    return _mm256_xor_ps(r, _mm256_and_ps(_mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ), signMask));
+}
+
+EULER_KERNEL_AVX2_TARGET
+static inline __m256 load2AVX(const UByte* lo, const UByte* hi)
+{
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps((const float*)lo)),
+                                _mm_loadu_ps((const float*)hi), 1);
+}
+
+EULER_KERNEL_AVX2_TARGET
+static void quatToEulerAVX2(const UByte* src, UPInt strideBytes, UPInt count,
+                            float* yaw, float* pitch, float* roll)
+{
+    const __m256 one    = _mm256_set1_ps(1.0f);
+    const __m256 two    = _mm256_set1_ps(2.0f);
+    const __m256 minus1 = _mm256_set1_ps(-1.0f);
+    const __m256 zero   = _mm256_setzero_ps();
+    const __m256 signs  = _mm256_set1_ps(-0.0f);
+
+    UPInt i = 0;
+    for (; i + 8 <= count; i += 8, src += 8 * strideBytes)
+    {
+        // Quaternions 0-3 go to the low lane, 4-7 to the high lane; then a
+        // per-lane 4x4 transpose yields x, y, z, w vectors.
+        __m256 r0 = load2AVX(src,                   src + 4 * strideBytes);
+        __m256 r1 = load2AVX(src + strideBytes,     src + 5 * strideBytes);
+        __m256 r2 = load2AVX(src + 2 * strideBytes, src + 6 * strideBytes);
+        __m256 r3 = load2AVX(src + 3 * strideBytes, src + 7 * strideBytes);
+
+        __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+        __m256 t1 = _mm256_unpacklo_ps(r2, r3);
+        __m256 t2 = _mm256_unpackhi_ps(r0, r1);
+        __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+        __m256 x  = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1,0,1,0));
+        __m256 y  = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3,2,3,2));
+        __m256 z  = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1,0,1,0));
+        __m256 w  = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3,2,3,2));
+
+        __m256 s  = _mm256_mul_ps(two, _mm256_sub_ps(_mm256_mul_ps(w, y), _mm256_mul_ps(x, z)));
+        __m256 xx = _mm256_mul_ps(x, x), yy = _mm256_mul_ps(y, y), zz = _mm256_mul_ps(z, z);
+        __m256 xy = _mm256_mul_ps(x, y), wz = _mm256_mul_ps(w, z);
+
+        __m256 yawN   = atan2AVX(_mm256_mul_ps(two, _mm256_add_ps(xy, wz)),
+                                 _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(yy, zz))));
+        __m256 pitchN = asinAVX(s);
+        __m256 rollN  = atan2AVX(_mm256_mul_ps(two, _mm256_add_ps(_mm256_mul_ps(y, z), _mm256_mul_ps(w, x))),
+                                 _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, yy))));
+        __m256 rollG  = atan2AVX(_mm256_mul_ps(two, _mm256_sub_ps(xy, wz)),
+                                 _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, zz))));
+
+        __m256 hi = _mm256_cmp_ps(s, one, _CMP_NLT_UQ);
+        __m256 lo = _mm256_andnot_ps(hi, _mm256_cmp_ps(minus1, s, _CMP_NLT_UQ));
+        __m256 gimbal = _mm256_or_ps(hi, lo);
+
+        __m256 pitchG = _mm256_xor_ps(_mm256_set1_ps(PI_F / 2), _mm256_and_ps(lo, signs));
+        __m256 rollGS = _mm256_xor_ps(rollG, _mm256_and_ps(lo, signs));
+
+        _mm256_storeu_ps(yaw + i,   _mm256_blendv_ps(yawN, zero, gimbal));
+        _mm256_storeu_ps(pitch + i, _mm256_blendv_ps(pitchN, pitchG, gimbal));
+        _mm256_storeu_ps(roll + i,  _mm256_blendv_ps(rollN, rollGS, gimbal));
+    }
+
+    // Avoid AVX-SSE transition penalties in the scalar tail and in the caller.
+    _mm256_zeroupper();
+    quatToEulerScalar(src, strideBytes, count - i, yaw + i, pitch + i, roll + i);
+}
+
+static bool cpuSupportsAVX2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+
+    // OSXSAVE and AVX, then check the OS saves YMM state, then AVX2.
+    __cpuid(info, 1);
+    if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)
+        return false;
+    if ((_xgetbv(0) & 0x6) != 0x6)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif // EULER_KERNEL_X86
+
+
+//-------------------------------------------------------------------------------------
+// ***** Dispatch
+
+EulerKernelPath GetBestEulerKernelPath()
+{
+#if defined(EULER_KERNEL_X86)
+    static const EulerKernelPath best = cpuSupportsAVX2() ? EulerKernel_AVX2 : EulerKernel_SSE2;
+    return best;
+#else
+    return EulerKernel_Scalar;
+#endif
+}
+
+void QuatToEulerBatch(const float* quats, UPInt strideBytes, UPInt count,
+                      float* yaw, float* pitch, float* roll, EulerKernelPath path)
+{
+    const UByte* src = (const UByte*)quats;
+
+    if (path == EulerKernel_Auto)
+        path = GetBestEulerKernelPath();
+
+    switch (path)
+    {
+#if defined(EULER_KERNEL_X86)
+    case EulerKernel_AVX2:
+        quatToEulerAVX2(src, strideBytes, count, yaw, pitch, roll);
+        break;
+    case EulerKernel_SSE2:
+        quatToEulerSSE2(src, strideBytes, count, yaw, pitch, roll);
+        break;
+#endif
+    default:
+        quatToEulerScalar(src, strideBytes, count, yaw, pitch, roll);
+        break;
+    }
+}
+
+} // OVR
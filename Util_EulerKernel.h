@@ -0,0 +1,64 @@
+/************************************************************************************
+
+Filename    :   Util_EulerKernel.h
+Content     :   Batch quaternion to yaw/pitch/roll conversion (scalar, SSE2, AVX2)
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+#ifndef INC_Util_EulerKernel_h
+#define INC_Util_EulerKernel_h
+
+#include "../../LibOVR/Src/Kernel/OVR_Types.h"
+
+namespace OVR {
+
+//-------------------------------------------------------------------------------------
+// ***** Quaternion -> Euler kernel
+
+// Converts ThreeSpace quaternions (x, y, z, w) into yaw, pitch and roll the way
+// OnIdle always has, including its gimbal-lock handling: when |2(wy - xz)| >= 1,
+// yaw is forced to 0, pitch to +/-Pi/2 and all of the rotation is reported as roll.
+//
+// atan2 and asin are evaluated with polynomials rather than libm:
+//  atan2 - degree 11 odd minimax polynomial on [0,1] plus octant reduction;
+//          max abs error 2.0e-6 rad (0.00012 degrees).
+//  asin  - Abramowitz & Stegun 4.4.46, Pi/2 - sqrt(1-x) * P7(x);
+//          max abs error 4.0e-7 rad, dominated by float rounding.
+// All paths evaluate the same expressions, so they agree to within those bounds.
+
+enum EulerKernelPath
+{
+    EulerKernel_Auto,    // Best path supported by the CPU we are running on.
+    EulerKernel_Scalar,
+    EulerKernel_SSE2,    // 4 quaternions per iteration.
+    EulerKernel_AVX2     // 8 quaternions per iteration.
+};
+
+// Converts 'count' quaternions. quats points at the first quaternion's x; successive
+// quaternions are strideBytes apart, so the kernel can run directly over arrays of
+// stream packets or recording records. Outputs are separate arrays of 'count' floats.
+void            QuatToEulerBatch(const float* quats, UPInt strideBytes, UPInt count,
+                                 float* yaw, float* pitch, float* roll,
+                                 EulerKernelPath path = EulerKernel_Auto);
+
+// Converts a single quaternion with the scalar path.
+void            QuatToEuler(const float quat[4], float* yaw, float* pitch, float* roll);
+
+// Returns the path EulerKernel_Auto resolves to on this CPU.
+EulerKernelPath GetBestEulerKernelPath();
+
+} // OVR
+
+#endif
@@ -0,0 +1,218 @@
+/************************************************************************************
+
+Filename    :   Util_FrameTiming.cpp
+Content     :   Per-frame stage timing and latency histograms
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "Util_FrameTiming.h"
+#include "Util_Trace.h"
+#include "../../LibOVR/Src/Kernel/OVR_Log.h"
+
+#include <string.h>
+
+namespace OVR {
+
+//-------------------------------------------------------------------------------------
+// ***** LatencyHistogram
+
+void LatencyHistogram::Reset()
+{
+    memset(Buckets, 0, sizeof(Buckets));
+    Count = 0;
+    Min   = 0xFFFFFFFF;
+    Max   = 0;
+    Total = 0;
+}
+
+// Index of the highest set bit; mks >= LinearCount here.
+static inline unsigned highBit(UInt32 v)
+{
+    unsigned bit = 0;
+    while (v >>= 1)
+        bit++;
+    return bit;
+}
+
+unsigned LatencyHistogram::bucketIndex(UInt32 mks)
+{
+    if (mks < LinearCount)
+        return mks;
+    if (mks >= (1u << MaxValueBits))
+        mks = (1u << MaxValueBits) - 1;
+
+    // Keep the top SubBucketBits+1 bits; every doubling adds SubBucketCount buckets.
+    unsigned shift = highBit(mks) - SubBucketBits;
+    return shift * SubBucketCount + (mks >> shift);
+}
+
+UInt32 LatencyHistogram::bucketHigh(unsigned index)
+{
+    if (index < LinearCount)
+        return index;
+
+    unsigned shift = index / SubBucketCount - 1;
+    UInt32   sub   = index - shift * SubBucketCount;
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(UInt32 mks)
+{
+    Buckets[bucketIndex(mks)]++;
+    Count++;
+    Total += mks;
+    if (mks < Min)
+        Min = mks;
+    if (mks > Max)
+        Max = mks;
+}
+
+UInt32 LatencyHistogram::GetPercentile(double fraction) const
+{
+    if (Count == 0)
+        return 0;
+
+    // Rank of the wanted value, 1-based, rounded up.
+    double rankf = fraction * Count;
+    UInt32 rank  = (UInt32)rankf;
+    if (rank < rankf || rank == 0)
+        rank++;
+
+    UInt32 seen = 0;
+    for (unsigned i = 0; i < BucketCount; i++)
+    {
+        seen += Buckets[i];
+        if (seen >= rank)
+        {
+            // Never report past what was actually recorded.
+            UInt32 high = bucketHigh(i);
+            return (high < Max) ? high : Max;
+        }
+    }
+    return Max;
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** FrameTiming
+
+FrameTiming::FrameTiming()
+    : LastMarkTicks(0), SampleTicks(0), LastBeginTicks(0), FrameIndex(0), FramesSinceReset(0)
+{
+    memset(&Current, 0, sizeof(Current));
+}
+
+void FrameTiming::BeginFrame()
+{
+    UInt64 now = Timer::GetTicks();
+
+    Current.FrameIndex = FrameIndex;
+    Current.StageMask  = 0;
+    Current.BeginTicks = now;
+
+    if (LastBeginTicks)
+    {
+        Current.StageMks[FrameStage_Interval] = UInt32(now - LastBeginTicks);
+        Current.StageMask |= 1 << FrameStage_Interval;
+    }
+
+    LastBeginTicks = now;
+    LastMarkTicks  = now;
+    SampleTicks    = 0;
+}
+
+void FrameTiming::SetSampleTicks(UInt64 hostTicks)
+{
+    SampleTicks = hostTicks;
+}
+
+void FrameTiming::Mark(FrameStage stage)
+{
+    UInt64 now = Timer::GetTicks();
+    Current.StageMks[stage] = UInt32(now - LastMarkTicks);
+    Current.StageMask      |= 1 << stage;
+
+    if (Trace::IsEnabled())
+        Trace::Complete(GetStageName(stage), LastMarkTicks, now);
+    LastMarkTicks = now;
+}
+
+void FrameTiming::EndFrame()
+{
+    UInt64 now = Timer::GetTicks();
+
+    Current.StageMks[FrameStage_Frame] = UInt32(now - Current.BeginTicks);
+    Current.StageMask |= 1 << FrameStage_Frame;
+
+    if (Trace::IsEnabled())
+        Trace::Complete(GetStageName(FrameStage_Frame), Current.BeginTicks, now);
+
+    // A sample stamped after the frame began (a reader racing us) has zero age.
+    if (SampleTicks)
+    {
+        UInt64 sample = (SampleTicks < Current.BeginTicks) ? SampleTicks : Current.BeginTicks;
+        Current.StageMks[FrameStage_SampleAge]      = UInt32(Current.BeginTicks - sample);
+        Current.StageMks[FrameStage_MotionToPhoton] = UInt32(now - sample);
+        Current.StageMask |= (1 << FrameStage_SampleAge) | (1 << FrameStage_MotionToPhoton);
+    }
+
+    for (unsigned i = 0; i < FrameStage_Count; i++)
+    {
+        if (Current.StageMask & (1 << i))
+            Histograms[i].Record(Current.StageMks[i]);
+    }
+
+    Records.Push(Current);
+    FrameIndex++;
+    FramesSinceReset++;
+}
+
+void FrameTiming::Reset()
+{
+    for (unsigned i = 0; i < FrameStage_Count; i++)
+        Histograms[i].Reset();
+    FramesSinceReset = 0;
+}
+
+const char* FrameTiming::GetStageName(FrameStage stage)
+{
+    static const char* names[FrameStage_Count] =
+    {
+        "Sensor", "Input", "View", "Render0", "Render1", "Present", "Flush",
+        "Frame", "Interval", "SampleAge", "MotionToPhoton"
+    };
+    return names[stage];
+}
+
+void FrameTiming::Dump() const
+{
+    LogText("Frame timing over %u frames (mks):\n", FramesSinceReset);
+    LogText("  %-15s %8s %9s %8s %8s %8s %8s\n",
+            "Stage", "Count", "Mean", "p50", "p99", "p99.9", "Max");
+
+    for (unsigned i = 0; i < FrameStage_Count; i++)
+    {
+        const LatencyHistogram& h = Histograms[i];
+        if (h.GetCount() == 0)
+            continue;
+
+        LogText("  %-15s %8u %9.1f %8u %8u %8u %8u\n", GetStageName((FrameStage)i),
+                h.GetCount(), h.GetMean(), h.GetPercentile(0.5), h.GetPercentile(0.99),
+                h.GetPercentile(0.999), h.GetMax());
+    }
+}
+
+} // OVR
@@ -0,0 +1,160 @@
+/************************************************************************************
+
+Filename    :   Util_FrameTiming.h
+Content     :   Per-frame stage timing and latency histograms
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+#ifndef INC_Util_FrameTiming_h
+#define INC_Util_FrameTiming_h
+
+#include "../../LibOVR/Src/Kernel/OVR_Types.h"
+#include "../../LibOVR/Src/Kernel/OVR_Timer.h"
+#include "Util_SampleRing.h"
+
+namespace OVR {
+
+//-------------------------------------------------------------------------------------
+// ***** LatencyHistogram
+
+// Log-linear (HDR-style) histogram of microsecond durations. Values below 32 mks
+// are counted exactly; above that, every power of two is split into 16 buckets,
+// so any reported percentile is within 1/16 (6.25%) of the true value.
+// Values are clamped to 2^24 mks (about 16 seconds).
+//
+// Recording is one bucket increment; not thread safe, owned by one thread.
+
+class LatencyHistogram
+{
+public:
+    enum
+    {
+        SubBucketBits  = 4,
+        SubBucketCount = 1 << SubBucketBits,
+        LinearCount    = SubBucketCount * 2,
+        MaxValueBits   = 24,
+        BucketCount    = (MaxValueBits - SubBucketBits) * SubBucketCount + LinearCount
+    };
+
+    LatencyHistogram() { Reset(); }
+
+    void        Reset();
+    void        Record(UInt32 mks);
+
+    UInt32      GetCount() const { return Count; }
+    UInt32      GetMin() const   { return Count ? Min : 0; }
+    UInt32      GetMax() const   { return Max; }
+    double      GetMean() const  { return Count ? double(Total) / Count : 0.0; }
+
+    // Smallest value v such that at least 'fraction' of the recorded values are <= v,
+    // rounded up to its bucket's upper bound. fraction is 0..1, e.g. 0.999 for p99.9.
+    UInt32      GetPercentile(double fraction) const;
+
+private:
+    static unsigned bucketIndex(UInt32 mks);
+    static UInt32   bucketHigh(unsigned index);
+
+    UInt32      Buckets[BucketCount];
+    UInt32      Count;
+    UInt32      Min, Max;
+    UInt64      Total;
+};
+
+
+//-------------------------------------------------------------------------------------
+// ***** FrameTiming
+
+// Stages of one OnIdle frame. Sequential stages are measured from the previous
+// Mark() (or BeginFrame) to their own Mark(); the rest are derived in EndFrame.
+enum FrameStage
+{
+    FrameStage_Sensor,          // Sensor sampling, fusion and prediction.
+    FrameStage_Input,           // Gamepad/keyboard movement.
+    FrameStage_View,            // Head model and View matrix.
+    FrameStage_Render0,         // Render(StereoEyeParams), in call order.
+    FrameStage_Render1,
+    FrameStage_Present,
+    FrameStage_Flush,           // ForceFlushGPU.
+
+    FrameStage_Frame,           // BeginFrame to EndFrame.
+    FrameStage_Interval,        // BeginFrame to the next BeginFrame.
+    FrameStage_SampleAge,       // Host arrival of the frame's sensor sample to BeginFrame.
+    FrameStage_MotionToPhoton,  // Host arrival of the frame's sensor sample to EndFrame.
+
+    FrameStage_Count
+};
+
+// One frame's measurements, in microseconds. Stages that did not run that frame
+// (e.g. Render1 in mono, SampleAge without a sensor) have their bit clear in StageMask.
+struct FrameTimingRecord
+{
+    UInt32      FrameIndex;
+    UInt32      StageMask;
+    UInt64      BeginTicks;
+    UInt32      StageMks[FrameStage_Count];
+};
+
+// Always-on frame instrumentation. The render thread brackets each frame with
+// BeginFrame/EndFrame and calls Mark() as each stage completes; each call is a
+// Timer::GetTicks() and a store.
+//
+// Every finished frame is pushed into a lock-free ring, so another thread can
+// consume raw per-frame records with PopRecord, and folded into one LatencyHistogram
+// per stage, which Dump() logs as p50/p99/p99.9 on demand. Everything except
+// PopRecord must be called from the render thread.
+//
+// While a Trace is open, every stage and the whole frame are also traced.
+
+class FrameTiming
+{
+public:
+    FrameTiming();
+
+    void        BeginFrame();
+    // Host time (Timer::GetTicks()) the sensor sample driving this frame arrived.
+    void        SetSampleTicks(UInt64 hostTicks);
+    // Ends 'stage', which started at the previous Mark() or BeginFrame.
+    void        Mark(FrameStage stage);
+    void        EndFrame();
+
+    // Logs count, mean, p50, p99, p99.9 and max of every stage since the last Reset().
+    void        Dump() const;
+    // Clears the histograms; frame indices keep counting.
+    void        Reset();
+
+    const LatencyHistogram& GetHistogram(FrameStage stage) const { return Histograms[stage]; }
+    // Frames since construction, Reset() or not.
+    UInt32                  GetFrameCount() const                { return FrameIndex; }
+
+    // Consumer side of the per-frame ring; one consumer thread only.
+    bool        PopRecord(FrameTimingRecord* record) { return Records.Pop(record); }
+
+    static const char* GetStageName(FrameStage stage);
+
+private:
+    FrameTimingRecord                   Current;
+    UInt64                              LastMarkTicks;
+    UInt64                              SampleTicks;
+    UInt64                              LastBeginTicks;
+    UInt32                              FrameIndex;
+    UInt32                              FramesSinceReset;
+
+    LatencyHistogram                    Histograms[FrameStage_Count];
+    SampleRing<FrameTimingRecord, 128>  Records;
+};
+
+} // OVR
+
+#endif
@@ -0,0 +1,153 @@
+/************************************************************************************
+
+Filename    :   Util_MappedFile.cpp
+Content     :   Read-only memory mapped file
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "Util_MappedFile.h"
+
+#if defined(OVR_OS_WIN32)
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace OVR {
+
+//-------------------------------------------------------------------------------------
+// ***** MappedFile
+
+#if defined(OVR_OS_WIN32)
+
+MappedFile::MappedFile()
+    : hFile(INVALID_HANDLE_VALUE), hMapping(NULL), pData(0), Size(0), Opened(false)
+{
+}
+
+bool MappedFile::Open(const char* path)
+{
+    Close();
+
+    hFile = ::CreateFileA(path, GENERIC_READ, FILE_SHARE_READ|FILE_SHARE_WRITE, NULL,
+                          OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL|FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (hFile == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(hFile, &size))
+    {
+        Close();
+        return false;
+    }
+
+    Size   = (UPInt)size.QuadPart;
+    Opened = true;
+
+    // Zero-length files cannot be mapped; leave pData null.
+    if (Size == 0)
+        return true;
+
+    hMapping = ::CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (hMapping)
+        pData = (const UByte*)::MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (!pData)
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (pData)
+        ::UnmapViewOfFile(pData);
+    if (hMapping)
+        ::CloseHandle(hMapping);
+    if (hFile != INVALID_HANDLE_VALUE)
+        ::CloseHandle(hFile);
+
+    hFile    = INVALID_HANDLE_VALUE;
+    hMapping = NULL;
+    pData    = 0;
+    Size     = 0;
+    Opened   = false;
+}
+
+#else
+
+MappedFile::MappedFile()
+    : Fd(-1), pData(0), Size(0), Opened(false)
+{
+}
+
+bool MappedFile::Open(const char* path)
+{
+    Close();
+
+    Fd = ::open(path, O_RDONLY);
+    if (Fd < 0)
+        return false;
+
+    struct stat st;
+    if (::fstat(Fd, &st) != 0)
+    {
+        Close();
+        return false;
+    }
+
+    Size   = (UPInt)st.st_size;
+    Opened = true;
+
+    if (Size == 0)
+        return true;
+
+    void* p = ::mmap(0, Size, PROT_READ, MAP_PRIVATE, Fd, 0);
+    if (p == MAP_FAILED)
+    {
+        Close();
+        return false;
+    }
+    pData = (const UByte*)p;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (pData)
+        ::munmap((void*)pData, Size);
+    if (Fd >= 0)
+        ::close(Fd);
+
+    Fd     = -1;
+    pData  = 0;
+    Size   = 0;
+    Opened = false;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+} // OVR
@@ -0,0 +1,64 @@
+/************************************************************************************
+
+Filename    :   Util_MappedFile.h
+Content     :   Read-only memory mapped file
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+#ifndef INC_Util_MappedFile_h
+#define INC_Util_MappedFile_h
+
+#include "../../LibOVR/Src/Kernel/OVR_Types.h"
+
+namespace OVR {
+
+//-------------------------------------------------------------------------------------
+// ***** MappedFile
+
+// Maps a whole file read-only into the address space. The data stays valid until
+// Close() or destruction. Empty files open successfully with GetSize() == 0.
+
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    bool            Open(const char* path);
+    void            Close();
+
+    bool            IsOpen() const  { return Opened; }
+    const UByte*    GetData() const { return pData; }
+    UPInt           GetSize() const { return Size; }
+
+private:
+    // Not copyable; owns OS handles.
+    MappedFile(const MappedFile&);
+    void operator=(const MappedFile&);
+
+#if defined(OVR_OS_WIN32)
+    void*           hFile;
+    void*           hMapping;
+#else
+    int             Fd;
+#endif
+    const UByte*    pData;
+    UPInt           Size;
+    bool            Opened;
+};
+
+} // OVR
+
+#endif
@@ -0,0 +1,136 @@
+/************************************************************************************
+
+Filename    :   Util_SampleRing.h
+Content     :   Lock-free single-producer/single-consumer sample ring
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+#ifndef INC_Util_SampleRing_h
+#define INC_Util_SampleRing_h
+
+#include "../../LibOVR/Src/Kernel/OVR_Types.h"
+#include "../../LibOVR/Src/Kernel/OVR_Atomic.h"
+
+#if defined(OVR_CC_MSVC)
+#include <intrin.h>
+#endif
+
+namespace OVR {
+
+//-------------------------------------------------------------------------------------
+// ***** SampleRing
+
+// Fixed-size ring of POD samples written by exactly one producer thread and read by
+// exactly one consumer thread, without locks.
+//
+// The producer never blocks: once the ring is full, Push overwrites the oldest sample.
+// This is what we want for sensor data, where a stale sample is worth less than a
+// fresh one. The consumer detects overwritten slots by re-reading the write counter
+// after copying a sample out, so reads never return a torn sample.
+//
+//  Push        - Producer only. Publishes a new sample, wait-free.
+//  PeekLatest  - Consumer only. Copies out the newest sample, wait-free.
+//  Pop         - Consumer only. Returns samples oldest-first, skipping any that
+//                were overwritten before the consumer got to them; those are
+//                counted in GetDroppedCount().
+//
+// Capacity must be a power of two.
+
+template<class T, unsigned Capacity>
+class SampleRing
+{
+public:
+    enum { Mask = Capacity - 1 };
+
+    SampleRing() : WriteCount(0), ReadCount(0), DroppedCount(0)
+    {
+        OVR_COMPILER_ASSERT((Capacity & Mask) == 0);
+    }
+
+    void Push(const T& sample)
+    {
+        UInt32 index = WriteCount.Load_Acquire();
+        // The count that invalidates the slot's old sample (published by the last
+        // Push) must be visible before any of the new sample is.
+        fence();
+        Slots[index & Mask] = sample;
+        WriteCount.Store_Release(index + 1);
+    }
+
+    bool PeekLatest(T* sample) const
+    {
+        UInt32 count = WriteCount.Load_Acquire();
+        if (count == 0)
+            return false;
+        return readSlot(count - 1, sample);
+    }
+
+    bool Pop(T* sample)
+    {
+        UInt32 count = WriteCount.Load_Acquire();
+
+        // If the producer has lapped us, skip ahead to the oldest slot still intact.
+        if (count - ReadCount > (UInt32)Capacity - 1)
+        {
+            DroppedCount += count - (Capacity - 1) - ReadCount;
+            ReadCount     = count - (Capacity - 1);
+        }
+
+        while (ReadCount != count)
+        {
+            if (readSlot(ReadCount++, sample))
+                return true;
+            DroppedCount++;
+        }
+        return false;
+    }
+
+    // Total number of samples ever pushed; wraps at 2^32.
+    UInt32 GetWriteCount() const { return WriteCount.Load_Acquire(); }
+    // Samples Pop skipped because they were overwritten; consumer only.
+    UInt32 GetDroppedCount() const { return DroppedCount; }
+
+private:
+    // Copies sample 'index' and validates that the producer did not start
+    // overwriting its slot while we were copying it. The fence keeps the copy's
+    // loads, which the compiler and CPU may otherwise sink past the acquire, ahead
+    // of the re-check.
+    bool readSlot(UInt32 index, T* sample) const
+    {
+        *sample = Slots[index & Mask];
+        fence();
+        return (WriteCount.Load_Acquire() - index) < (UInt32)Capacity;
+    }
+
+    // Full compiler and CPU memory barrier.
+    static void fence()
+    {
+#if defined(OVR_CC_MSVC)
+        _ReadWriteBarrier();
+        _mm_mfence();
+#else
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#endif
+    }
+
+    AtomicInt<UInt32>   WriteCount;
+    UInt32              ReadCount;
+    UInt32              DroppedCount;
+    T                   Slots[Capacity];
+};
+
+} // OVR
+
+#endif
@@ -0,0 +1,235 @@
+/************************************************************************************
+
+Filename    :   Util_TaskGraph.cpp
+Content     :   Runs dependent startup tasks concurrently
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "Util_TaskGraph.h"
+#include "Util_Trace.h"
+#include "../../LibOVR/Src/Kernel/OVR_Timer.h"
+#include "../../LibOVR/Src/Kernel/OVR_Log.h"
+
+namespace OVR {
+
+//-------------------------------------------------------------------------------------
+// ***** TaskGraph
+
+TaskGraph::TaskGraph(const char* name)
+    : Name(name), Remaining(0), Running(0), NextWorker(0), StartTicks(0), EndTicks(0)
+{
+}
+
+int TaskGraph::AddTask(const char* name, TaskFn fn, void* context, TaskThread thread)
+{
+    Task task;
+    task.Name               = name;
+    task.Fn                 = fn;
+    task.Context            = context;
+    task.Thread             = thread;
+    task.Status             = Task_Pending;
+    task.PendingCount       = 0;
+    task.PrerequisiteFailed = false;
+    task.StartTicks         = 0;
+    task.EndTicks           = 0;
+    task.Worker             = -1;
+
+    Tasks.PushBack(task);
+    return int(Tasks.GetSize() - 1);
+}
+
+void TaskGraph::AddDependency(int task, int prerequisite)
+{
+    OVR_ASSERT(task != prerequisite);
+    Tasks[prerequisite].Dependents.PushBack(task);
+    Tasks[task].PendingCount++;
+}
+
+int TaskGraph::takeReady(TaskThread thread)
+{
+    for (UPInt i = 0; i < Tasks.GetSize(); i++)
+    {
+        Task& task = Tasks[i];
+        if (task.Status == Task_Pending && task.PendingCount == 0 && task.Thread == thread)
+        {
+            task.Status = Task_Running;
+            Running++;
+            return int(i);
+        }
+    }
+    return -1;
+}
+
+void TaskGraph::finish(int index, TaskStatus status)
+{
+    Task& task  = Tasks[index];
+    task.Status = status;
+    Remaining--;
+
+    for (UPInt i = 0; i < task.Dependents.GetSize(); i++)
+    {
+        int   dependentIndex = task.Dependents[i];
+        Task& dependent      = Tasks[dependentIndex];
+
+        if (status != Task_Succeeded)
+            dependent.PrerequisiteFailed = true;
+        if (--dependent.PendingCount == 0 && dependent.PrerequisiteFailed)
+            finish(dependentIndex, Task_Skipped);
+    }
+}
+
+// Nothing running and nothing can start, yet tasks remain: a dependency cycle.
+bool TaskGraph::isStuck() const
+{
+    if (Running || !Remaining)
+        return false;
+    for (UPInt i = 0; i < Tasks.GetSize(); i++)
+        if (Tasks[i].Status == Task_Pending && Tasks[i].PendingCount == 0)
+            return false;
+    return true;
+}
+
+void TaskGraph::runTask(int index, int worker)
+{
+    Task& task      = Tasks[index];
+    task.Worker     = worker;
+    task.StartTicks = Timer::GetTicks();
+
+    bool ok = task.Fn(task.Context);
+
+    task.EndTicks = Timer::GetTicks();
+    Trace::Complete(task.Name, task.StartTicks, task.EndTicks);
+
+    Mutex::Locker lock(&TaskLock);
+    Running--;
+    finish(index, ok ? Task_Succeeded : Task_Failed);
+    TaskChanged.NotifyAll();
+}
+
+int TaskGraph::workerThreadFn(Thread*, void* graphPtr)
+{
+    TaskGraph* graph = (TaskGraph*)graphPtr;
+    int        worker;
+
+    {
+        Mutex::Locker lock(&graph->TaskLock);
+        worker = int(graph->NextWorker++);
+    }
+
+    static const char* names[MaxWorkers] =
+        { "Startup Worker 0", "Startup Worker 1", "Startup Worker 2", "Startup Worker 3" };
+    Trace::SetThreadName(names[worker]);
+
+    for (;;)
+    {
+        int index;
+        {
+            Mutex::Locker lock(&graph->TaskLock);
+            while ((index = graph->takeReady(Thread_Worker)) < 0)
+            {
+                if (!graph->Remaining || graph->isStuck())
+                    return 0;
+                graph->TaskChanged.Wait(&graph->TaskLock);
+            }
+        }
+        graph->runTask(index, worker);
+    }
+}
+
+bool TaskGraph::Run()
+{
+    StartTicks = Timer::GetTicks();
+    Remaining  = unsigned(Tasks.GetSize());
+    Running    = 0;
+    NextWorker = 0;
+
+    // One pool thread per worker task that could run at once, up to MaxWorkers.
+    unsigned workerTasks = 0;
+    for (UPInt i = 0; i < Tasks.GetSize(); i++)
+        if (Tasks[i].Thread == Thread_Worker)
+            workerTasks++;
+
+    unsigned   workerCount = (workerTasks < (unsigned)MaxWorkers) ? workerTasks : (unsigned)MaxWorkers;
+    Ptr<Thread> workers[MaxWorkers];
+    for (unsigned i = 0; i < workerCount; i++)
+    {
+        workers[i] = *new Thread(&workerThreadFn, this);
+        workers[i]->Start();
+    }
+
+    // Main-thread tasks run here as they become ready.
+    for (;;)
+    {
+        int index;
+        {
+            Mutex::Locker lock(&TaskLock);
+            while ((index = takeReady(Thread_Main)) < 0)
+            {
+                if (!Remaining)
+                    break;
+                if (isStuck())
+                {
+                    LogText("%s: dependency cycle, skipping %u tasks\n", Name, Remaining);
+                    for (UPInt i = 0; i < Tasks.GetSize(); i++)
+                        if (Tasks[i].Status == Task_Pending)
+                        {
+                            Tasks[i].Status = Task_Skipped;
+                            Remaining--;
+                        }
+                    TaskChanged.NotifyAll();
+                    break;
+                }
+                TaskChanged.Wait(&TaskLock);
+            }
+        }
+        if (index < 0)
+            break;
+        runTask(index, -1);
+    }
+
+    for (unsigned i = 0; i < workerCount; i++)
+        while (!workers[i]->IsFinished())
+            Thread::MSleep(1);
+
+    EndTicks = Timer::GetTicks();
+
+    bool ok = true;
+    for (UPInt i = 0; i < Tasks.GetSize(); i++)
+        if (Tasks[i].Status != Task_Succeeded)
+            ok = false;
+    return ok;
+}
+
+void TaskGraph::Dump() const
+{
+    static const char* statusNames[] = { "pending", "running", "ok", "FAILED", "skipped" };
+
+    LogText("%s: %u tasks in %.1f ms\n", Name, (unsigned)Tasks.GetSize(),
+            (EndTicks - StartTicks) / 1000.0);
+    for (UPInt i = 0; i < Tasks.GetSize(); i++)
+    {
+        const Task& task = Tasks[i];
+        if (task.StartTicks)
+            LogText("  %-28s %-8s %s %-2d start %8.1f ms, took %8.1f ms\n", task.Name,
+                    statusNames[task.Status], task.Worker < 0 ? "main  " : "worker",
+                    task.Worker < 0 ? 0 : task.Worker,
+                    (task.StartTicks - StartTicks) / 1000.0, (task.EndTicks - task.StartTicks) / 1000.0);
+        else
+            LogText("  %-28s %-8s\n", task.Name, statusNames[task.Status]);
+    }
+}
+
+} // OVR
@@ -0,0 +1,128 @@
+/************************************************************************************
+
+Filename    :   Util_TaskGraph.h
+Content     :   Runs dependent startup tasks concurrently
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+#ifndef INC_Util_TaskGraph_h
+#define INC_Util_TaskGraph_h
+
+#include "../../LibOVR/Src/Kernel/OVR_Types.h"
+#include "../../LibOVR/Src/Kernel/OVR_Array.h"
+#include "../../LibOVR/Src/Kernel/OVR_Threads.h"
+
+namespace OVR {
+
+//-------------------------------------------------------------------------------------
+// ***** TaskGraph
+
+// A one-shot dependency graph of tasks, for overlapping slow, independent startup
+// work such as serial device discovery with window and D3D creation.
+//
+// Each task runs once all its prerequisites have succeeded. Worker tasks run on a
+// small pool of threads; Thread_Main tasks run on the thread that calls Run(), for
+// work tied to it (window creation, the D3D device). If a task fails, everything
+// that depends on it is skipped, and Run() returns false.
+//
+//   TaskGraph graph("Startup");
+//   int rift   = graph.AddTask("Rift detection", &detectRift, this);
+//   int window = graph.AddTask("Window", &createWindow, this, TaskGraph::Thread_Main);
+//   graph.AddDependency(window, rift);
+//   graph.Run();
+//
+// Every task is traced under its name, which must therefore be a string literal.
+
+class TaskGraph
+{
+public:
+    typedef bool (*TaskFn)(void* context);
+
+    enum TaskThread
+    {
+        Thread_Worker,
+        Thread_Main
+    };
+
+    enum TaskStatus
+    {
+        Task_Pending,
+        Task_Running,
+        Task_Succeeded,
+        Task_Failed,
+        Task_Skipped    // A prerequisite failed, or the graph has a cycle.
+    };
+
+    enum { MaxWorkers = 4 };
+
+    TaskGraph(const char* name);
+
+    // Returns the task's index, used to add dependencies.
+    int         AddTask(const char* name, TaskFn fn, void* context,
+                        TaskThread thread = Thread_Worker);
+    // 'task' will not start before 'prerequisite' has succeeded.
+    void        AddDependency(int task, int prerequisite);
+
+    // Runs every task and returns once all have finished; true if all succeeded.
+    bool        Run();
+
+    TaskStatus  GetStatus(int task) const   { return Tasks[task].Status; }
+    // Microseconds from Run() to the end of the last task.
+    UInt64      GetDuration() const         { return EndTicks - StartTicks; }
+
+    // Logs when each task ran relative to Run(), and on which thread.
+    void        Dump() const;
+
+    // Adapts a bool-returning member function to TaskFn:
+    //   graph.AddTask("Window", &TaskGraph::MemberTask<App, &App::setupWindow>, this);
+    template<class C, bool (C::*Fn)()>
+    static bool MemberTask(void* object) { return (static_cast<C*>(object)->*Fn)(); }
+
+private:
+    struct Task
+    {
+        const char*     Name;
+        TaskFn          Fn;
+        void*           Context;
+        TaskThread      Thread;
+        TaskStatus      Status;
+        unsigned        PendingCount;   // Prerequisites not yet finished.
+        bool            PrerequisiteFailed;
+        Array<int>      Dependents;
+        UInt64          StartTicks, EndTicks;
+        int             Worker;         // Pool thread index, or -1 for the main thread.
+    };
+
+    // All of these expect TaskLock held.
+    int         takeReady(TaskThread thread);
+    void        finish(int index, TaskStatus status);
+    bool        isStuck() const;
+
+    void        runTask(int index, int worker);
+    static int  workerThreadFn(Thread* thread, void* graph);
+
+    const char*         Name;
+    Array<Task>         Tasks;
+    Mutex               TaskLock;
+    WaitCondition       TaskChanged;
+    unsigned            Remaining;
+    unsigned            Running;
+    unsigned            NextWorker;
+    UInt64              StartTicks, EndTicks;
+};
+
+} // OVR
+
+#endif
@@ -0,0 +1,260 @@
+/************************************************************************************
+
+Filename    :   Util_Trace.cpp
+Content     :   Low-overhead Chrome JSON trace of timed events
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "Util_Trace.h"
+#include "Util_SampleRing.h"
+#include "../../LibOVR/Src/Kernel/OVR_Threads.h"
+#include "../../LibOVR/Src/Kernel/OVR_Log.h"
+
+#include <stdio.h>
+
+#if defined(_MSC_VER)
+#define OVR_TRACE_THREAD_LOCAL __declspec(thread)
+#else
+#define OVR_TRACE_THREAD_LOCAL __thread
+#endif
+
+namespace OVR {
+
+//-------------------------------------------------------------------------------------
+// ***** Per-thread event buffers
+
+struct TraceEvent
+{
+    const char* Name;
+    UInt64      StartTicks;
+    UInt32      DurationMks;
+};
+
+struct TraceThreadBuffer
+{
+    SampleRing<TraceEvent, Trace::RingSize> Events;
+    AtomicPtr<const char>                   Name;
+};
+
+// Buffers are claimed once per thread, on its first event while tracing, and
+// never released, so a thread can keep pushing into its ring without any lock or
+// lifetime check. Threads that never record an event never take one.
+static TraceThreadBuffer        ThreadBuffers[Trace::MaxThreads];
+static AtomicInt<UInt32>        ThreadBufferCount;
+
+// 0 - not claimed yet; -1 - no buffer left; otherwise buffer index + 1.
+static OVR_TRACE_THREAD_LOCAL int         ThreadBufferSlot = 0;
+static OVR_TRACE_THREAD_LOCAL const char* ThreadName       = 0;
+
+static TraceThreadBuffer* getThreadBuffer()
+{
+    if (ThreadBufferSlot == 0)
+    {
+        UInt32 index = ThreadBufferCount.ExchangeAdd_NoSync(1);
+        if (index < (UInt32)Trace::MaxThreads)
+        {
+            ThreadBufferSlot = int(index + 1);
+            ThreadBuffers[index].Name.Store_Release(ThreadName);
+        }
+        else
+        {
+            ThreadBufferSlot = -1;
+            if (index == (UInt32)Trace::MaxThreads)
+                LogText("Trace: More than %u threads; events from %s and later threads are dropped\n",
+                        (unsigned)Trace::MaxThreads, ThreadName ? ThreadName : "this");
+        }
+    }
+    return (ThreadBufferSlot > 0) ? &ThreadBuffers[ThreadBufferSlot - 1] : 0;
+}
+
+// Only buffers already claimed, without claiming one.
+static TraceThreadBuffer* findThreadBuffer()
+{
+    return (ThreadBufferSlot > 0) ? &ThreadBuffers[ThreadBufferSlot - 1] : 0;
+}
+
+static UInt32 getClaimedBufferCount()
+{
+    UInt32 count = ThreadBufferCount.Load_Acquire();
+    return (count < (UInt32)Trace::MaxThreads) ? count : (UInt32)Trace::MaxThreads;
+}
+
+
+// Events pushed after a previous Close() belong to no trace.
+static void discardBufferedEvents()
+{
+    UInt32 buffers = getClaimedBufferCount();
+    for (UInt32 i = 0; i < buffers; i++)
+    {
+        TraceEvent event;
+        while (ThreadBuffers[i].Events.Pop(&event))
+            ;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** TraceFlushThread
+
+// Drains every thread's ring into the trace file. Formatting and file I/O only
+// ever happen here.
+
+class TraceFlushThread : public Thread
+{
+public:
+    TraceFlushThread(FILE* file, UInt64 baseTicks)
+        : pFile(file), BaseTicks(baseTicks), EventCount(0)
+    { }
+
+    // Writes out everything buffered.
+    void        Drain();
+    // Writes thread names and the trailer, then closes the file.
+    void        Finish();
+
+protected:
+    virtual int Run();
+
+private:
+    enum { FlushIntervalMs = 10 };
+
+    void        writeSeparator() { if (EventCount++) fputs(",\n", pFile); }
+
+    FILE*       pFile;
+    UInt64      BaseTicks;
+    UInt32      EventCount;
+};
+
+void TraceFlushThread::Drain()
+{
+    UInt32 buffers = getClaimedBufferCount();
+
+    for (UInt32 i = 0; i < buffers; i++)
+    {
+        TraceEvent event;
+        while (ThreadBuffers[i].Events.Pop(&event))
+        {
+            UInt64 ts = (event.StartTicks > BaseTicks) ? event.StartTicks - BaseTicks : 0;
+            writeSeparator();
+            fprintf(pFile, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%llu,\"dur\":%u}",
+                    event.Name, i + 1, (unsigned long long)ts, event.DurationMks);
+        }
+    }
+}
+
+void TraceFlushThread::Finish()
+{
+    UInt32 buffers = getClaimedBufferCount();
+
+    for (UInt32 i = 0; i < buffers; i++)
+    {
+        const char* name = ThreadBuffers[i].Name.Load_Acquire();
+        if (!name)
+            continue;
+
+        writeSeparator();
+        fprintf(pFile, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+                       "\"args\":{\"name\":\"%s\"}}", i + 1, name);
+    }
+
+    fputs("\n],\"displayTimeUnit\":\"ms\"}\n", pFile);
+    fclose(pFile);
+    pFile = 0;
+}
+
+int TraceFlushThread::Run()
+{
+    while (!GetExitFlag())
+    {
+        Thread::MSleep(FlushIntervalMs);
+        Drain();
+    }
+    return 0;
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** Trace
+
+AtomicInt<UInt32>               Trace::Enabled;
+static Ptr<TraceFlushThread>    pFlushThread;
+
+bool Trace::Open(const char* path)
+{
+    if (pFlushThread)
+        Close();
+
+    FILE* file = fopen(path, "w");
+    if (!file)
+    {
+        LogText("Trace: Can't create %s\n", path);
+        return false;
+    }
+    setvbuf(file, 0, _IOFBF, 64 * 1024);
+    fputs("{\"traceEvents\":[\n", file);
+
+    discardBufferedEvents();
+
+    pFlushThread = *new TraceFlushThread(file, Timer::GetTicks());
+    pFlushThread->Start();
+    Enabled.Store_Release(1);
+
+    LogText("Trace: Writing %s\n", path);
+    return true;
+}
+
+void Trace::Close()
+{
+    if (!pFlushThread)
+        return;
+
+    Enabled.Store_Release(0);
+
+    pFlushThread->SetExitFlag(true);
+    while (!pFlushThread->IsFinished())
+        Thread::MSleep(1);
+
+    // The flush thread is gone, so draining the rest here does not race it.
+    pFlushThread->Drain();
+    pFlushThread->Finish();
+    pFlushThread.Clear();
+}
+
+void Trace::Complete(const char* name, UInt64 startTicks, UInt64 endTicks)
+{
+    if (!IsEnabled())
+        return;
+
+    TraceThreadBuffer* buffer = getThreadBuffer();
+    if (!buffer)
+        return;
+
+    TraceEvent event;
+    event.Name        = name;
+    event.StartTicks  = startTicks;
+    event.DurationMks = UInt32(endTicks - startTicks);
+    buffer->Events.Push(event);
+}
+
+void Trace::SetThreadName(const char* name)
+{
+    ThreadName = name;
+
+    TraceThreadBuffer* buffer = findThreadBuffer();
+    if (buffer)
+        buffer->Name.Store_Release(name);
+}
+
+} // OVR
@@ -0,0 +1,102 @@
+/************************************************************************************
+
+Filename    :   Util_Trace.h
+Content     :   Low-overhead Chrome JSON trace of timed events
+Created     :   October 16, 2026
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+#ifndef INC_Util_Trace_h
+#define INC_Util_Trace_h
+
+#include "../../LibOVR/Src/Kernel/OVR_Types.h"
+#include "../../LibOVR/Src/Kernel/OVR_Atomic.h"
+#include "../../LibOVR/Src/Kernel/OVR_Timer.h"
+
+namespace OVR {
+
+//-------------------------------------------------------------------------------------
+// ***** Trace
+
+// Writes timed events to a Chrome JSON trace file ("Trace Event Format"), which
+// chrome://tracing and ui.perfetto.dev open as a per-thread timeline.
+//
+// Recording an event never formats or does I/O: each thread pushes fixed-size
+// events into its own lock-free SampleRing, and a background thread drains all
+// rings every few milliseconds and writes them out. When tracing is off, every
+// call costs one atomic load.
+//
+// Event names are stored by pointer and must be string literals (or otherwise
+// outlive the trace) and need no JSON escaping.
+//
+// A thread takes one of MaxThreads event rings on its first event while tracing;
+// threads that only name themselves take none. Events from threads beyond
+// MaxThreads are dropped, which is logged once. A thread's ring holds RingSize
+// events; if the writer falls that far behind, the oldest events are dropped.
+
+class Trace
+{
+public:
+    enum { MaxThreads = 32, RingSize = 1024 };
+
+    // Starts tracing into a new file at 'path'. Returns false if it can't be created.
+    static bool     Open(const char* path);
+    // Stops tracing, writes everything still buffered and closes the file.
+    static void     Close();
+
+    static bool     IsEnabled() { return Enabled.Load_Acquire() != 0; }
+
+    // Records a complete event spanning [startTicks, endTicks] (Timer::GetTicks())
+    // on the calling thread.
+    static void     Complete(const char* name, UInt64 startTicks, UInt64 endTicks);
+
+    // Names the calling thread in the timeline. May be called before Open, and
+    // costs nothing if the thread never records an event.
+    static void     SetThreadName(const char* name);
+
+private:
+    static AtomicInt<UInt32> Enabled;
+};
+
+
+//-------------------------------------------------------------------------------------
+// ***** TraceScope
+
+// Records a complete event covering the lifetime of the scope:
+//
+//   {
+//       TraceScope trace("PopulateRoomScene");
+//       ...
+//   }
+
+class TraceScope
+{
+public:
+    TraceScope(const char* name)
+        : Name(name), StartTicks(Trace::IsEnabled() ? Timer::GetTicks() : 0)
+    { }
+    ~TraceScope()
+    {
+        if (StartTicks)
+            Trace::Complete(Name, StartTicks, Timer::GetTicks());
+    }
+
+private:
+    const char* Name;
+    UInt64      StartTicks;
+};
+
+} // OVR
+
+#endif
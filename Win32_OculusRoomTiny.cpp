@@ -30,17 +30,9 @@ limitations under the License.
 //header file
 #include "ThreeSpaceAPI/yei_threespace_api.h"
 
-//When getting stream data use a packed structure
-#pragma pack(push,1)
-typedef struct {
-    float quat[4];
-} tss_stream_packet;
-#pragma pack(pop)
-
-//The device id
-TSS_Device_Id tss_device;
-bool tss_isStreaming = false;
-tss_stream_packet tss_packet;
+//The streaming devices; the first one found is the head.
+TSS_Device_Id tss_devices[ThreeSpaceSensorGroup::MaxSensors];
+unsigned int tss_deviceCount = 0;
 unsigned int tss_timestamp;
 
 
@@ -55,19 +47,18 @@ OculusRoomTinyApp* OculusRoomTinyApp::pApp = 0;
 
 OculusRoomTinyApp::OculusRoomTinyApp(HINSTANCE hinst)
     : pRender(0),
-      LastUpdate(0),
             
       // Win32
       hWnd(NULL),
       hInstance(hinst), Quit(0), MouseCaptured(true),    
       hXInputModule(0), pXInputGetState(0),
-      
-      // Initial location
-      EyePos(0.0f, 1.6f, -5.0f),
-      EyeYaw(YawInitial), EyePitch(0), EyeRoll(0),
-      LastSensorYaw(0),
       SConfig(),
       PostProcess(PostProcess_Distortion),
+      SoftRender(false),
+      SinglePassStereo(false),
+      DistortionMeshGrid(0),
+      CullScene(true),
+      StaticBatchVertices(-1),
       ShiftDown(false),
       ControlDown(false)
 {
@@ -78,14 +69,24 @@ OculusRoomTinyApp::OculusRoomTinyApp(HINSTANCE hinst)
 
     StartupTicks = OVR::Timer::GetTicks();
     LastPadPacketNo = 0;
-   
-    MoveForward   = MoveBack = MoveLeft = MoveRight = 0;
-    GamepadMove   = Vector3f(0);
-    GamepadRotate = Vector3f(0);
+
+    TSSCachePath = "ThreeSpaceDevices.cache";
+    TSSRescanPending = false;
 }
 
 OculusRoomTinyApp::~OculusRoomTinyApp()
 {
+    // Reader threads must be gone before streaming is stopped in WinMain.
+    finishThreeSpaceRescan(true);
+    TSSSensors.Stop();
+    Simulation.Stop();
+    Simulation.SetJournal(0);
+    InputJournal.Close();
+    Trace::Close();
+
+    if (Timing.GetFrameCount())
+        Timing.Dump();
+
 	RemoveHandlerFromDevices();
     pSensor.Clear();
     pHMD.Clear();
@@ -93,14 +94,139 @@ OculusRoomTinyApp::~OculusRoomTinyApp()
     pApp = 0;
 }
 
-int OculusRoomTinyApp::OnStartup(const char* args)
+// Finds every ThreeSpace sensor, up to ThreeSpaceSensorGroup::MaxSensors, and starts
+// streaming from each. Streaming devices are added to tss_devices.
+//
+// The ports sensors were found on last time (TSSCachePath) are opened first, and
+// the slow scan of every COM port only runs now when there is no cache or a cached
+// sensor has gone missing. Otherwise it is left to rescanThreeSpace() after the
+// first frame, so a sensor added since the cache was written still turns up.
+void OculusRoomTinyApp::setupThreeSpaceDevices()
 {
-    OVR_UNUSED(args);
+    ThreeSpaceDeviceCache cache;
+    if (!TSSCachePath.IsEmpty())
+        cache.Load(TSSCachePath.ToCStr());
 
-    
+    Array<ThreeSpaceDeviceConfig> cached;
+    cache.GetConfigs(&cached);
+
+    for (UPInt i = 0; i < cached.GetSize() && tss_deviceCount < ThreeSpaceSensorGroup::MaxSensors; i++)
+    {
+        TSSTriedPorts.PushBack(cached[i].Port);
+
+        TSS_Device_Id tss_device = setupThreeSpaceDevice(cached[i].Port.ToCStr(), &cache);
+        if (tss_device != TSS_NO_DEVICE_ID)
+            tss_devices[tss_deviceCount++] = tss_device;
+        else
+            cache.Remove(cached[i].SerialNumber);
+    }
+
+    if (cached.GetSize() == 0 || tss_deviceCount < cached.GetSize())
+        scanThreeSpacePorts(&cache);
+    else
+    {
+        LogText("TSS: All %u cached sensors found, port scan deferred\n", tss_deviceCount);
+        TSSRescanPending = (tss_deviceCount < ThreeSpaceSensorGroup::MaxSensors);
+    }
+
+    if (!TSSCachePath.IsEmpty())
+        cache.Save(TSSCachePath.ToCStr());
+
+    if (tss_deviceCount == 0)
+        LogText("No sensors found\n");
+    else
+        LogText("TSS: Streaming from %u sensors\n", tss_deviceCount);
+}
+
+// Starts streaming from a sensor on every COM port not tried yet, until there are
+// ThreeSpaceSensorGroup::MaxSensors.
+void OculusRoomTinyApp::scanThreeSpacePorts(ThreeSpaceDeviceCache* cache)
+{
+    TraceScope trace("tss_getComPorts");
+    TSS_ComPort tss_comports[ThreeSpaceSensorGroup::MaxSensors];
+
+    int found = tss_getComPorts(tss_comports, ThreeSpaceSensorGroup::MaxSensors, 0,
+                                TSS_FIND_ALL_KNOWN^TSS_FIND_DNG);
+
+    for (int i = 0; i < found && tss_deviceCount < ThreeSpaceSensorGroup::MaxSensors; i++)
+    {
+        bool tried = false;
+        for (UPInt j = 0; j < TSSTriedPorts.GetSize(); j++)
+            tried = tried || (TSSTriedPorts[j] == tss_comports[i].com_port);
+        if (tried)
+            continue;
+        TSSTriedPorts.PushBack(tss_comports[i].com_port);
+
+        TSS_Device_Id tss_device = setupThreeSpaceDevice(tss_comports[i].com_port, cache);
+        if (tss_device != TSS_NO_DEVICE_ID)
+            tss_devices[tss_deviceCount++] = tss_device;
+    }
+}
+
+// The port scan setupThreeSpaceDevices deferred, on a thread of its own so the
+// serial I/O never stalls a frame. Sensors it finds get reader threads here, but
+// only join TSSSensors in finishThreeSpaceRescan, on the main thread.
+void OculusRoomTinyApp::rescanThreeSpace()
+{
+    TraceScope trace("ThreeSpace rescan");
+
+    ThreeSpaceDeviceCache cache;
+    if (!TSSCachePath.IsEmpty())
+        cache.Load(TSSCachePath.ToCStr());
+
+    unsigned first = tss_deviceCount;
+    scanThreeSpacePorts(&cache);
+    if (tss_deviceCount == first)
+        return;
+
+    if (!TSSCachePath.IsEmpty())
+        cache.Save(TSSCachePath.ToCStr());
+
+    for (unsigned i = first; i < tss_deviceCount; i++)
+    {
+        Ptr<ThreeSpaceSource> source = *new ThreeSpaceDeviceSource(tss_devices[i]);
+        Ptr<ThreeSpaceReader> reader = *new ThreeSpaceReader(source);
+        reader->Start();
+        TSSRescanReaders.PushBack(reader);
+    }
+    LogText("TSS: Rescan found %u new sensors\n", tss_deviceCount - first);
+}
+
+int OculusRoomTinyApp::rescanThreadFn(Thread*, void* app)
+{
+    Trace::SetThreadName("ThreeSpace Rescan");
+    ((OculusRoomTinyApp*)app)->rescanThreeSpace();
+    return 0;
+}
+
+// Adds the sensors the rescan found once it is done; if 'wait', waits for it.
+void OculusRoomTinyApp::finishThreeSpaceRescan(bool wait)
+{
+    if (!pTSSRescan)
+        return;
+    while (!pTSSRescan->IsFinished())
+    {
+        if (!wait)
+            return;
+        Thread::MSleep(1);
+    }
+    pTSSRescan.Clear();
+
+    for (UPInt i = 0; i < TSSRescanReaders.GetSize(); i++)
+        TSSSensors.AddSensor(TSSRescanReaders[i]);
+    TSSRescanReaders.Clear();
+}
+
+// Configures and starts streaming from the sensor on one port, and records it in
+// the cache. If the cache says the sensor was given the same settings before, they
+// are read back and only re-sent if the sensor has lost them.
+// Returns the device, or TSS_NO_DEVICE_ID if it could not be started.
+TSS_Device_Id OculusRoomTinyApp::setupThreeSpaceDevice(const char* port, ThreeSpaceDeviceCache* cache)
+{
     // *** ThreeSpace initialisation
     //TSS_Error tss_error;
-    TSS_ComPort tss_comport;
+    TSS_Device_Id tss_device;
+    bool tss_isStreaming = false;
 
     LARGE_INTEGER tss_frequency; //ticks per second
     LARGE_INTEGER tss_t1, tss_t2; //ticks
@@ -108,35 +234,51 @@ int OculusRoomTinyApp::OnStartup(const char* args)
     QueryPerformanceCounter(&tss_t1);
     QueryPerformanceCounter(&tss_t2);
 
-    unsigned int tss_serial;
+    unsigned int tss_serial = 0;
+    bool tss_hasSerial = false;
 
-    if(tss_getComPorts(&tss_comport,1,0,TSS_FIND_ALL_KNOWN^TSS_FIND_DNG))
+    tss_device = tss_createTSDeviceStr(port, TSS_TIMESTAMP_SENSOR);
+    if(tss_device == TSS_NO_DEVICE_ID)
     {
-        tss_device = tss_createTSDeviceStr(tss_comport.com_port, TSS_TIMESTAMP_SENSOR);
-        if(tss_device == TSS_NO_DEVICE_ID)
-        {
-            LogText("Failed to create a sensor on %s\n", tss_comport.com_port);
-        }
-        else
-        {
-            if(tss_getSerialNumber(tss_device, &tss_serial, NULL) == TSS_NO_ERROR)
-                LogText("Connected to ThreeSpace sensor!! Port: %s Serial: %x\n", 
-                    tss_comport.com_port, tss_serial);
-        }
+        LogText("Failed to create a sensor on %s\n", port);
+        return TSS_NO_DEVICE_ID;
     }
     else
     {
-        LogText("No sensors found\n");
+        tss_hasSerial = (tss_getSerialNumber(tss_device, &tss_serial, NULL) == TSS_NO_ERROR);
+        if(tss_hasSerial)
+            LogText("Connected to ThreeSpace sensor!! Port: %s Serial: %x\n", 
+                port, tss_serial);
     }
     // ***
 
-    // *** Set ThreeSpace axis directions SetTSAxisDirections()
+    // Settings this sensor should end up with; compared with the cache.
     TSS_Axis_Direction axis_order = TSS_XZY;
     char neg_x = 1;
     char neg_y = 1;
     char neg_z = 0;
-    unsigned char axis_dir_byte = tss_generateAxisDirections(axis_order, neg_x, neg_y, neg_z);
-    if( tss_setAxisDirections(tss_device, axis_dir_byte, &tss_timestamp) == 0 )
+
+    // Every channel ThreeSpaceDeviceSource decodes comes in the same packet.
+    TSS_Stream_Command tss_stream_slots[TSS_StreamSlotCount];
+    ThreeSpaceStreamLayout::GetSlots(tss_stream_slots);
+
+    ThreeSpaceDeviceConfig config;
+    config.SerialNumber   = tss_serial;
+    config.Port           = port;
+    config.AxisDirections = tss_generateAxisDirections(axis_order, neg_x, neg_y, neg_z);
+    config.IntervalMks    = 0;
+    ThreeSpaceStreamLayout::GetSlots(config.Slots);
+
+    ThreeSpaceDeviceConfig cached;
+    bool warm = tss_hasSerial && cache->Find(tss_serial, &cached) && cached.SameSettings(config);
+
+    // *** Set ThreeSpace axis directions SetTSAxisDirections()
+    unsigned char axis_dir_byte = config.AxisDirections;
+    unsigned char tss_axis;
+    if (warm && tss_getAxisDirections(tss_device, &tss_axis, NULL) == TSS_NO_ERROR &&
+        tss_axis == axis_dir_byte)
+        LogText("TSS: Axis verified from cache\n");
+    else if( tss_setAxisDirections(tss_device, axis_dir_byte, &tss_timestamp) == 0 )
         LogText("TSS: Set axis complete!\n");
     else
         LogText("TSS: Set axis failed!\n");
@@ -169,10 +311,19 @@ int OculusRoomTinyApp::OnStartup(const char* args)
     */
 
     // *** StartStreaming
-    TSS_Stream_Command tss_stream_slots[8] = { TSS_GET_TARED_ORIENTATION_AS_QUATERNION, TSS_NULL,
-                                               TSS_NULL, TSS_NULL,
-                                               TSS_NULL, TSS_NULL,
-                                               TSS_NULL, TSS_NULL};
+    bool tss_streamingSet = false;
+    if (warm)
+    {
+        TSS_Stream_Command tss_slots[TSS_StreamSlotCount];
+        unsigned int interval, duration, delay;
+        tss_streamingSet =
+            tss_getStreamingSlots(tss_device, tss_slots, NULL) == TSS_NO_ERROR &&
+            memcmp(tss_slots, tss_stream_slots, sizeof(tss_slots)) == 0 &&
+            tss_getStreamingTiming(tss_device, &interval, &duration, &delay, NULL) == TSS_NO_ERROR &&
+            interval == 0 && duration == TSS_INFINITE_DURATION && delay == 0;
+        if (tss_streamingSet)
+            LogText("TSS: Streaming settings verified from cache\n");
+    }
 
     int count = 0;
     if(!tss_isStreaming)
@@ -180,29 +331,35 @@ int OculusRoomTinyApp::OnStartup(const char* args)
         //3 Attempts
         while( count < 3)
         {
-            if(tss_setStreamingTiming(tss_device,0, TSS_INFINITE_DURATION, 0, NULL) == 0)
+            if(tss_streamingSet ||
+               (tss_setStreamingTiming(tss_device,0, TSS_INFINITE_DURATION, 0, NULL) == 0 &&
+                tss_setStreamingSlots(tss_device, tss_stream_slots, NULL) == 0))
             {
-                if(tss_setStreamingSlots(tss_device, tss_stream_slots, NULL) == 0)
+                if(tss_startStreaming(tss_device, NULL) == 0)
                 {
-                    if(tss_startStreaming(tss_device, NULL) == 0)
-                    {
-                        tss_isStreaming =  true;
-                        LogText("TSS: Start streaming success!\n");
-                        break;
-                    }
+                    tss_isStreaming =  true;
+                    LogText("TSS: Start streaming success!\n");
+                    break;
                 }
             }
+            // Send everything on a retry, whatever the sensor reported.
+            tss_streamingSet = false;
             count++;
         }
     }
     if(!tss_isStreaming)
     {
         LogText("TSS: Start streaming failed!\n");
+        tss_closeTSDevice(tss_device);
+        return TSS_NO_DEVICE_ID;
     }
+    if (tss_hasSerial)
+        cache->Set(config);
     // ***
 
     // *** tareSensor
     tss_tareWithCurrentOrientation(tss_device,NULL);
+
     /*
     float forward[3];
     float down[3];
@@ -228,13 +385,203 @@ int OculusRoomTinyApp::OnStartup(const char* args)
     // ***
     */
 
-    // *** Oculus HMD & Sensor Initialization
+    return tss_device;
+}
+
+// Starts a ThreeSpace reader thread for each live sensor, or one for a recording,
+// optionally recording everything the head sensor reads. Startup task: it runs on a
+// worker, and nothing else touches TSSSensors until startup is done. Missing
+// sensors are not an error.
+bool OculusRoomTinyApp::startThreeSpace()
+{
+    Ptr<ThreeSpaceRecorder> recorder;
+    if (!TSSRecordPath.IsEmpty())
+    {
+        recorder = *new ThreeSpaceRecorder;
+        if (recorder->Open(TSSRecordPath.ToCStr()))
+            LogText("TSS: Recording to %s\n", TSSRecordPath.ToCStr());
+        else
+            recorder.Clear();
+    }
+
+    Ptr<ThreeSpaceSource> sources[ThreeSpaceSensorGroup::MaxSensors];
+    unsigned              sourceCount = 0;
+    if (!TSSReplayPath.IsEmpty())
+    {
+        Ptr<ThreeSpaceReplaySource> replay = *new ThreeSpaceReplaySource;
+        if (replay->Open(TSSReplayPath.ToCStr()))
+            sources[sourceCount++] = replay;
+    }
+    else
+    {
+        TraceScope trace("ThreeSpace discovery");
+        setupThreeSpaceDevices();
+        for (unsigned i = 0; i < tss_deviceCount; i++)
+            sources[sourceCount++] = *new ThreeSpaceDeviceSource(tss_devices[i]);
+    }
+
+    // Hand each source over to its own reader thread, so sensors are read in
+    // parallel; OnIdle only reads their samples.
+    for (unsigned i = 0; i < sourceCount; i++)
+    {
+        Ptr<ThreeSpaceReader> reader = *new ThreeSpaceReader(sources[i], (i == 0) ? recorder.GetPtr() : 0);
+        reader->Start();
+        TSSSensors.AddSensor(reader);
+    }
+    return true;
+}
+
+// Recognized arguments:
+//  -tss-record <file>  Append every ThreeSpace sample read to a recording.
+//  -tss-replay <file>  Replay a recording instead of using the live sensor.
+//  -view-euler         Start with RoomCamera::ViewPath_Euler.
+//  -tss-predict <ms>   ThreeSpace prediction interval; 0 disables prediction.
+//  -trace <file>       Write a Chrome JSON trace.
+//  -tss-cache <file>   ThreeSpace device cache (default ThreeSpaceDevices.cache);
+//                      "" disables it.
+//  -input-record <file> Write every movement input event to a journal.
+//  -input-replay <file> Move by a journal's events instead of live input.
+void OculusRoomTinyApp::parseCommandLine(const char* args)
+{
+    Array<String> tokens;
+    const char*   p = args ? args : "";
+
+    while (*p)
+    {
+        while (*p == ' ' || *p == '\t')
+            p++;
+        if (!*p)
+            break;
+
+        const char* start;
+        const char* end;
+        if (*p == '"')
+        {
+            start = ++p;
+            while (*p && *p != '"')
+                p++;
+            end = p;
+            if (*p)
+                p++;
+        }
+        else
+        {
+            start = p;
+            while (*p && *p != ' ' && *p != '\t')
+                p++;
+            end = p;
+        }
+        tokens.PushBack(String(start, end - start));
+    }
 
+    for (UPInt i = 0; i < tokens.GetSize(); i++)
+    {
+        bool hasValue = (i + 1 < tokens.GetSize());
+
+        if (tokens[i] == "-tss-record" && hasValue)
+            TSSRecordPath = tokens[++i];
+        else if (tokens[i] == "-tss-replay" && hasValue)
+            TSSReplayPath = tokens[++i];
+        else if (tokens[i] == "-trace" && hasValue)
+            TracePath = tokens[++i];
+        else if (tokens[i] == "-tss-cache" && hasValue)
+            TSSCachePath = tokens[++i];
+        else if (tokens[i] == "-input-record" && hasValue)
+            InputRecordPath = tokens[++i];
+        else if (tokens[i] == "-input-replay" && hasValue)
+            InputReplayPath = tokens[++i];
+        else if (tokens[i] == "-view-euler")
+            Camera.ViewPath = RoomCamera::ViewPath_Euler;
+        else if (tokens[i] == "-soft-render")
+            SoftRender = true;
+        else if (tokens[i] == "-stereo-single-pass")
+            SinglePassStereo = true;
+        else if (tokens[i] == "-no-cull")
+            CullScene = false;
+        else if (tokens[i] == "-scene" && hasValue)
+            ScenePath = tokens[++i];
+        else if (tokens[i] == "-static-batch" && hasValue)
+            StaticBatchVertices = atoi(tokens[++i].ToCStr());
+        else if (tokens[i] == "-distortion-mesh" && hasValue)
+            DistortionMeshGrid = atoi(tokens[++i].ToCStr());
+        else if (tokens[i] == "-tss-predict" && hasValue)
+        {
+            float ms = (float)atof(tokens[++i].ToCStr());
+            TSSSensors.SetPredictionEnabled(ms > 0.0f);
+            TSSSensors.SetPredictionInterval(ms * 0.001f);
+        }
+        else
+            LogText("Ignoring unknown argument: %s\n", tokens[i].ToCStr());
+    }
+}
+
+int OculusRoomTinyApp::OnStartup(const char* args)
+{
+    parseCommandLine(args);
+
+    Trace::SetThreadName("Main");
+    if (!TracePath.IsEmpty())
+        Trace::Open(TracePath.ToCStr());
+
+    // Startup is a graph of tasks rather than one sequence: ThreeSpace discovery is
+    // hundreds of milliseconds of serial I/O per port and needs nothing else, so it
+    // runs on a worker while the Rift is detected and the window, render device and
+    // scene are created. The window needs the HMD's resolution and monitor, so that
+    // chain does wait for Rift detection. Window and D3D work stays on this thread,
+    // which owns the message loop.
+    TaskGraph startup("Startup");
+
+    startup.AddTask("ThreeSpace startup",
+                    &TaskGraph::MemberTask<OculusRoomTinyApp, &OculusRoomTinyApp::startThreeSpace>, this);
+
+    int rift       = startup.AddTask("Rift detection",
+                                     &TaskGraph::MemberTask<OculusRoomTinyApp, &OculusRoomTinyApp::setupRift>, this);
+    int window     = startup.AddTask("Window",
+                                     &TaskGraph::MemberTask<OculusRoomTinyApp, &OculusRoomTinyApp::setupWindow>, this,
+                                     TaskGraph::Thread_Main);
+    int render     = startup.AddTask("Render device",
+                                     &TaskGraph::MemberTask<OculusRoomTinyApp, &OculusRoomTinyApp::setupRendering>, this,
+                                     TaskGraph::Thread_Main);
+    int scene      = startup.AddTask("PopulateRoomScene",
+                                     &TaskGraph::MemberTask<OculusRoomTinyApp, &OculusRoomTinyApp::setupScene>, this,
+                                     TaskGraph::Thread_Main);
+
+    startup.AddDependency(window, rift);
+    startup.AddDependency(render, window);
+    startup.AddDependency(scene, render);
+
+    bool started = startup.Run();
+    startup.Dump();
+    if (!started)
+        return 1;
+
+    // Movement steps at 1 kHz from here on, whatever the frame rate.
+    if (!InputRecordPath.IsEmpty() &&
+        InputJournal.Open(InputRecordPath.ToCStr(), Simulation.GetStepMks()))
+        Simulation.SetJournal(&InputJournal);
+    if (!InputReplayPath.IsEmpty())
+    {
+        if (InputReplay.Open(InputReplayPath.ToCStr()))
+            Simulation.SetReplay(&InputReplay);
+        else
+            LogText("Can't replay input journal %s; using live input\n", InputReplayPath.ToCStr());
+    }
+    Simulation.Start();
+    return 0;
+}
+
+// *** Oculus HMD & Sensor Initialization
+// Startup task; fails only if the user cancels detection.
+bool OculusRoomTinyApp::setupRift()
+{
     // Create DeviceManager and first available HMDDevice from it.
     // Sensor object is created from the HMD, to ensure that it is on the
     // correct device.
 
-    pManager = *DeviceManager::Create();
+    {
+        TraceScope trace("DeviceManager::Create");
+        pManager = *DeviceManager::Create();
+    }
 
 	// We'll handle it's messages in this case.
 	pManager->SetMessageHandler(this);
@@ -250,9 +597,13 @@ int OculusRoomTinyApp::OnStartup(const char* args)
         pHMD.Clear();
         RenderParams.MonitorName.Clear();
 
-        pHMD  = *pManager->EnumerateDevices<HMDDevice>().CreateDevice();
+        {
+            TraceScope trace("Enumerate HMDDevice");
+            pHMD  = *pManager->EnumerateDevices<HMDDevice>().CreateDevice();
+        }
         if (pHMD)
         {
+            TraceScope trace("HMDDevice::GetSensor");
             pSensor = *pHMD->GetSensor();
 
             // This will initialize HMDInfo with information about configured IPD,
@@ -271,6 +622,7 @@ int OculusRoomTinyApp::OnStartup(const char* args)
             // If we didn't detect an HMD, try to create the sensor directly.
             // This is useful for debugging sensor interaction; it is not needed in
             // a shipping app.
+            TraceScope trace("Enumerate SensorDevice");
             pSensor = *pManager->EnumerateDevices<SensorDevice>().CreateDevice();
         }
 
@@ -300,7 +652,7 @@ int OculusRoomTinyApp::OnStartup(const char* args)
                                             MB_CANCELTRYCONTINUE|MB_ICONWARNING);
 
             if (detectionResult == IDCANCEL)
-                return 1;
+                return false;
         }
 
     } while (detectionResult != IDCONTINUE);
@@ -311,10 +663,6 @@ int OculusRoomTinyApp::OnStartup(const char* args)
         Height = HMDInfo.VResolution;
     }
 
-
-    if (!setupWindow())
-        return 1;
-    
     if (pSensor)
     {
         // We need to attach sensor to SensorFusion object for it to receive 
@@ -324,18 +672,31 @@ int OculusRoomTinyApp::OnStartup(const char* args)
         SFusion.SetDelegateMessageHandler(this);
         SFusion.SetPredictionEnabled(true);
     }
+    return true;
+}
 
-    
-    // *** Initialize Rendering
-   
+// *** Initialize Rendering
+// Startup task, on the main thread after setupWindow.
+bool OculusRoomTinyApp::setupRendering()
+{
     // Enable multi-sampling by default.
     RenderParams.Multisample = 4;
     RenderParams.Fullscreen  = true;
 
     // Setup Graphics.
-    pRender = *RenderTiny::D3D10::RenderDevice::CreateDevice(RenderParams, (void*)hWnd);
+    {
+        TraceScope trace("RenderDevice::CreateDevice");
+        if (SoftRender)
+        {
+            pSoftRender = *RenderTiny::Soft::RenderDevice::CreateDevice(RenderParams, (void*)hWnd);
+            pRender     = pSoftRender.GetPtr();
+            pSoftRender->SetDistortionMeshGrid(DistortionMeshGrid);
+        }
+        else
+            pRender = *RenderTiny::D3D10::RenderDevice::CreateDevice(RenderParams, (void*)hWnd);
+    }
     if (!pRender)
-        return 1;
+        return false;
 
 
     // *** Configure Stereo settings.
@@ -358,16 +719,33 @@ int OculusRoomTinyApp::OnStartup(const char* args)
     pRender->SetSceneRenderScale(SConfig.GetDistortionScale());
 
     SConfig.Set2DAreaFov(DegreeToRad(85.0f));
+    return true;
+}
 
-
-    // *** Populate Room Scene
-
-    // This creates lights and models.
-    PopulateRoomScene(&Scene, pRender);
-
-
-    LastUpdate = GetAppTime();
-    return 0;
+// *** Populate Room Scene
+// Startup task; this creates lights and models.
+bool OculusRoomTinyApp::setupScene()
+{
+    SceneFile file;
+    if (!ScenePath.IsEmpty() && file.Open(ScenePath.ToCStr()))
+    {
+        file.Populate(&Scene, pRender);
+        LogText("Loaded %u models from %s\n", file.GetHeader().ModelCount, ScenePath.ToCStr());
+    }
+    else
+        PopulateRoomScene(&Scene, pRender);
+    if (StaticBatchVertices >= 0)
+    {
+        // Nothing in the room moves, so all of it can be merged.
+        StaticBatch batch;
+        batch.Build(&Scene.World, StaticBatchVertices ? (unsigned)StaticBatchVertices :
+                                                        (unsigned)StaticBatch::MaxVertices);
+        LogText("Static batching: %u models into %u batches (%u vertices), %u kept\n",
+                batch.GetStats().Models, batch.GetStats().Batches, batch.GetStats().Vertices,
+                batch.GetStats().Kept);
+    }
+    SceneCull.Build(&Scene);
+    return true;
 }
 
 void OculusRoomTinyApp::OnMessage(const Message& msg)
@@ -393,10 +771,7 @@ void OculusRoomTinyApp::OnMessage(const Message& msg)
 
 void OculusRoomTinyApp::OnGamepad(float padLx, float padLy, float padRx, float padRy)
 {
-    GamepadMove   = Vector3f(padLx * padLx * (padLx > 0 ? 1 : -1),
-                             0,
-                             padLy * padLy * (padLy > 0 ? -1 : 1));
-    GamepadRotate = Vector3f(2 * padRx, -2 * padRy, 0);
+    Simulation.PushEvent(RoomInputEvent::Gamepad(Timer::GetTicks(), padLx, padLy, padRx, padRy));
 }
 
 void OculusRoomTinyApp::OnMouseMove(int x, int y, int modifiers)
@@ -404,26 +779,15 @@ void OculusRoomTinyApp::OnMouseMove(int x, int y, int modifiers)
     OVR_UNUSED(modifiers);
 
     // Mouse motion here is always relative.
-    int         dx = x, dy = y; 
-    const float maxPitch = ((3.1415f/2)*0.98f);
-
-    // Apply to rotation. Subtract for right body frame rotation,
-    // since yaw rotation is positive CCW when looking down on XZ plane.
-    EyeYaw   -= (Sensitivity * dx)/ 360.0f;
-
-    if (!pSensor)
-    {
-        EyePitch -= (Sensitivity * dy)/ 360.0f;
-        
-        if (EyePitch > maxPitch)
-            EyePitch = maxPitch;
-        if (EyePitch < -maxPitch)
-            EyePitch = -maxPitch;
-    }    
+    Simulation.PushEvent(RoomInputEvent::MouseMove(Timer::GetTicks(), x, y));
 }
 
 void OculusRoomTinyApp::OnKey(unsigned vk, bool down)
 {
+    // Movement keys (W/S/A/D, arrows, Shift) are applied by Simulation's thread,
+    // at a fixed step; everything else is handled here.
+    Simulation.PushEvent(RoomInputEvent::Key(Timer::GetTicks(), vk, down));
+
     switch (vk)
     {
     case 'Q':
@@ -435,20 +799,68 @@ void OculusRoomTinyApp::OnKey(unsigned vk, bool down)
             Quit = true;
         break;
 
-    // Handle player movement keys.
-    // We just update movement state here, while the actual translation is done in OnIdle()
-    // based on time.
-    case 'W':      MoveForward = down ? (MoveForward | 1) : (MoveForward & ~1); break;
-    case 'S':      MoveBack    = down ? (MoveBack    | 1) : (MoveBack    & ~1); break;
-    case 'A':      MoveLeft    = down ? (MoveLeft    | 1) : (MoveLeft    & ~1); break;
-    case 'D':      MoveRight   = down ? (MoveRight   | 1) : (MoveRight   & ~1); break;
-    case VK_UP:    MoveForward = down ? (MoveForward | 2) : (MoveForward & ~2); break;
-    case VK_DOWN:  MoveBack    = down ? (MoveBack    | 2) : (MoveBack    & ~2); break;
-
     case 'R':
         SFusion.Reset();
+        Fusion.Reset();
+        break;
+
+    case 'T':
+        if (down)
+        {
+            TSSSensors.SetPredictionEnabled(!TSSSensors.IsPredictionEnabled());
+            LogText("TSS prediction: %s (%.1f ms)\n", TSSSensors.IsPredictionEnabled() ? "on" : "off",
+                    TSSSensors.GetPredictionInterval() * 1000.0f);
+        }
+        break;
+
+    case 'V':
+        if (down)
+        {
+            // A/B the sensor -> View paths.
+            bool quat = (Camera.ViewPath == RoomCamera::ViewPath_Quaternion);
+            Camera.ViewPath = quat ? RoomCamera::ViewPath_Euler : RoomCamera::ViewPath_Quaternion;
+            LogText("View path: %s\n", quat ? "Euler" : "Quaternion");
+        }
         break;
     
+    case 'L':
+        if (down)
+        {
+            // Where did the frame time go? Shift+L also starts a new measurement.
+            Timing.Dump();
+            if (ShiftDown)
+                Timing.Reset();
+        }
+        break;
+
+    case 'M':
+        if (down)
+        {
+            // A/B single-pass against multipass stereo; only RenderTiny::Soft has it.
+            SinglePassStereo = !SinglePassStereo;
+            LogText("Stereo: %s\n", (SinglePassStereo && pSoftRender) ? "single-pass" : "multipass");
+        }
+        break;
+
+    case 'C':
+        if (down)
+        {
+            CullScene = !CullScene;
+            LogText("Frustum culling: %s (%u models)\n", CullScene ? "on" : "off", SceneCull.GetModelCount());
+        }
+        break;
+
+    case 'N':
+        if (down && pSoftRender)
+        {
+            // A/B the distortion mesh against the per-pixel warp.
+            int grid = pSoftRender->GetDistortionMeshGrid() ? 0 :
+                       (DistortionMeshGrid ? DistortionMeshGrid : (int)DistortionMesh::DefaultGridSize);
+            pSoftRender->SetDistortionMeshGrid(grid);
+            LogText("Distortion: %s\n", grid ? "mesh" : "per-pixel");
+        }
+        break;
+
     case 'P':
         if (down)
         {
@@ -507,177 +919,114 @@ void OculusRoomTinyApp::OnKey(unsigned vk, bool down)
 
 void OculusRoomTinyApp::OnIdle()
 {
-    double curtime = GetAppTime();
-    float  dt      = float(curtime - LastUpdate);
-    LastUpdate     = curtime;
-
-
-    // Handle Sensor motion.
-    // We extract Yaw, Pitch, Roll instead of directly using the orientation
-    // to allow "additional" yaw manipulation with mouse/controller.
-    if (pSensor)
-    {        
-        Quatf    hmdOrient = SFusion.GetOrientation();
-        float    yaw = 0.0f;
-
-        hmdOrient.GetEulerAngles<Axis_Y, Axis_X, Axis_Z>(&yaw, &EyePitch, &EyeRoll);
-
-        EyeYaw += (yaw - LastSensorYaw);
-        LastSensorYaw = yaw;    
-    }    
-
-    //Threespace sensor integration
-    if(tss_isStreaming)
+    Timing.BeginFrame();
+    Camera.BeginFrame();
+
+    //Threespace sensor integration; one aligned snapshot of every sensor, the
+    //first of which is the head.
+    UInt64 nowTicks = Timer::GetTicks();
+    TSSSensors.Sample(nowTicks, &TSSSnapshot);
+    const ThreeSpacePose& tss_head = TSSSnapshot.Poses[0];
+    bool  tss_valid = TSSSnapshot.SensorCount && tss_head.Valid;
+
+    // Handle Sensor motion. With both the Rift and a ThreeSpace head sensor, the
+    // Rift's low-latency orientation is kept from drifting by ThreeSpace's.
+    if (pSensor && tss_valid)
     {
-        int error = tss_getLatestStreamData(tss_device,(char*)&tss_packet,sizeof(tss_packet),1000,&tss_timestamp);
-        if(error != 0)
-        {
-            LogText("TSS: getLatestStreamData error\n");
-        }
-
-        const float PI_F = 3.14159265358979f;
-
-        float x, y, z, w, s;
-        float rotator[3];
-
-        x = tss_packet.quat[0];
-        y = tss_packet.quat[1];
-        z = tss_packet.quat[2];
-        w = tss_packet.quat[3];
-        s = 2.0f * (w * y - x * z);
-
-        //it is invalid to pass values outside of the range -1,1 to asin()
-        if( s < 1.0 )
-        {
-            if( -1.0 < s)
-            {
-                rotator[0] = atan2( 2.0f*(x*y+w*z), 1.0f-2.0f*(y*y+z*z) );
-                rotator[1] = asin( s );
-                rotator[2] = atan2( 2.0f*(y*z+w*x), 1.0f-2.0f*(x*x+y*y) ); 
-            }
-            else
-            {
-                rotator[0] = 0;
-                rotator[1] = -PI_F / 2;
-                rotator[2] = -atan2( 2.0f*(x*y-w*z), 1.0f-2.0f*(x*x+z*z) );
-            }
-        }
-        else
-        {
-            rotator[0] = 0;
-            rotator[1] = PI_F / 2;
-            rotator[2] = atan2( 2.0f*(x*y-w*z), 1.0f-2.0f*(x*x+z*z) );
-        }
-
-        float yaw = 0.0;
-        yaw = rotator[0];
-        EyePitch = rotator[1];
-        EyeRoll = rotator[2];
-
-        //we are allowing combination of gamepad yaw and headtracker yaw therefore
-        EyeYaw += (yaw - LastSensorYaw);
-        LastSensorYaw = yaw;
-
-
-        /*
-        float yaw = 0.0f;
-
-        yaw = tss_packet.euler[0];
-        EyePitch = tss_packet.euler[1];
-        EyeRoll = tss_packet.euler[2];
-
-        //we are allowing combination of gamepad yaw and headtracker yaw therefore
-        EyeYaw += (yaw - LastSensorYaw);
-        LastSensorYaw = yaw;
-        */
+        float tss_quat[4] = { tss_head.Orientation.x, tss_head.Orientation.y,
+                              tss_head.Orientation.z, tss_head.Orientation.w };
+        Fusion.AddRiftOrientation(nowTicks, SFusion.GetOrientation());
+        Fusion.AddThreeSpaceOrientation(TSSSnapshot.AlignedTicks, RoomCamera::ThreeSpaceToWorld(tss_quat));
+        Camera.ApplyFusedOrientation(Fusion.GetOrientation());
+        Timing.SetSampleTicks(tss_head.SampleTicks);
     }
-
-    // Gamepad rotation.
-    EyeYaw -= GamepadRotate.x * dt;
-
-    if (!pSensor && !tss_isStreaming)
+    else if (pSensor)
+    {        
+        Camera.ApplyRiftOrientation(SFusion.GetOrientation());
+    }    
+    else if (tss_valid)
     {
-        // Allow gamepad to look up/down, but only if there is no Rift sensor.
-        EyePitch -= GamepadRotate.y * dt;
-
-        const float maxPitch = ((3.1415f/2)*0.98f);
-        if (EyePitch > maxPitch)
-            EyePitch = maxPitch;
-        if (EyePitch < -maxPitch)
-            EyePitch = -maxPitch;
+        float tss_quat[4] = { tss_head.Predicted.x, tss_head.Predicted.y,
+                              tss_head.Predicted.z, tss_head.Predicted.w };
+        Camera.ApplyThreeSpaceOrientation(tss_quat);
+        Timing.SetSampleTicks(tss_head.SampleTicks);
     }
-    
-    // Handle keyboard movement.
-    // This translates EyePos based on Yaw vector direction and keys pressed.
-    // Note that Pitch and Roll do not affect movement (they only affect view).
-    if (MoveForward || MoveBack || MoveLeft || MoveRight)
+    Timing.Mark(FrameStage_Sensor);
+
+    // Gamepad rotation and keyboard/gamepad movement, simulated up to now; the
+    // simulation thread can be a scheduler tick behind.
+    bool   hasSensor = pSensor || TSSSensors.HasReader();
+    UInt64 inputTicks = Timer::GetTicks();
+    Simulation.SetSensor(inputTicks, hasSensor, Camera.LastSensorYaw);
+    Simulation.Advance(inputTicks);
+    Camera.ApplyMotion(Simulation.GetMotion(inputTicks), hasSensor);
+    Timing.Mark(FrameStage_Input);
+
+    // Rotate and position View Camera, with minimal head modelling.
+    Camera.UpdateView();
+    Timing.Mark(FrameStage_View);
+
+    // Cull and sort once for the frame; both eyes draw what either can see.
+    if (!CullScene)
+        SceneCull.CullNone();
+    else if (SConfig.GetStereoMode() == Stereo_None)
     {
-        Vector3f localMoveVector(0,0,0);
-        Matrix4f yawRotate = Matrix4f::RotationY(EyeYaw);
-
-        if (MoveForward)
-            localMoveVector = ForwardVector;
-        else if (MoveBack)
-            localMoveVector = -ForwardVector;
-
-        if (MoveRight)
-            localMoveVector += RightVector;
-        else if (MoveLeft)
-            localMoveVector -= RightVector;
-
-        // Normalize vector so we don't move faster diagonally.
-        localMoveVector.Normalize();
-        Vector3f orientationVector = yawRotate.Transform(localMoveVector);
-        orientationVector *= MoveSpeed * dt * (ShiftDown ? 3.0f : 1.0f);
-
-        EyePos += orientationVector;
-    }
-
-    else if (GamepadMove.LengthSq() > 0)
-    {
-        Matrix4f yawRotate = Matrix4f::RotationY(EyeYaw);
-        Vector3f orientationVector = yawRotate.Transform(GamepadMove);
-        orientationVector *= MoveSpeed * dt;
-        EyePos += orientationVector;
+        const StereoEyeParams& center = SConfig.GetEyeRenderParams(StereoEye_Center);
+        SceneCull.Cull(CullFrustum::FromMatrix(center.Projection * center.ViewAdjust * Camera.View));
     }
-
-
-    // Rotate and position View Camera, using YawPitchRoll in BodyFrame coordinates.
-    // 
-    Matrix4f rollPitchYaw = Matrix4f::RotationY(EyeYaw) * Matrix4f::RotationX(EyePitch) *
-                            Matrix4f::RotationZ(EyeRoll);
-    Vector3f up      = rollPitchYaw.Transform(UpVector);
-    Vector3f forward = rollPitchYaw.Transform(ForwardVector);
-
-    
-    // Minimal head modelling.
-    float headBaseToEyeHeight     = 0.15f;  // Vertical height of eye from base of head
-    float headBaseToEyeProtrusion = 0.09f;  // Distance forward of eye from base of head
-
-    Vector3f eyeCenterInHeadFrame(0.0f, headBaseToEyeHeight, -headBaseToEyeProtrusion);
-    Vector3f shiftedEyePos = EyePos + rollPitchYaw.Transform(eyeCenterInHeadFrame);
-    shiftedEyePos.y -= eyeCenterInHeadFrame.y; // Bring the head back down to original height
-
-    View = Matrix4f::LookAtRH(shiftedEyePos, shiftedEyePos + forward, up); 
-
-    // This is what transformation would be without head modeling.    
-    // View = Matrix4f::LookAtRH(EyePos, EyePos + forward, up);    
+    else
+        SceneCull.Cull(CullFrustum::FromStereo(SConfig.GetEyeRenderParams(StereoEye_Left),
+                                               SConfig.GetEyeRenderParams(StereoEye_Right), Camera.View));
+    SceneQueue.Clear();
+    SceneCull.Queue(&SceneQueue, Camera.View);
+    SceneQueue.Sort();
 
     switch(SConfig.GetStereoMode())
     {
     case Stereo_None:
         Render(SConfig.GetEyeRenderParams(StereoEye_Center));
+        Timing.Mark(FrameStage_Render0);
         break;
 
     case Stereo_LeftRight_Multipass:
+        if (SinglePassStereo && pSoftRender)
+        {
+            // Render0 is the scene pass, Render1 both eyes' distortion.
+            RenderStereo(SConfig.GetEyeRenderParams(StereoEye_Left),
+                         SConfig.GetEyeRenderParams(StereoEye_Right));
+            break;
+        }
         Render(SConfig.GetEyeRenderParams(StereoEye_Left));
+        Timing.Mark(FrameStage_Render0);
         Render(SConfig.GetEyeRenderParams(StereoEye_Right));
+        Timing.Mark(FrameStage_Render1);
         break;
     }
      
     pRender->Present();
+    Timing.Mark(FrameStage_Present);
     // Force GPU to flush the scene, resulting in the lowest possible latency.
     pRender->ForceFlushGPU();
+    Timing.Mark(FrameStage_Flush);
+
+    Timing.EndFrame();
+
+    // Time to first frame: process start to the first frame flushed to the GPU.
+    if (Timing.GetFrameCount() == 1)
+    {
+        UInt64 firstFrameTicks = OVR::Timer::GetTicks();
+        Trace::Complete("Time to first frame", StartupTicks, firstFrameTicks);
+        LogText("Time to first frame: %.1f ms\n", (firstFrameTicks - StartupTicks) / 1000.0);
+
+        if (TSSRescanPending)
+        {
+            TSSRescanPending = false;
+            pTSSRescan = *new Thread(&rescanThreadFn, this);
+            if (!pTSSRescan->Start())
+                pTSSRescan.Clear();
+        }
+    }
+    finishThreeSpaceRescan(false);
 }
 
 
@@ -691,11 +1040,25 @@ void OculusRoomTinyApp::Render(const StereoEyeParams& stereo)
     pRender->Clear();
     pRender->SetDepthMode(true, true);
     
-    Scene.Render(pRender, stereo.ViewAdjust * View);
+    SceneQueue.Render(&Scene, pRender, stereo.ViewAdjust * Camera.View, pSoftRender.GetPtr());
 
     pRender->FinishScene();
 }
 
+// Render the scene once for both eyes; the device applies each eye's ViewAdjust.
+void OculusRoomTinyApp::RenderStereo(const StereoEyeParams& left, const StereoEyeParams& right)
+{
+    pSoftRender->BeginStereoScene(PostProcess, left, right);
+    pRender->Clear();
+    pRender->SetDepthMode(true, true);
+
+    SceneQueue.Render(&Scene, pRender, Camera.View, pSoftRender.GetPtr());
+    Timing.Mark(FrameStage_Render0);
+
+    pSoftRender->FinishStereoScene();
+    Timing.Mark(FrameStage_Render1);
+}
+
 
 //-------------------------------------------------------------------------------------
 // ***** Win32-Specific Logic
@@ -731,6 +1094,7 @@ bool OculusRoomTinyApp::setupWindow()
 
 void OculusRoomTinyApp::destroyWindow()
 {    
+    pSoftRender.Clear();
     pRender.Clear();
 
     if (hWnd)
@@ -905,6 +1269,8 @@ int WINAPI WinMain(HINSTANCE hinst, HINSTANCE, LPSTR inArgs, int)
     // Initializes LibOVR. This LogMask_All enables maximum logging.
     // Custom allocator can also be specified here.
     OVR::System::Init(OVR::Log::ConfigureDefaultLog(OVR::LogMask_All));
+    // Hot-path logging (e.g. the ThreeSpace reader) is formatted off-thread.
+    AsyncLog::Start();
 
     // Scope to force application destructor before System::Destroy.
     {
@@ -921,27 +1287,22 @@ int WINAPI WinMain(HINSTANCE hinst, HINSTANCE, LPSTR inArgs, int)
 
 
     // *** StopStreaming
-    int count = 0;
-    if(tss_isStreaming)
+    for (unsigned i = 0; i < tss_deviceCount; i++)
     {
         //3 Attempts
-        while( count < 3)
-        {
-            if(tss_stopStreaming(tss_device, NULL) == 0)
-            {
-                tss_isStreaming =  false;
-                LogText("TSS: Stop streaming success!\n");
-                break;
-            }
+        int count = 0;
+        while (count < 3 && tss_stopStreaming(tss_devices[i], NULL) != 0)
             count++;
-        }
-    }
-    if(tss_isStreaming)
-    {
-        LogText("TSS: Stop streaming failed!\n");
+        if (count < 3)
+            LogText("TSS: Stop streaming success!\n");
+        else
+            LogText("TSS: Stop streaming failed!\n");
     }
+    tss_deviceCount = 0;
     // ***
 
+    AsyncLog::Stop();
+
     // No OVR functions involving memory are allowed after this.
     OVR::System::Destroy();
   
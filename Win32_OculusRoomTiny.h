@@ -30,6 +30,18 @@ limitations under the License.
 #include "Util/Util_Render_Stereo.h"
 #include "../../LibOVR/Src/Kernel/OVR_Timer.h"
 #include "RenderTiny_D3D1X_Device.h"
+#include "RenderTiny_Soft_Device.h"
+#include "RenderTiny_SceneBVH.h"
+#include "RenderTiny_RenderQueue.h"
+#include "RenderTiny_StaticBatch.h"
+#include "RenderTiny_SceneFile.h"
+#include "OculusRoomTiny_Pipeline.h"
+#include "Util_FrameTiming.h"
+#include "Util_TaskGraph.h"
+#include "Util_Trace.h"
+#include "Util_AsyncLog.h"
+#include "ThreeSpace_Device.h"
+#include "ThreeSpace_DeviceCache.h"
 
 using namespace OVR;
 using namespace OVR::RenderTiny;
@@ -47,21 +59,35 @@ using namespace OVR::RenderTiny;
 //  F1 - No stereo, no distortion.
 //  F2 - Stereo, no distortion.
 //  F3 - Stereo and distortion.
+//  'V' - Toggle between the quaternion and Euler sensor -> View paths.
+//  'T' - Toggle ThreeSpace orientation prediction.
+//  'L' - Log per-stage frame timing percentiles; Shift+'L' also resets them.
+//  'C' - Toggle view-frustum culling.
+//  'M' - Toggle single-pass and multipass stereo (with -soft-render).
+//  'N' - Toggle the distortion mesh and the per-pixel warp (with -soft-render).
+//
+// The following command line arguments work:
+//
+//  -tss-record <file> - Append every ThreeSpace sample read to a recording.
+//  -tss-replay <file> - Replay a ThreeSpace recording instead of the live sensor.
+//  -tss-predict <ms>  - ThreeSpace prediction interval; 0 disables prediction.
+//  -tss-cache <file>  - ThreeSpace device cache for fast restarts (default
+//                       ThreeSpaceDevices.cache; "" disables it).
+//  -input-record <file> - Write every movement input event (keys, mouse, gamepad,
+//                       sensor heading) to a journal, with the step it applied at.
+//  -input-replay <file> - Move by a journal's events instead of live input.
+//  -view-euler        - Start with the Euler sensor -> View path.
+//  -soft-render       - Render with the CPU rasterizer instead of D3D10.
+//  -stereo-single-pass - Render both eyes in one scene pass (with -soft-render).
+//  -no-cull          - Draw every model instead of culling to the eyes' frustum.
+//  -scene <file>      - Load the room from a scene file instead of building it in
+//                       code (see RenderTiny_SceneFile.h).
+//  -static-batch <n>  - Merge the room into static batches of at most n vertices
+//                       per fill at startup; 0 for the largest (65536).
+//  -distortion-mesh <n> - Distort through an n x n precomputed mesh instead of
+//                       per pixel (with -soft-render).
+//  -trace <file>      - Write a Chrome JSON trace of startup and every frame.
 //
-
-// The world RHS coordinate system is defines as follows (as seen in perspective view):
-//  Y - Up
-//  Z - Back
-//  X - Right
-const Vector3f UpVector(0.0f, 1.0f, 0.0f);
-const Vector3f ForwardVector(0.0f, 0.0f, -1.0f);
-const Vector3f RightVector(1.0f, 0.0f, 0.0f);
-
-// We start out looking in the positive Z (180 degree rotation).
-const float    YawInitial  = 3.141592f;
-const float    Sensitivity = 1.0f;
-const float    MoveSpeed   = 3.0f; // m/s
-
 
 //-------------------------------------------------------------------------------------
 // ***** OculusRoomTiny Application class
@@ -99,6 +125,8 @@ public:
 
     // Render the view for one eye.
     void         Render(const StereoEyeParams& stereo);
+    // Render both eyes with one pass over the scene.
+    void         RenderStereo(const StereoEyeParams& left, const StereoEyeParams& right);
 
     // Main application loop.
     int          Run();
@@ -121,6 +149,19 @@ protected:
 
     void        giveUsFocus(bool setFocus);
 
+    // Startup tasks, run by OnStartup's TaskGraph; see OnStartup for their order.
+    void        parseCommandLine(const char* args);
+    bool        setupRift();
+    bool        setupRendering();
+    bool        setupScene();
+    void        setupThreeSpaceDevices();
+    void        scanThreeSpacePorts(ThreeSpaceDeviceCache* cache);
+    TSS_Device_Id setupThreeSpaceDevice(const char* port, ThreeSpaceDeviceCache* cache);
+    bool        startThreeSpace();
+    void        rescanThreeSpace();
+    static int  rescanThreadFn(Thread* thread, void* app);
+    void        finishThreeSpaceRescan(bool wait);
+
     static OculusRoomTinyApp*   pApp;
 
     // *** Rendering Variables
@@ -151,32 +192,70 @@ protected:
     SensorFusion        SFusion;
     OVR::HMDInfo        HMDInfo;
 
-    // Last update seconds, used for move speed timing.
-    double              LastUpdate;
+    // *** ThreeSpace Variables
+
+    // Reads every streaming ThreeSpace sensor (or a replay) off the render thread,
+    // each on its own thread, and predicts their orientations. Sensor 0 is the head;
+    // TSSSnapshot has all of them, time-aligned, as of the last OnIdle.
+    ThreeSpaceSensorGroup TSSSensors;
+    ThreeSpaceSnapshot    TSSSnapshot;
+    // Rift and ThreeSpace head orientation combined, when both are present.
+    HeadFusion            Fusion;
+    String              TSSRecordPath;
+    String              TSSReplayPath;
+    // Where sensors were found and how they were set up; see setupThreeSpaceDevices.
+    String              TSSCachePath;
+    // Ports already opened or scanned. With a warm cache, the scan of the rest runs
+    // on pTSSRescan after the first frame, and what it finds waits in
+    // TSSRescanReaders until OnIdle adds it to TSSSensors.
+    Array<String>       TSSTriedPorts;
+    bool                TSSRescanPending;
+    Ptr<Thread>         pTSSRescan;
+    Array<Ptr<ThreeSpaceReader> > TSSRescanReaders;
+
+    // Chrome trace output, if -trace was given.
+    String              TracePath;
+
     UInt64              StartupTicks;
 
-     // Position and look. The following apply:
-    Vector3f            EyePos;
-    float               EyeYaw;         // Rotation around Y, CCW positive when looking at RHS (X,Z) plane.
-    float               EyePitch;       // Pitch. If sensor is plugged in, only read from sensor.
-    float               EyeRoll;        // Roll, only accessible from Sensor.
-    float               LastSensorYaw;  // Stores previous Yaw value from to support computing delta.
-
-    // Movement state; different bits may be set based on the state of keys.
-    UByte               MoveForward;
-    UByte               MoveBack;
-    UByte               MoveLeft;
-    UByte               MoveRight;
-    Vector3f            GamepadMove, GamepadRotate;
-
-    Matrix4f            View;
+    // Position, look and View; platform-neutral part of OnIdle.
+    RoomCamera          Camera;
+    // Integrates movement at a fixed step on its own thread, from the input events
+    // OnKey/OnMouseMove/OnGamepad queue.
+    RoomSimulation      Simulation;
+    String              InputRecordPath;
+    String              InputReplayPath;
+    RoomInputJournal    InputJournal;
+    RoomInputReplay     InputReplay;
+
+    // Per-stage timing of every OnIdle frame.
+    FrameTiming         Timing;
+
     RenderTiny::Scene   Scene;
+    // Scene file to load instead of PopulateRoomScene; empty for the built-in room.
+    String              ScenePath;
+    // Scene's models in a BVH, culled once per frame to both eyes' frustum (or
+    // not, if CullScene is off), then sorted into SceneQueue, which every eye
+    // pass replays.
+    SceneBVH            SceneCull;
+    bool                CullScene;
+    // Vertex limit of the static batches setupScene merges the room into; 0 for
+    // StaticBatch::MaxVertices, -1 to keep the models as they are.
+    int                 StaticBatchVertices;
+    RenderQueue         SceneQueue;
    
     // Stereo view parameters.
     StereoConfig        SConfig;
     PostProcessType     PostProcess;
-
-    // Shift accelerates movement/adjustment velocity. 
+    // Render with RenderTiny::Soft instead of D3D10; pSoftRender is pRender then.
+    bool                SoftRender;
+    Ptr<RenderTiny::Soft::RenderDevice> pSoftRender;
+    // Stereo_LeftRight_Multipass as one scene pass, on devices that support it.
+    bool                SinglePassStereo;
+    // Grid size of the soft device's distortion mesh; 0 warps per pixel.
+    int                 DistortionMeshGrid;
+
+    // Holding down Shift key accelerates adjustment velocity.
     bool                ShiftDown;
     bool                ControlDown;
 };